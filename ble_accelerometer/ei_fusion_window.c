@@ -0,0 +1,189 @@
+/* Sensor fusion window builder. See ei_fusion_window.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "ei_fusion_window.h"
+
+/* Private functions ------------------------------------------------------- */
+static inline uint64_t row_time(const ei_fusion_window_t *win, size_t row)
+{
+    return win->t0_us + (uint64_t)row * win->interval_us;
+}
+
+static inline float *row_ptr(ei_fusion_window_t *win, ei_fusion_channel_t *ch)
+{
+    return &win->buf[ch->next_row * win->frame_size + ch->offset];
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Setup a window builder on top of a caller owned buffer
+ *
+ * @param buf buffer to store the interleaved window in
+ *
+ * @param len size of the buffer, in floats, e.g. EI_CLASSIFIER_NN_INPUT_FRAME_SIZE
+ *
+ * @param frame_size values per row, e.g. EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME
+ *
+ * @param interval_us period of the window grid, e.g. EI_CLASSIFIER_INTERVAL_MS * 1000
+ *
+ * @return int, 0 => OK
+ */
+int ei_fusion_init(ei_fusion_window_t *win, float *buf, size_t len, size_t frame_size, uint32_t interval_us)
+{
+    if (buf == NULL || frame_size == 0 || interval_us == 0) {
+        return -1;
+    }
+
+    memset(win, 0, sizeof(ei_fusion_window_t));
+    win->buf = buf;
+    win->frame_size = frame_size;
+    win->rows = len / frame_size;
+    win->interval_us = interval_us;
+
+    return 0;
+}
+
+/**
+ * @brief Add a channel. Columns are assigned in the order channels are added,
+ * so add them in the axis order of the impulse (e.g. accX, accY, accZ, gyrX ...)
+ *
+ * @param n_axes values pushed per sample
+ *
+ * @param sample_interval_us nominal sampling period of the channel. Channels
+ *        at least twice as fast as the window grid are decimated by averaging
+ *        the samples within half a grid period of each row, slower channels
+ *        are linearly interpolated.
+ *
+ * @return channel index for ei_fusion_push, or -1 on error
+ */
+int ei_fusion_add_channel(ei_fusion_window_t *win, uint8_t n_axes, uint32_t sample_interval_us)
+{
+    uint32_t used = 0;
+
+    for (int ix = 0; ix < win->n_channels; ix++) {
+        used += win->channels[ix].n_axes;
+    }
+    if (win->n_channels >= EI_FUSION_MAX_CHANNELS || n_axes == 0
+        || n_axes > EI_FUSION_MAX_AXES || used + n_axes > win->frame_size) {
+        return -1;
+    }
+
+    ei_fusion_channel_t *ch = &win->channels[win->n_channels];
+    memset(ch, 0, sizeof(ei_fusion_channel_t));
+    ch->n_axes = n_axes;
+    ch->offset = (uint8_t)used;
+    ch->decimate = (sample_interval_us * 2 <= win->interval_us);
+
+    return win->n_channels++;
+}
+
+/**
+ * @brief Start a new window. Row 0 of the window is aligned to t0_us.
+ */
+void ei_fusion_start(ei_fusion_window_t *win, uint64_t t0_us)
+{
+    win->t0_us = t0_us;
+    for (int ix = 0; ix < win->n_channels; ix++) {
+        ei_fusion_channel_t *ch = &win->channels[ix];
+        ch->has_prev = false;
+        ch->acc_count = 0;
+        ch->next_row = 0;
+        memset(ch->acc, 0, sizeof(ch->acc));
+    }
+}
+
+/**
+ * @brief Push one timestamped sample of a channel. Every window row of this
+ * channel that can be completed with this sample is written immediately, so the
+ * work per sample is bounded by the number of rows it covers.
+ */
+void ei_fusion_push(ei_fusion_window_t *win, int channel, uint64_t ts_us, const float *values)
+{
+    if (channel < 0 || channel >= win->n_channels) {
+        return;
+    }
+
+    ei_fusion_channel_t *ch = &win->channels[channel];
+    uint8_t n = ch->n_axes;
+
+    if (ch->decimate) {
+        // rows are emitted once a sample arrives past the end of their grid
+        // period, as the mean of the samples centred on the row time
+        uint32_t half = win->interval_us / 2;
+        while (ch->next_row < win->rows && row_time(win, ch->next_row) + half < ts_us) {
+            float *out = row_ptr(win, ch);
+            if (ch->acc_count > 0) {
+                float scale = 1.0f / (float)ch->acc_count;
+                for (uint8_t a = 0; a < n; a++) {
+                    out[a] = ch->acc[a] * scale;
+                    ch->acc[a] = 0.0f;
+                }
+                ch->acc_count = 0;
+            } else {
+                // gap longer than a grid period, hold the latest value
+                memcpy(out, ch->has_prev ? ch->prev : values, n * sizeof(float));
+            }
+            ch->next_row++;
+        }
+
+        for (uint8_t a = 0; a < n; a++) {
+            ch->acc[a] += values[a];
+        }
+        ch->acc_count++;
+    } else {
+        while (ch->next_row < win->rows && row_time(win, ch->next_row) <= ts_us) {
+            float *out = row_ptr(win, ch);
+            uint64_t t = row_time(win, ch->next_row);
+            if (!ch->has_prev || t <= ch->prev_us || ts_us == ch->prev_us) {
+                memcpy(out, values, n * sizeof(float));
+            } else {
+                float frac = (float)(t - ch->prev_us) / (float)(ts_us - ch->prev_us);
+                for (uint8_t a = 0; a < n; a++) {
+                    out[a] = ch->prev[a] + frac * (values[a] - ch->prev[a]);
+                }
+            }
+            ch->next_row++;
+        }
+    }
+
+    memcpy(ch->prev, values, n * sizeof(float));
+    ch->prev_us = ts_us;
+    ch->has_prev = true;
+}
+
+/**
+ * @brief True once every channel has filled every row of the window
+ */
+bool ei_fusion_ready(const ei_fusion_window_t *win)
+{
+    for (int ix = 0; ix < win->n_channels; ix++) {
+        if (win->channels[ix].next_row < win->rows) {
+            return false;
+        }
+    }
+
+    return win->n_channels > 0;
+}
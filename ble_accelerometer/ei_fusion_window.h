@@ -0,0 +1,86 @@
+/* Sensor fusion window builder. Channels (e.g. accelerometer and gyroscope)
+ * are sampled at independent rates and pushed with their own timestamps. Each
+ * sample is resampled onto the model's fixed EI_CLASSIFIER_INTERVAL_MS grid as
+ * it arrives, and written interleaved into the frame layout the impulse expects,
+ * so no post-processing pass over the window is needed.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_FUSION_WINDOW_H
+#define EI_FUSION_WINDOW_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defines ----------------------------------------------------------------- */
+#ifndef EI_FUSION_MAX_CHANNELS
+#define EI_FUSION_MAX_CHANNELS      4
+#endif
+
+#ifndef EI_FUSION_MAX_AXES
+#define EI_FUSION_MAX_AXES          3
+#endif
+
+/* Types ------------------------------------------------------------------- */
+
+/** Resampling state of one sensor channel */
+typedef struct {
+    uint8_t n_axes;
+    uint8_t offset;             // first column of this channel in a frame
+    bool decimate;              // channel is faster than the window grid
+    bool has_prev;
+    uint64_t prev_us;
+    float prev[EI_FUSION_MAX_AXES];
+    float acc[EI_FUSION_MAX_AXES];
+    uint32_t acc_count;
+    size_t next_row;            // next window row this channel has to fill
+} ei_fusion_channel_t;
+
+/** Window being assembled, buf holds rows * frame_size floats */
+typedef struct {
+    float *buf;
+    size_t rows;
+    size_t frame_size;
+    uint32_t interval_us;
+    uint64_t t0_us;
+    uint8_t n_channels;
+    ei_fusion_channel_t channels[EI_FUSION_MAX_CHANNELS];
+} ei_fusion_window_t;
+
+/* Function prototypes ----------------------------------------------------- */
+int ei_fusion_init(ei_fusion_window_t *win, float *buf, size_t len, size_t frame_size, uint32_t interval_us);
+int ei_fusion_add_channel(ei_fusion_window_t *win, uint8_t n_axes, uint32_t sample_interval_us);
+void ei_fusion_start(ei_fusion_window_t *win, uint64_t t0_us);
+void ei_fusion_push(ei_fusion_window_t *win, int channel, uint64_t ts_us, const float *values);
+bool ei_fusion_ready(const ei_fusion_window_t *win);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,6 +1,8 @@
 #include "bmi160.h"
 #include "bmi160_config.h"
 #include "ei_imu_minimal.h"
+#include "ei_fusion_window.h"
+#include "ei_imu_quant.h"
 
 #include "ti_drivers_config.h"
 #include <ti/sysbios/knl/Task.h>
@@ -8,8 +10,75 @@
 
 #define CONVERT_G_TO_MS2    9.80665f
 
+/* With EI_IMU_STARTUP_TRACE=1 the first successful read is marked, see ei_startup.h */
+#ifndef EI_IMU_STARTUP_TRACE
+#define EI_IMU_STARTUP_TRACE 0
+#endif
+
+#if EI_IMU_STARTUP_TRACE
+#include "ei_startup.h"
+#endif
+
+/* With EI_IMU_SAMPLE_RATE=1 every accelerometer read feeds an estimate of the
+ * effective sample rate and its jitter, see ei_sample_rate.h */
+#ifndef EI_IMU_SAMPLE_RATE
+#define EI_IMU_SAMPLE_RATE 0
+#endif
+
+#if EI_IMU_SAMPLE_RATE
+#include "ei_sample_rate.h"
+
+// running average over the last ~32 samples
+#ifndef EI_IMU_SAMPLE_RATE_ALPHA
+#define EI_IMU_SAMPLE_RATE_ALPHA    (1.0f / 32.0f)
+#endif
+
+static ei_sample_rate_t acc_rate;
+#endif
+
+/* Independent sampling periods used when building fused (accelerometer + gyroscope) windows */
+#ifndef EI_IMU_ACC_INTERVAL_US
+#define EI_IMU_ACC_INTERVAL_US      10000
+#endif
+
+#ifndef EI_IMU_GYRO_INTERVAL_US
+#define EI_IMU_GYRO_INTERVAL_US     5000
+#endif
+
 I2C_Handle i2cHandle; // externed to bmi160_config.c
 
+static uint64_t last_sample_us = 0;
+
+static uint64_t imu_time_us(void)
+{
+    return (uint64_t)Clock_getTicks() * Clock_tickPeriod;
+}
+
+/**
+ * @brief Sleep for at least us, rounded up to whole ticks: a sleep shorter
+ * than a tick would truncate to Task_sleep(0) and spin the sampling loop
+ */
+static void imu_sleep_us(uint64_t us)
+{
+    uint32_t ticks = (uint32_t)((us + Clock_tickPeriod - 1) / Clock_tickPeriod);
+
+    Task_sleep(ticks ? ticks : 1);
+}
+
+/**
+ * @brief Called before a window is sampled at an accelerometer period of
+ * nominal_us: the time since the previous window is not a sample interval
+ */
+static void rate_window_start(uint32_t nominal_us)
+{
+#if EI_IMU_SAMPLE_RATE
+    if (acc_rate.nominal_us != nominal_us) {
+        ei_rate_init(&acc_rate, nominal_us, EI_IMU_SAMPLE_RATE_ALPHA);
+    }
+    ei_rate_restart(&acc_rate);
+#endif
+}
+
 /**
  * @brief Setup I2C
  *
@@ -46,11 +115,211 @@ int imu_sample(float *buf)
         if(bmi160_getData(acc_data)) {
             return -1;
         }
+        last_sample_us = imu_time_us();
+#if EI_IMU_SAMPLE_RATE
+        ei_rate_push(&acc_rate, last_sample_us);
+#endif
 
         buf[0] = acc_data[0] * CONVERT_G_TO_MS2;
         buf[1] = acc_data[1] * CONVERT_G_TO_MS2;
         buf[2] = acc_data[2] * CONVERT_G_TO_MS2;
 
+#if EI_IMU_STARTUP_TRACE
+    ei_startup_mark(EI_STARTUP_FIRST_SAMPLE);
+#endif
+    return 0;
+}
+
+/**
+ * @brief Read the BMI160 gyroscope in deg/s. The boostxl_sensors driver only
+ * exposes the accelerometer by default, provide a strong definition of this
+ * function alongside bmi160_getData to enable the gyroscope channel.
+ *
+ * @return int, 0 => OK
+ */
+__attribute__((weak)) int bmi160_getGyroData(float *gyro_data)
+{
+    return -1;
+}
+
+/**
+ * @brief Sample gyroscope (x, y, z axis) and store in provided buffer
+ * Stores three floats.
+ *
+ * @return int, 0 => OK
+ */
+int imu_sample_gyro(float *buf)
+{
+    if (bmi160_getGyroData(buf)) {
+        return -1;
+    }
+    last_sample_us = imu_time_us();
+
+    return 0;
+}
+
+/**
+ * @brief Time since boot, in us truncated to 32 bits, at which the last
+ * sample was read: once a window is filled, the capture time of the window
+ */
+uint32_t imu_last_sample_us(void)
+{
+    return (uint32_t)last_sample_us;
+}
+
+#if EI_IMU_SAMPLE_RATE
+/**
+ * @brief Effective accelerometer sample rate and interval jitter, measured on
+ * the timestamps of the reads within windows
+ *
+ * @return int, 0 => OK, -1 if nothing was measured yet
+ */
+int imu_sample_rate(ei_sample_rate_stats_t *out)
+{
+    return ei_rate_get(&acc_rate, out);
+}
+
+/**
+ * @brief Clear the jitter statistics, the running rate estimate is kept
+ */
+void imu_sample_rate_reset(void)
+{
+    ei_rate_reset(&acc_rate);
+}
+#endif
+
+/**
+ * @brief Setup a fusion window for the IMU. Adds the accelerometer channel, and
+ * the gyroscope channel if the frame has room for six axes.
+ *
+ * @return int, 0 => OK
+ */
+int imu_fusion_init(ei_fusion_window_t *win, float *buf, size_t len, size_t frame_size, uint32_t interval_us)
+{
+    if (ei_fusion_init(win, buf, len, frame_size, interval_us)) {
+        return -1;
+    }
+    if (ei_fusion_add_channel(win, 3, EI_IMU_ACC_INTERVAL_US) < 0) {
+        return -1;
+    }
+    if (frame_size >= 6 && ei_fusion_add_channel(win, 3, EI_IMU_GYRO_INTERVAL_US) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Fill a fusion window, sampling each channel at its own rate.
+ * Samples are timestamped and resampled onto the window grid as they arrive.
+ * This method blocks and sleeps the thread while waiting.
+ *
+ * @param win window setup with imu_fusion_init
+ *
+ * @return int, 0 => OK
+ */
+int imu_fill_window_fused(ei_fusion_window_t *win)
+{
+    const uint32_t interval_us[2] = { EI_IMU_ACC_INTERVAL_US, EI_IMU_GYRO_INTERVAL_US };
+    int (*sample_fn[2])(float *) = { imu_sample, imu_sample_gyro };
+    uint64_t next_due[2];
+    float values[3];
+
+    uint64_t now = imu_time_us();
+    next_due[0] = now;
+    next_due[1] = now;
+    ei_fusion_start(win, now);
+    rate_window_start(EI_IMU_ACC_INTERVAL_US);
+
+    while (!ei_fusion_ready(win)) {
+        uint64_t wake = UINT64_MAX;
+
+        for (int ch = 0; ch < win->n_channels && ch < 2; ch++) {
+            now = imu_time_us();
+            if (now >= next_due[ch]) {
+                if (sample_fn[ch](values)) {
+                    return -1;
+                }
+                ei_fusion_push(win, ch, now, values);
+                next_due[ch] += interval_us[ch];
+            }
+            if (next_due[ch] < wake) {
+                wake = next_due[ch];
+            }
+        }
+
+        now = imu_time_us();
+        if (wake > now) {
+            imu_sleep_us(wake - now);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Setup a window that is resampled onto its grid from the measured
+ * timestamps of the accelerometer, for imu_fill_window_resampled
+ *
+ * @param interval_us period of the window grid, the accelerometer is read at
+ * the same period
+ *
+ * @return int, 0 => OK
+ */
+int imu_resample_init(ei_fusion_window_t *win, float *buf, size_t len, uint32_t interval_us)
+{
+    if (ei_fusion_init(win, buf, len, 3, interval_us)) {
+        return -1;
+    }
+    // as fast as the grid: every row is interpolated between the two reads around it
+    if (ei_fusion_add_channel(win, 3, interval_us) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Fill a window of accelerometer data on the nominal grid of the model.
+ * Reads are scheduled on absolute deadlines, so the time of the I2C transfer
+ * does not add up, and every read is timestamped and linearly interpolated
+ * onto the grid as it arrives, so what is left of drift and jitter (bus load,
+ * tick granularity, higher priority tasks) does not distort the window.
+ * Row 0 is the first read. This method blocks and sleeps the thread while waiting.
+ *
+ * @param win window setup with imu_resample_init
+ *
+ * @return int, 0 => OK
+ */
+int imu_fill_window_resampled(ei_fusion_window_t *win)
+{
+    float values[3];
+    uint64_t next_due;
+
+    rate_window_start(win->interval_us);
+    next_due = imu_time_us();
+    if (imu_sample(values)) {
+        return -1;
+    }
+    ei_fusion_start(win, last_sample_us);
+    ei_fusion_push(win, 0, last_sample_us, values);
+    next_due += win->interval_us;
+
+    while (!ei_fusion_ready(win)) {
+        uint64_t now = imu_time_us();
+        if (next_due > now) {
+            imu_sleep_us(next_due - now);
+        } else if (now - next_due > win->interval_us) {
+            // fell behind by more than a period, do not catch up with a burst of reads
+            next_due = now;
+        }
+        if (imu_sample(values)) {
+            return -1;
+        }
+        ei_fusion_push(win, 0, last_sample_us, values);
+        next_due += win->interval_us;
+    }
+
     return 0;
 }
 
@@ -70,12 +339,43 @@ int imu_sample(float *buf)
  */
 int imu_fill_window(float *buf, size_t len, size_t interval) {
 
+    rate_window_start(interval * 1000);
     for(int i = 0; i < len; i += 3) {
         if (imu_sample(&buf[i])) {
             return -1;
         }
 
-        Task_sleep(interval / Clock_tickPeriod);
+        imu_sleep_us((uint64_t)interval * 1000);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Same as imu_fill_window, but every sample is quantized as it arrives
+ * and the window is stored as int8, a quarter of the RAM of the float window.
+ *
+ * @param buf buffer to store quantized data in
+ *
+ * @param len size of the data buffer
+ *
+ * @param interval sample period in milliseconds
+ *
+ * @param params input quantization of the impulse
+ *
+ * @return int, 0 => OK
+ */
+int imu_fill_window_i8(int8_t *buf, size_t len, size_t interval, const ei_quant_params_t *params) {
+    float sample[3];
+
+    rate_window_start(interval * 1000);
+    for(int i = 0; i + 3 <= len; i += 3) {
+        if (imu_sample(sample)) {
+            return -1;
+        }
+        ei_quantize_f32(sample, &buf[i], 3, params);
+
+        imu_sleep_us((uint64_t)interval * 1000);
     }
 
     return 0;
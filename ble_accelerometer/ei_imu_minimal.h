@@ -38,10 +38,27 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include "ei_fusion_window.h"
+#include "ei_imu_quant.h"
 
 /* Function prototypes ----------------------------------------------------- */
 int imu_init(void);
 int imu_sample(float *buf);
+int imu_sample_gyro(float *buf);
+uint32_t imu_last_sample_us(void);
 int imu_fill_window(float *buf, size_t len, size_t interval);
+int imu_fusion_init(ei_fusion_window_t *win, float *buf, size_t len, size_t frame_size, uint32_t interval_us);
+int imu_fill_window_fused(ei_fusion_window_t *win);
+int imu_fill_window_i8(int8_t *buf, size_t len, size_t interval, const ei_quant_params_t *params);
+int imu_resample_init(ei_fusion_window_t *win, float *buf, size_t len, uint32_t interval_us);
+int imu_fill_window_resampled(ei_fusion_window_t *win);
+
+#if EI_IMU_SAMPLE_RATE
+#include "ei_sample_rate.h"
+
+/* Measured accelerometer rate and jitter, see EI_IMU_SAMPLE_RATE */
+int imu_sample_rate(ei_sample_rate_stats_t *out);
+void imu_sample_rate_reset(void);
+#endif
 
 #endif
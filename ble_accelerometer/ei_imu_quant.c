@@ -0,0 +1,57 @@
+/* Affine int8 quantization helpers. See ei_imu_quant.h
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include "ei_imu_quant.h"
+
+/* Public functions -------------------------------------------------------- */
+void ei_quant_init(ei_quant_params_t *params, float scale, int32_t zero_point)
+{
+    params->scale = scale;
+    params->inv_scale = 1.0f / scale;
+    params->zero_point = zero_point;
+}
+
+/**
+ * @brief Quantize floats to int8, rounding to nearest and saturating
+ */
+void ei_quantize_f32(const float *in, int8_t *out, size_t len, const ei_quant_params_t *params)
+{
+    for (size_t ix = 0; ix < len; ix++) {
+        float scaled = in[ix] * params->inv_scale;
+        int32_t q = (int32_t)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f) + params->zero_point;
+        if (q > 127) {
+            q = 127;
+        } else if (q < -128) {
+            q = -128;
+        }
+        out[ix] = (int8_t)q;
+    }
+}
+
+void ei_dequantize_i8(const int8_t *in, float *out, size_t len, const ei_quant_params_t *params)
+{
+    for (size_t ix = 0; ix < len; ix++) {
+        out[ix] = (float)((int32_t)in[ix] - params->zero_point) * params->scale;
+    }
+}
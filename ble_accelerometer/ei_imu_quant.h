@@ -0,0 +1,54 @@
+/* Affine int8 quantization helpers for storing sensor windows directly in the
+ * input scale / zero point of an int8 quantized impulse. Only the arithmetic
+ * lives here, so the same code can be used to replay traces on a host.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_IMU_QUANT_H
+#define EI_IMU_QUANT_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** real = (q - zero_point) * scale */
+typedef struct {
+    float scale;
+    float inv_scale;
+    int32_t zero_point;
+} ei_quant_params_t;
+
+/* Function prototypes ----------------------------------------------------- */
+void ei_quant_init(ei_quant_params_t *params, float scale, int32_t zero_point);
+void ei_quantize_f32(const float *in, int8_t *out, size_t len, const ei_quant_params_t *params);
+void ei_dequantize_i8(const int8_t *in, float *out, size_t len, const ei_quant_params_t *params);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
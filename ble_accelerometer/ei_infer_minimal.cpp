@@ -33,7 +33,10 @@
 
 /* Include ----------------------------------------------------------------- */
 #include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
 #include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "ei_infer_minimal.h"
 
 /// TI Drivers used for inferencing: timing and serial output
 #include <ti/drivers/UART2.h>
@@ -43,17 +46,223 @@
 #include <ti/sysbios/knl/Clock.h>
 #include <unistd.h>
 
+/*
+ * With EI_IMU_STARTUP_TRACE=1 the first inference marks the classifier as
+ * ready, see ei_startup.h
+ */
+#ifndef EI_IMU_STARTUP_TRACE
+#define EI_IMU_STARTUP_TRACE 0
+#endif
+
+#if EI_IMU_STARTUP_TRACE
+#include "ei_startup.h"
+#endif
+
+/*
+ * ei_infer_i8 (EI_IMU_INT8_INPUT=1) and ei_infer_stepped (EI_IMU_STEPPED_INFERENCE=1)
+ * are only built when the task uses them, see ei_tirtos_task.c
+ */
+#ifndef EI_IMU_INT8_INPUT
+#define EI_IMU_INT8_INPUT 0
+#endif
+
+#ifndef EI_IMU_STEPPED_INFERENCE
+#define EI_IMU_STEPPED_INFERENCE 0
+#endif
+
+#if EI_IMU_INT8_INPUT
+#include "ei_imu_quant.h"
+#endif
+
+#if EI_IMU_STEPPED_INFERENCE
+#include "ei_step_exec.h"
+#endif
 
 /// state for timing and serial output
 static UART2_Handle uart = NULL;
 static Timer_Handle timer_handle = NULL;
 static uint64_t timer_count = 0;
 
+/// run_classifier_init is left to the first inference, see classifier_init_once
+static bool classifier_ready = false;
+
+/// how results are printed, see ei_set_output
+static ei_output_format_t output_format = EI_OUTPUT_TEXT;
+static float detect_threshold = 0.8f;
+
+#if EI_IMU_INT8_INPUT
+/// int8 window currently being classified by ei_infer_i8
+static const int8_t *i8_window = NULL;
+static const ei_quant_params_t *i8_params = NULL;
+#endif
+
+#if EI_IMU_STEPPED_INFERENCE
+/// stepped inference, see ei_infer_stepped_init
+static ei_step_exec_t step_exec;
+#if EI_IMU_MEM_PLAN
+static float *step_features = NULL;     // in the memory plan of the task, see ei_infer_stepped_set_features
+#else
+static float step_features_buf[EI_CLASSIFIER_NN_INPUT_FRAME_SIZE];
+static float *step_features = step_features_buf;
+#endif
+static signal_t *step_signal = NULL;
+static ei_impulse_result_t *step_result = NULL;
+static bool step_debug = false;
+#endif
+
 /// private function prototypes
 void timer_Callback(Timer_Handle _myHandle, int_fast16_t _status);
 
+static void print_result(ei_impulse_result_t *result)
+{
+    // print the predictions, but only if valid labels are present
+    if (!result->label_detected) {
+        return;
+    }
+
+    size_t top = 0;
+    for (size_t ix = 1; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        if (result->classification[ix].value > result->classification[top].value) {
+            top = ix;
+        }
+    }
+
+    switch (output_format) {
+    case EI_OUTPUT_TEXT:
+        ei_printf("\r\nPredictions (DSP: %d ms., Classification: %d ms., Anomaly: %d ms.): \r\n",
+            result->timing.dsp, result->timing.classification, result->timing.anomaly);
+        for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+            ei_printf("    %s: \t", result->classification[ix].label);
+            // printing floating point
+            ei_printf("%d%%", (int32_t) (result->classification[ix].value * 100.0));
+            ei_printf("\r\n");
+        }
+#if EI_CLASSIFIER_HAS_ANOMALY == 1
+        {
+            int32_t milli = (int32_t) (result->anomaly * 1000.0f);
+            ei_printf("    anomaly: \t%s%d.%03d\r\n", (milli < 0) ? "-" : "", (int)(abs(milli) / 1000), (int)(abs(milli) % 1000));
+        }
+#endif
+        break;
+    case EI_OUTPUT_CSV:
+        ei_printf("%u,%d,%d", (unsigned)timer_count, result->timing.dsp, result->timing.classification);
+        for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+            ei_printf(",%d", (int32_t) (result->classification[ix].value * 100.0));
+        }
+#if EI_CLASSIFIER_HAS_ANOMALY == 1
+        // anomaly score in thousandths
+        ei_printf(",%d", (int32_t) (result->anomaly * 1000.0f));
+#endif
+        ei_printf("\r\n");
+        break;
+    case EI_OUTPUT_DETECT:
+        if (result->classification[top].value >= detect_threshold) {
+            ei_printf("%s %d%%\r\n", result->classification[top].label,
+                (int32_t) (result->classification[top].value * 100.0));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+#if EI_IMU_INT8_INPUT
+/**
+ * @brief signal_t callback for ei_infer_i8, dequantizes only the chunk the SDK asks for
+ */
+static int i8_get_data(size_t offset, size_t length, float *out_ptr)
+{
+    ei_dequantize_i8(&i8_window[offset], out_ptr, length, i8_params);
+    return 0;
+}
+#endif
+
+#if EI_IMU_STEPPED_INFERENCE
+/**
+ * @brief Clock of the step executor. ei_read_timer_us only has the 1 ms
+ * resolution of Timer_getMs, steps are often shorter than that.
+ */
+static uint64_t step_now_us(void)
+{
+    return (uint64_t)Clock_getTicks() * Clock_tickPeriod;
+}
+
+/**
+ * @brief Step of ei_infer_stepped: run one DSP block into its slice of step_features
+ */
+static int step_dsp(void *ctx, uint32_t block_ix)
+{
+    ei_model_dsp_t block = ei_dsp_blocks[block_ix];
+    size_t offset = 0;
+
+    for (uint32_t ix = 0; ix < block_ix; ix++) {
+        offset += ei_dsp_blocks[ix].n_output_features;
+    }
+    if (offset + block.n_output_features > EI_CLASSIFIER_NN_INPUT_FRAME_SIZE) {
+        ei_printf("ERR: Would write outside feature buffer\r\n");
+        return -1;
+    }
+
+    ei::matrix_t fm(1, block.n_output_features, step_features + offset);
+#if EIDSP_SIGNAL_C_FN_POINTER
+    int ret = block.extract_fn(step_signal, &fm, block.config, EI_CLASSIFIER_FREQUENCY);
+#else
+    SignalWithAxes swa(step_signal, block.axes, block.axes_size);
+    int ret = block.extract_fn(swa.get_signal(), &fm, block.config, EI_CLASSIFIER_FREQUENCY);
+#endif
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to run DSP process (%d)\r\n", ret);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Last step of ei_infer_stepped: classifier and anomaly detection.
+ * The network itself runs in one go, the SDK does not expose its layers.
+ */
+static int step_classify(void *ctx, uint32_t arg)
+{
+    // DSP time without the time other tasks ran in between
+    uint64_t dsp_us = 0;
+    for (uint8_t ix = 0; ix < step_exec.n_steps - 1; ix++) {
+        dsp_us += step_exec.steps[ix].last_us;
+    }
+    step_result->timing.dsp = (int)(dsp_us / 1000);
+
+    ei::matrix_t features_matrix(1, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE, step_features);
+    EI_IMPULSE_ERROR r = run_inference(&features_matrix, step_result, step_debug);
+    if (r != EI_IMPULSE_OK) {
+        ei_printf("ERR: Failed to run classifier (%d)\r\n", r);
+        return -1;
+    }
+
+    return 0;
+}
+#endif
+
+/**
+ * @brief Initialize the SDK internals on first use, so ei_init returns without
+ * them and the sensor can be started and sampled first
+ */
+static void classifier_init_once(void)
+{
+    if (classifier_ready) {
+        return;
+    }
+    run_classifier_init();
+    classifier_ready = true;
+#if EI_IMU_STARTUP_TRACE
+    ei_startup_mark(EI_STARTUP_CLASSIFIER_READY);
+#endif
+}
+
 /*
- * @brief Initialize peripherals and SDK routines needed to run inference. Run this exactly once
+ * @brief Initialize peripherals needed to run inference. Run this exactly once
+ *
+ * The SDK internals are initialized by the first inference, after the first
+ * window has been sampled.
  */
 extern "C" void ei_init(void) {
     // Setup up UART2 as target for ei_print functions
@@ -73,9 +282,6 @@ extern "C" void ei_init(void) {
     timer_params.timerCallback = timer_Callback;
     timer_handle = Timer_open(CONFIG_TIMER_0, &timer_params);
     Timer_start(timer_handle);
-
-    // Setup the edge impulse SDK internals
-    run_classifier_init();
 }
 
 /*
@@ -108,26 +314,161 @@ extern "C" ei_impulse_result_t ei_infer(float *data, size_t len, bool debug)
     numpy::signal_from_buffer(data, len, &signal);
     ei_impulse_result_t result = { 0 };
 
+    classifier_init_once();
     EI_IMPULSE_ERROR r = run_classifier(&signal, &result, debug);
     if (r != EI_IMPULSE_OK) {
         ei_printf("ERR: Failed to run classifier (%d)\r\n", r);
         while(1);
     }
 
-    // print the predictions, but only if valid labels are present
-    if (result.label_detected) {
-        ei_printf("\r\nPredictions (DSP: %d ms., Classification: %d ms., Anomaly: %d ms.): \r\n",
-            result.timing.dsp, result.timing.classification, result.timing.anomaly);
-        for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
-            ei_printf("    %s: \t", result.classification[ix].label);
-            // printing floating point
-            ei_printf("%d%%", (int32_t) (result.classification[ix].value * 100.0));
-            ei_printf("\r\n");
+    print_result(&result);
+    return result;
+}
+
+extern "C" void ei_infer_prepare(void)
+{
+    classifier_init_once();
+}
+
+#if EI_IMU_INT8_INPUT
+/*
+ * @brief Run inference on a window stored as int8, see imu_fill_window_i8
+ *
+ * The window is never expanded to floats as a whole: the SDK reads it through a
+ * signal_t callback which dequantizes one chunk at a time. Use this with impulses
+ * that feed the raw window to the network (Raw Data block), and quantize with the
+ * input scale and zero point of the model so no precision is lost at the input.
+ *
+ * @param data A pointer to the quantized window
+ *
+ * @param len The length of the data buffer
+ *
+ * @param params The quantization used to store the window
+ *
+ * @param debug Enables logging internally in the Edge Impulse SDK
+ */
+extern "C" ei_impulse_result_t ei_infer_i8(const int8_t *data, size_t len, const ei_quant_params_t *params, bool debug)
+{
+    signal_t signal;
+    signal.total_length = len;
+    signal.get_data = &i8_get_data;
+    ei_impulse_result_t result = { 0 };
+
+    i8_window = data;
+    i8_params = params;
+
+    classifier_init_once();
+    EI_IMPULSE_ERROR r = run_classifier(&signal, &result, debug);
+    if (r != EI_IMPULSE_OK) {
+        ei_printf("ERR: Failed to run classifier (%d)\r\n", r);
+        while(1);
+    }
+
+    print_result(&result);
+    return result;
+}
+#endif
+
+#if EI_IMU_STEPPED_INFERENCE
+/*
+ * @brief Buffer of the features of ei_infer_stepped, with EI_IMU_MEM_PLAN it is
+ * placed by the task
+ */
+extern "C" void ei_infer_stepped_set_features(float *features)
+{
+    step_features = features;
+}
+
+/*
+ * @brief Setup ei_infer_stepped. Call once, after ei_init
+ *
+ * Inference is split into one step per DSP block plus one step for the classifier.
+ * Between steps, the yield function is called whenever budget_us of CPU time has
+ * been used since the last yield, so lower or equal priority tasks are not starved
+ * for a whole inference.
+ *
+ * @param budget_us CPU time allowed between two yields
+ *
+ * @param yield e.g. Task_yield, or a short Task_sleep to let lower priority tasks run
+ *
+ * @return int, 0 => OK
+ */
+extern "C" int ei_infer_stepped_init(uint32_t budget_us, void (*yield)(void))
+{
+    if (step_features == NULL) {
+        return -1;
+    }
+    if (ei_step_exec_init(&step_exec, budget_us, step_now_us, yield, NULL) != 0) {
+        return -1;
+    }
+    for (size_t ix = 0; ix < ei_dsp_blocks_size; ix++) {
+        if (ei_step_exec_add(&step_exec, "dsp", step_dsp, (uint32_t)ix) != 0) {
+            return -1;
         }
     }
+
+    return ei_step_exec_add(&step_exec, "classify", step_classify, 0);
+}
+
+/*
+ * @brief Same as ei_infer, run through the steps setup by ei_infer_stepped_init
+ *
+ * @param data A pointer to the data buffer of sensor samples
+ *
+ * @param len The length of the data buffer
+ *
+ * @param debug Enables logging internally in the Edge Impulse SDK
+ */
+extern "C" ei_impulse_result_t ei_infer_stepped(float *data, size_t len, bool debug)
+{
+    signal_t signal;
+    numpy::signal_from_buffer(data, len, &signal);
+    ei_impulse_result_t result = { 0 };
+
+    step_signal = &signal;
+    step_result = &result;
+    step_debug = debug;
+
+    classifier_init_once();
+    if (ei_step_exec_run(&step_exec) != 0) {
+        ei_printf("ERR: Failed to run classifier\r\n");
+        while(1);
+    }
+
+    print_result(&result);
     return result;
 }
 
+/*
+ * @brief Print the timing of every step of ei_infer_stepped
+ */
+extern "C" void ei_infer_stepped_print_stats(void)
+{
+    ei_printf("Steps (budget %u us, %u yields, %u over budget, longest burst %u us):\r\n",
+        (unsigned)step_exec.budget_us, (unsigned)step_exec.yields,
+        (unsigned)step_exec.overruns, (unsigned)step_exec.worst_burst_us);
+    for (uint8_t ix = 0; ix < step_exec.n_steps; ix++) {
+        const ei_step_t *step = &step_exec.steps[ix];
+        ei_printf("    %s %u: \tlast %u us, worst %u us, avg %u us\r\n",
+            step->name, (unsigned)step->arg, (unsigned)step->last_us, (unsigned)step->worst_us,
+            (unsigned)(step->runs ? step->total_us / step->runs : 0));
+    }
+}
+#endif
+
+/*
+ * @brief Select how ei_infer and friends print results
+ *
+ * @param format EI_OUTPUT_TEXT (default), EI_OUTPUT_CSV, EI_OUTPUT_DETECT or EI_OUTPUT_NONE
+ *
+ * @param threshold minimum top score printed with EI_OUTPUT_DETECT
+ */
+extern "C" void ei_set_output(ei_output_format_t format, float threshold)
+{
+    output_format = format;
+    detect_threshold = threshold;
+}
+
 /*
  * @brief Workaround if `usleep` is missing from some TIRTOS build (posix may not be enabled)
  */
@@ -178,3 +519,33 @@ extern "C" void Serial_Out(char *string, int length)
     UART2_write(uart, string, length, &bytes_written);
 }
 
+/**
+ * @brief Read what has been received on UART2 so far, never blocks
+ *
+ * @return number of bytes copied to buf
+ */
+extern "C" int Serial_In(char *buf, int length)
+{
+    size_t bytes_read = 0;
+    UART2_read(uart, buf, length, &bytes_read);
+    return (int)bytes_read;
+}
+
+/**
+ * @brief printf for the C sources of the example, e.g. ei_tirtos_task.c.
+ *
+ * The SDK declares ei_printf with C++ linkage unless EI_C_LINKAGE=1, so C code
+ * cannot call it directly: this formats the message and hands it to ei_printf.
+ */
+extern "C" void Serial_Printf(const char *format, ...)
+{
+    char buf[256];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    ei_printf("%s", buf);
+}
+
@@ -42,12 +42,28 @@
 #include <stdlib.h>
 #include "ei_classifier_types.h"
 
+#if EI_IMU_INT8_INPUT
+#include "ei_imu_quant.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Result output of ei_infer, see ei_set_output */
+typedef enum {
+    EI_OUTPUT_TEXT,         // timing and all scores
+    EI_OUTPUT_CSV,          // one line per result: time, timing, scores, anomaly
+    EI_OUTPUT_DETECT,       // only the top label, and only above the threshold
+    EI_OUTPUT_NONE
+} ei_output_format_t;
+
 /* Function prototypes ----------------------------------------------------- */
 
 /*
  * @brief Initialize peripherals and SDK routines needed to run inference. Run this exactly once
  */
-extern int ei_init(void);
+extern void ei_init(void);
 
 /*
  * @brief Minimal example function for running inference on a buffer of time series data
@@ -75,4 +91,83 @@ extern int ei_init(void);
  */
 extern ei_impulse_result_t ei_infer(float *data, size_t len, bool debug);
 
+#if EI_IMU_INT8_INPUT
+/*
+ * @brief Run inference on a window stored as int8 (see imu_fill_window_i8).
+ * The window is dequantized chunk by chunk as the SDK reads it.
+ *
+ * @param data A pointer to the quantized window
+ *
+ * @param len The length of the data buffer
+ *
+ * @param params The quantization used to store the window
+ *
+ * @param debug Enables logging internally in the Edge Impulse SDK
+ */
+extern ei_impulse_result_t ei_infer_i8(const int8_t *data, size_t len, const ei_quant_params_t *params, bool debug);
+#endif
+
+/*
+ * @brief Initialize the SDK internals now instead of in the first inference,
+ * e.g. in a window the cascade does not classify. Does nothing once done.
+ */
+extern void ei_infer_prepare(void);
+
+#if EI_IMU_STEPPED_INFERENCE
+/*
+ * @brief Setup ei_infer_stepped: one step per DSP block and one for the classifier,
+ * yield is called between steps once budget_us of CPU time has been used.
+ *
+ * @return int, 0 => OK
+ */
+extern int ei_infer_stepped_init(uint32_t budget_us, void (*yield)(void));
+
+/*
+ * @brief With EI_IMU_MEM_PLAN, the buffer of EI_CLASSIFIER_NN_INPUT_FRAME_SIZE
+ * floats ei_infer_stepped computes the features in. Call before ei_infer_stepped_init.
+ */
+extern void ei_infer_stepped_set_features(float *features);
+
+/*
+ * @brief Same as ei_infer, but yields between steps (see ei_infer_stepped_init)
+ */
+extern ei_impulse_result_t ei_infer_stepped(float *data, size_t len, bool debug);
+
+/*
+ * @brief Print the per step timing of ei_infer_stepped
+ */
+extern void ei_infer_stepped_print_stats(void);
+#endif
+
+/*
+ * @brief Select how results are printed
+ */
+extern void ei_set_output(ei_output_format_t format, float threshold);
+
+/*
+ * @brief Non-blocking read of the bytes received on UART2
+ *
+ * @return number of bytes copied to buf
+ */
+extern int Serial_In(char *buf, int length);
+
+/*
+ * @brief Write length bytes of string to UART2
+ */
+extern void Serial_Out(char *string, int length);
+
+/*
+ * @brief printf over UART2 for C code, ei_printf has C++ linkage in the SDK
+ */
+extern void Serial_Printf(const char *format, ...);
+
+/*
+ * @brief Milliseconds counted by CONFIG_TIMER_0 since ei_init
+ */
+extern uint64_t Timer_getMs(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,135 @@
+/* Effective sample rate estimator. See ei_sample_rate.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <math.h>
+#include <string.h>
+
+#include "ei_sample_rate.h"
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Setup an estimator
+ *
+ * @param nominal_us requested sampling period, the running average starts there
+ *
+ * @param alpha weight of every new interval in the running average, e.g.
+ * 1/32 to average over the last ~32 samples
+ *
+ * @return int, 0 => OK
+ */
+int ei_rate_init(ei_sample_rate_t *r, uint32_t nominal_us, float alpha)
+{
+    if (nominal_us == 0 || alpha <= 0.0f || alpha > 1.0f) {
+        return -1;
+    }
+
+    memset(r, 0, sizeof(ei_sample_rate_t));
+    r->nominal_us = nominal_us;
+    r->alpha = alpha;
+    r->avg_us = (float)nominal_us;
+    ei_rate_reset(r);
+
+    return 0;
+}
+
+/**
+ * @brief Clear the statistics since reset, the running average is kept
+ */
+void ei_rate_reset(ei_sample_rate_t *r)
+{
+    r->intervals = 0;
+    r->gaps = 0;
+    r->mean_us = 0.0f;
+    r->m2 = 0.0f;
+    r->min_us = UINT32_MAX;
+    r->max_us = 0;
+}
+
+/**
+ * @brief Do not measure the interval from the previous sample to the next one
+ */
+void ei_rate_restart(ei_sample_rate_t *r)
+{
+    r->has_last = false;
+}
+
+/**
+ * @brief Add the timestamp of a sample, in us of a monotonic clock
+ */
+void ei_rate_push(ei_sample_rate_t *r, uint64_t ts_us)
+{
+    bool has_last = r->has_last;
+    uint64_t last_us = r->last_us;
+
+    r->has_last = true;
+    r->last_us = ts_us;
+    if (!has_last || ts_us < last_us) {
+        return;
+    }
+
+    uint64_t interval = ts_us - last_us;
+    if (interval > (uint64_t)r->nominal_us * EI_RATE_GAP_FACTOR) {
+        r->gaps++;
+        return;
+    }
+
+    float us = (float)interval;
+    r->avg_us += r->alpha * (us - r->avg_us);
+
+    // Welford, numerically stable in float over long runs
+    r->intervals++;
+    float delta = us - r->mean_us;
+    r->mean_us += delta / (float)r->intervals;
+    r->m2 += delta * (us - r->mean_us);
+    if (interval < r->min_us) {
+        r->min_us = (uint32_t)interval;
+    }
+    if (interval > r->max_us) {
+        r->max_us = (uint32_t)interval;
+    }
+}
+
+/**
+ * @return int, 0 => OK, -1 if no interval was measured since reset
+ */
+int ei_rate_get(const ei_sample_rate_t *r, ei_sample_rate_stats_t *out)
+{
+    memset(out, 0, sizeof(ei_sample_rate_stats_t));
+    out->intervals = r->intervals;
+    out->gaps = r->gaps;
+    if (r->intervals == 0) {
+        return -1;
+    }
+
+    out->interval_us = r->avg_us;
+    out->rate_hz = 1000000.0f / r->avg_us;
+    out->drift_ppm = (int32_t)((r->avg_us - (float)r->nominal_us) * 1000000.0f / (float)r->nominal_us);
+    out->mean_us = r->mean_us;
+    out->jitter_us = (r->intervals > 1) ? sqrtf(r->m2 / (float)(r->intervals - 1)) : 0.0f;
+    out->min_us = r->min_us;
+    out->max_us = r->max_us;
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/* Effective sample rate estimator. The acquisition pushes the timestamp of
+ * every sample; the interval to the previous sample feeds a running average,
+ * which follows slow drift such as a sleep that does not account for the I2C
+ * read, and a mean, standard deviation (jitter), minimum and maximum since the
+ * last reset. Intervals over EI_RATE_GAP_FACTOR times the nominal period, e.g.
+ * after a failed read, are counted as gaps instead. Call ei_rate_restart where
+ * sampling pauses on purpose, e.g. between windows, so the pause is not
+ * counted at all.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_SAMPLE_RATE_H
+#define EI_SAMPLE_RATE_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defines ----------------------------------------------------------------- */
+#ifndef EI_RATE_GAP_FACTOR
+#define EI_RATE_GAP_FACTOR          4
+#endif
+
+/* Types ------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t nominal_us;        // requested sampling period
+    float alpha;                // weight of a new interval in the running average
+    bool has_last;
+    uint64_t last_us;           // timestamp of the previous sample
+    float avg_us;               // running average interval
+
+    uint32_t intervals;         // since reset
+    uint32_t gaps;
+    float mean_us;
+    float m2;                   // sum of squared deviations from mean_us
+    uint32_t min_us;
+    uint32_t max_us;
+} ei_sample_rate_t;
+
+/** Measured rate, intervals in us */
+typedef struct {
+    float rate_hz;              // from the running average
+    float interval_us;          // running average
+    int32_t drift_ppm;          // of the running average against the nominal period
+    float mean_us;              // since reset
+    float jitter_us;            // standard deviation since reset
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t intervals;
+    uint32_t gaps;
+} ei_sample_rate_stats_t;
+
+/* Function prototypes ----------------------------------------------------- */
+int ei_rate_init(ei_sample_rate_t *r, uint32_t nominal_us, float alpha);
+void ei_rate_reset(ei_sample_rate_t *r);
+void ei_rate_restart(ei_sample_rate_t *r);
+void ei_rate_push(ei_sample_rate_t *r, uint64_t ts_us);
+int ei_rate_get(const ei_sample_rate_t *r, ei_sample_rate_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
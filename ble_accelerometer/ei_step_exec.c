@@ -0,0 +1,185 @@
+/* Cooperative step executor. See ei_step_exec.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "ei_step_exec.h"
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Setup an executor without steps
+ *
+ * @param budget_us CPU time allowed between two yields. A step is never split,
+ * so a single step longer than the budget still runs in one go (see overruns)
+ *
+ * @param now_us monotonic clock in us
+ *
+ * @param yield called by ei_step_exec_run between bursts, may be NULL when
+ * only ei_step_exec_poll is used
+ *
+ * @param ctx passed to every step
+ *
+ * @return int, 0 => OK
+ */
+int ei_step_exec_init(ei_step_exec_t *exec, uint32_t budget_us, uint64_t (*now_us)(void),
+                      void (*yield)(void), void *ctx)
+{
+    if (now_us == NULL || budget_us == 0) {
+        return -1;
+    }
+
+    memset(exec, 0, sizeof(ei_step_exec_t));
+    exec->budget_us = budget_us;
+    exec->now_us = now_us;
+    exec->yield = yield;
+    exec->ctx = ctx;
+
+    return 0;
+}
+
+/**
+ * @brief Append a step, steps run in the order they are added
+ *
+ * @return int, 0 => OK
+ */
+int ei_step_exec_add(ei_step_exec_t *exec, const char *name, ei_step_fn_t fn, uint32_t arg)
+{
+    if (fn == NULL || exec->n_steps >= EI_STEP_MAX_STEPS) {
+        return -1;
+    }
+
+    ei_step_t *step = &exec->steps[exec->n_steps++];
+    memset(step, 0, sizeof(ei_step_t));
+    step->name = name;
+    step->fn = fn;
+    step->arg = arg;
+
+    return 0;
+}
+
+/**
+ * @brief Run steps until the budget is used up or the last step is done.
+ * At least one step runs per call. A step is not started if its last duration
+ * would not fit in what is left of the budget, so the burst stays bounded
+ * once every step has run once.
+ *
+ * @return int, 1 => all steps done, 0 => steps left (yield, then poll again),
+ * -1 => a step failed, the next poll starts over from the first step
+ */
+int ei_step_exec_poll(ei_step_exec_t *exec)
+{
+    uint64_t burst_start = exec->now_us();
+    uint32_t burst_us = 0;
+    bool ran = false;
+    bool failed = false;
+
+    while (exec->next < exec->n_steps) {
+        ei_step_t *step = &exec->steps[exec->next];
+
+        if (ran && burst_us + step->last_us > exec->budget_us) {
+            break;
+        }
+
+        uint64_t start = exec->now_us();
+        int ret = step->fn(exec->ctx, step->arg);
+        uint64_t end = exec->now_us();
+        uint32_t elapsed = (uint32_t)(end - start);
+
+        step->runs++;
+        step->last_us = elapsed;
+        step->total_us += elapsed;
+        if (elapsed > step->worst_us) {
+            step->worst_us = elapsed;
+        }
+        if (elapsed > exec->budget_us) {
+            exec->overruns++;
+        }
+
+        burst_us = (uint32_t)(end - burst_start);
+        ran = true;
+
+        if (ret != 0) {
+            exec->next = 0;
+            failed = true;
+            break;
+        }
+        exec->next++;
+
+        if (burst_us >= exec->budget_us) {
+            break;
+        }
+    }
+
+    if (burst_us > exec->worst_burst_us) {
+        exec->worst_burst_us = burst_us;
+    }
+
+    if (failed) {
+        return -1;
+    }
+    if (exec->next < exec->n_steps) {
+        return 0;
+    }
+
+    exec->next = 0;
+    exec->passes++;
+    return 1;
+}
+
+/**
+ * @brief Run all steps, yielding between bursts
+ *
+ * @return int, 0 => OK
+ */
+int ei_step_exec_run(ei_step_exec_t *exec)
+{
+    int ret;
+
+    while ((ret = ei_step_exec_poll(exec)) == 0) {
+        if (exec->yield != NULL) {
+            exec->yield();
+        }
+        exec->yields++;
+    }
+
+    return (ret == 1) ? 0 : -1;
+}
+
+/**
+ * @brief Clear the timing of all steps and the executor counters
+ */
+void ei_step_exec_reset_stats(ei_step_exec_t *exec)
+{
+    for (uint8_t ix = 0; ix < exec->n_steps; ix++) {
+        ei_step_t *step = &exec->steps[ix];
+        step->runs = 0;
+        step->last_us = 0;
+        step->worst_us = 0;
+        step->total_us = 0;
+    }
+    exec->passes = 0;
+    exec->yields = 0;
+    exec->overruns = 0;
+    exec->worst_burst_us = 0;
+}
@@ -0,0 +1,92 @@
+/* Cooperative step executor. A long computation, such as one inference, is
+ * registered as a list of steps which each run to completion. After a step,
+ * if the time used since the last yield exceeds the step budget, the executor
+ * yields so that other tasks (e.g. the BLE application task) get the CPU
+ * before the next step starts. Per-step timing is recorded.
+ *
+ * The clock and the yield are passed in, so the executor has no RTOS
+ * dependency and can be driven by a simulated scheduler on a host.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_STEP_EXEC_H
+#define EI_STEP_EXEC_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defines ----------------------------------------------------------------- */
+#ifndef EI_STEP_MAX_STEPS
+#define EI_STEP_MAX_STEPS           8
+#endif
+
+/* Types ------------------------------------------------------------------- */
+
+/** A step, arg tells apart steps sharing the same function. 0 => OK */
+typedef int (*ei_step_fn_t)(void *ctx, uint32_t arg);
+
+/** One registered step and its timing, times in us */
+typedef struct {
+    const char *name;
+    ei_step_fn_t fn;
+    uint32_t arg;
+    uint32_t runs;
+    uint32_t last_us;
+    uint32_t worst_us;
+    uint64_t total_us;
+} ei_step_t;
+
+typedef struct {
+    ei_step_t steps[EI_STEP_MAX_STEPS];
+    uint8_t n_steps;
+    uint8_t next;               // step to run on the next poll
+    void *ctx;
+
+    uint32_t budget_us;         // CPU time allowed between two yields
+    uint64_t (*now_us)(void);
+    void (*yield)(void);
+
+    uint32_t passes;            // completed runs over all steps
+    uint32_t yields;
+    uint32_t overruns;          // single steps that alone exceeded the budget
+    uint32_t worst_burst_us;    // longest CPU burst without a yield
+} ei_step_exec_t;
+
+/* Function prototypes ----------------------------------------------------- */
+int ei_step_exec_init(ei_step_exec_t *exec, uint32_t budget_us, uint64_t (*now_us)(void),
+                      void (*yield)(void), void *ctx);
+int ei_step_exec_add(ei_step_exec_t *exec, const char *name, ei_step_fn_t fn, uint32_t arg);
+int ei_step_exec_poll(ei_step_exec_t *exec);
+int ei_step_exec_run(ei_step_exec_t *exec);
+void ei_step_exec_reset_stats(ei_step_exec_t *exec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -37,27 +37,1080 @@
 #include "model-parameters/model_metadata.h"
 
 #include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Clock.h>
 
 // stack size may need to be modified depending on the Impulse used
 #define EI_TASK_STACK_SIZE 4096
 
+#ifndef EI_TASK_PRIORITY
+#define EI_TASK_PRIORITY 1
+#endif
+
 static uint8_t eiTaskStack[EI_TASK_STACK_SIZE];
 static Task_Struct eiTask;
 
-static float data[EI_CLASSIFIER_NN_INPUT_FRAME_SIZE];
+/*
+ * Set EI_IMU_INT8_INPUT=1 to quantize samples as they arrive and keep the window
+ * as int8, for int8 quantized impulses using the Raw Data block. The window then
+ * takes a quarter of the RAM of the float window.
+ */
+#ifndef EI_IMU_INT8_INPUT
+#define EI_IMU_INT8_INPUT 0
+#endif
+
+#if EI_IMU_INT8_INPUT
+#if !defined(EI_CLASSIFIER_TFLITE_INPUT_QUANTIZED) || (EI_CLASSIFIER_TFLITE_INPUT_QUANTIZED != 1)
+#error "EI_IMU_INT8_INPUT requires an int8 quantized impulse"
+#endif
+#if EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME >= 6
+#error "EI_IMU_INT8_INPUT is not supported with fused 6-axis windows"
+#endif
+
+// the Raw Data block passes samples to the network unchanged (scale axes of 1)
+#ifndef EI_IMU_INT8_SCALE
+#define EI_IMU_INT8_SCALE EI_CLASSIFIER_TFLITE_INPUT_SCALE
+#endif
+#ifndef EI_IMU_INT8_ZERO_POINT
+#define EI_IMU_INT8_ZERO_POINT EI_CLASSIFIER_TFLITE_INPUT_ZEROPOINT
+#endif
+
+typedef int8_t window_t;
+static ei_quant_params_t quant;
+#else
+typedef float window_t;
+#endif
+
+/*
+ * Set EI_IMU_MEM_PLAN=1 and copy ei_mem_plan.* from the common directory to
+ * overlay the buffers of the task in one region by the stages they are used in
+ * (see the memory plan below): the window, the features of the stepped inference
+ * and the result log download chunk.
+ */
+#ifndef EI_IMU_MEM_PLAN
+#define EI_IMU_MEM_PLAN 0
+#endif
+
+#if EI_IMU_MEM_PLAN
+static window_t *data;      // placed by mem_plan_init
+#else
+static window_t data[EI_CLASSIFIER_NN_INPUT_FRAME_SIZE];
+#endif
+
+/*
+ * Set EI_IMU_PREROLL=1 to keep the last EI_IMU_PREROLL_PRE_MS of raw samples
+ * (int16, in units of 1/EI_IMU_PREROLL_SCALE m/s2). When a label scores at least
+ * EI_PREROLL_THRESHOLD, a snapshot including EI_IMU_PREROLL_POST_MS after the
+ * detection is streamed out over UART2 in binary chunks (see ei_preroll.h).
+ */
+#ifndef EI_IMU_PREROLL
+#define EI_IMU_PREROLL 0
+#endif
+
+#if EI_IMU_PREROLL
+#include "ei_preroll.h"
+
+#if EI_IMU_INT8_INPUT
+#error "EI_IMU_PREROLL records the float window and is not supported with EI_IMU_INT8_INPUT"
+#endif
+
+#ifndef EI_IMU_PREROLL_PRE_MS
+#define EI_IMU_PREROLL_PRE_MS       2000
+#endif
+#ifndef EI_IMU_PREROLL_POST_MS
+#define EI_IMU_PREROLL_POST_MS      1000
+#endif
+#ifndef EI_IMU_PREROLL_SCALE
+#define EI_IMU_PREROLL_SCALE        100.0f
+#endif
+#ifndef EI_PREROLL_THRESHOLD
+#define EI_PREROLL_THRESHOLD        0.8f
+#endif
+#ifndef EI_PREROLL_CHUNK_SAMPLES
+#define EI_PREROLL_CHUNK_SAMPLES    512
+#endif
+
+#define PREROLL_PRE_SAMPLES         ((EI_IMU_PREROLL_PRE_MS / EI_CLASSIFIER_INTERVAL_MS) * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME)
+#define PREROLL_POST_SAMPLES        ((EI_IMU_PREROLL_POST_MS / EI_CLASSIFIER_INTERVAL_MS) * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME)
+// windows are recorded whole, leave room for one more while streaming
+#define PREROLL_CAPACITY            (PREROLL_PRE_SAMPLES + PREROLL_POST_SAMPLES + EI_CLASSIFIER_NN_INPUT_FRAME_SIZE)
+
+static int16_t preroll_buf[PREROLL_CAPACITY];
+static ei_preroll_t preroll;
+
+static void preroll_write_uart(const void *buf, size_t len)
+{
+    Serial_Out((char *)buf, (int)len);
+}
+
+/*
+ * Convert the float window to int16 in small blocks and record it
+ */
+static void preroll_record_window(const float *window, size_t len)
+{
+    int16_t block[32];
+
+    for (size_t ix = 0; ix < len; ix += 32) {
+        size_t n = (len - ix < 32) ? len - ix : 32;
+        for (size_t k = 0; k < n; k++) {
+            float v = window[ix + k] * EI_IMU_PREROLL_SCALE;
+            v = (v > 32767.0f) ? 32767.0f : ((v < -32768.0f) ? -32768.0f : v);
+            block[k] = (int16_t)v;
+        }
+        ei_preroll_write(&preroll, block, n);
+    }
+}
+#endif
+
+/*
+ * Set EI_IMU_ENERGY=1 and copy ei_energy.* from the common directory to account
+ * the time spent sampling, in the DSP block, in inference and on output (see
+ * ei_energy.h). ei_imu_energy returns the duty cycle and the estimated energy
+ * per inference, AT+STATS prints them.
+ */
+#ifndef EI_IMU_ENERGY
+#define EI_IMU_ENERGY 0
+#endif
+
+#if EI_IMU_ENERGY
+#include "ei_energy.h"
+
+static ei_energy_t energy;
+
+static uint64_t energy_now_us(void)
+{
+    return Timer_getMs() * 1000;
+}
+
+/*
+ * ei_infer runs in EI_ENERGY_LOG: the parts the SDK timed move to DSP and NN,
+ * the remainder is the printing of the result. Windows that were not classified
+ * have no timing, nothing moves
+ */
+static void energy_account_inference(const ei_impulse_result_t *result)
+{
+    ei_energy_charge(&energy, EI_ENERGY_DSP, (uint64_t)result->timing.dsp * 1000);
+    ei_energy_charge(&energy, EI_ENERGY_NN, (uint64_t)(result->timing.classification + result->timing.anomaly) * 1000);
+    if (result->label_detected) {
+        ei_energy_inference_done(&energy);
+    }
+}
+
+int ei_imu_energy(ei_energy_report_t *out)
+{
+    ei_energy_get_report(&energy, out);
+    return 0;
+}
+#endif
+
+/*
+ * Set EI_IMU_STARTUP_TRACE=1 and copy ei_startup.* from the common directory to
+ * timestamp the startup (see ei_startup.h): the IMU driver marks the first
+ * sample and ei_infer_minimal.cpp the classifier being ready. The times since
+ * boot are printed with the first result, and by AT+STATS.
+ */
+#ifndef EI_IMU_STARTUP_TRACE
+#define EI_IMU_STARTUP_TRACE 0
+#endif
+
+#if EI_IMU_STARTUP_TRACE
+#include "ei_startup.h"
+#include <ti/sysbios/knl/Clock.h>
+
+static uint64_t startup_now_us(void)
+{
+    return (uint64_t)Clock_getTicks() * Clock_tickPeriod;
+}
+
+static void print_startup(void)
+{
+    uint64_t us;
+    const char *sep = " ";
+
+    Serial_Printf("Startup (ms since boot):");
+    for (int ev = 0; ev < EI_STARTUP_N_EVENTS; ev++) {
+        if (ei_startup_get_us((ei_startup_event_t)ev, &us) == 0) {
+            Serial_Printf("%s%s %u", sep, ei_startup_event_name((ei_startup_event_t)ev), (unsigned)(us / 1000));
+            sep = ", ";
+        }
+    }
+    Serial_Printf("\r\n");
+}
+#endif
+
+/*
+ * Set EI_IMU_LATENCY=1 and copy ei_latency.* from the common directory to
+ * measure the age of every result (see ei_latency.h): the time from the last
+ * sample of the window, stamped by imu_sample, to the result being back in
+ * this task, including its output by ei_infer. ei_imu_latency returns the
+ * distribution, AT+STATS prints it.
+ */
+#ifndef EI_IMU_LATENCY
+#define EI_IMU_LATENCY 0
+#endif
+
+#if EI_IMU_LATENCY
+#include "ei_latency.h"
+#include <ti/sysbios/knl/Clock.h>
+
+// width of the first histogram buckets, 40 buckets then reach ~2 s
+#ifndef EI_IMU_LATENCY_UNIT_US
+#define EI_IMU_LATENCY_UNIT_US      1000
+#endif
+
+static ei_latency_t latency;
+
+int ei_imu_latency(ei_latency_t *out)
+{
+    *out = latency;
+    return 0;
+}
+#endif
+
+/*
+ * Set EI_IMU_STEPPED_INFERENCE=1 to run inference in steps (one per DSP block,
+ * one for the classifier) and give up the CPU between steps once
+ * EI_IMU_STEP_BUDGET_US has been used. The yield sleeps EI_IMU_STEP_YIELD_TICKS
+ * so that lower priority tasks can run too; 0 only yields to tasks of the same
+ * priority. This allows EI_TASK_PRIORITY to be raised without holding off BLE
+ * events for a whole inference.
+ */
+#ifndef EI_IMU_STEPPED_INFERENCE
+#define EI_IMU_STEPPED_INFERENCE 0
+#endif
+
+#if EI_IMU_STEPPED_INFERENCE
+#if EI_IMU_INT8_INPUT
+#error "EI_IMU_STEPPED_INFERENCE is not supported with EI_IMU_INT8_INPUT"
+#endif
+
+#ifndef EI_IMU_STEP_BUDGET_US
+#define EI_IMU_STEP_BUDGET_US       2000
+#endif
+#ifndef EI_IMU_STEP_YIELD_TICKS
+#define EI_IMU_STEP_YIELD_TICKS     1
+#endif
+
+static void step_yield(void)
+{
+#if EI_IMU_ENERGY
+    ei_energy_state_t state = ei_energy_enter(&energy, EI_ENERGY_ACQUIRE);
+#endif
+#if EI_IMU_STEP_YIELD_TICKS > 0
+    Task_sleep(EI_IMU_STEP_YIELD_TICKS);
+#else
+    Task_yield();
+#endif
+#if EI_IMU_ENERGY
+    ei_energy_enter(&energy, state);
+#endif
+}
+#endif
+
+/*
+ * Set EI_IMU_RESULT_LOG=1 to append every result (time, top label, score and
+ * timing) to a ring log in the NVS region EI_RESULT_LOG_NVS_INDEX, see
+ * ei_result_log.h. ei_log_request_download streams the logged records from a
+ * given sequence number on over UART2, e.g. when a central reconnects.
+ */
+#ifndef EI_IMU_RESULT_LOG
+#define EI_IMU_RESULT_LOG 0
+#endif
+
+#if EI_IMU_RESULT_LOG
+#include "ei_result_log.h"
+#include "ti_drivers_config.h"
+
+#ifndef EI_RESULT_LOG_NVS_INDEX
+#define EI_RESULT_LOG_NVS_INDEX     CONFIG_NVS_EI_LOG
+#endif
+#ifndef EI_RESULT_LOG_BATCH
+#define EI_RESULT_LOG_BATCH         16      // records programmed per flash write
+#endif
+#ifndef EI_RESULT_LOG_CHUNK
+#define EI_RESULT_LOG_CHUNK         32      // records read from flash per UART write
+#endif
+
+static ei_log_storage_t log_storage;
+static ei_result_log_t result_log;
+static ei_result_record_t log_batch[EI_RESULT_LOG_BATCH];
+static volatile bool log_download_requested = false;
+static volatile uint32_t log_download_from = 0;
+static bool log_downloading = false;
+static uint32_t log_download_next = 0;  // sequence number of the next chunk
+static bool log_opened = false;
+static bool log_ready = false;
+#if EI_IMU_MEM_PLAN
+static ei_result_record_t *log_chunk;   // EI_RESULT_LOG_CHUNK records, placed by mem_plan_init
+#endif
+
+void ei_log_request_download(uint32_t from_seq)
+{
+    log_download_from = from_seq;
+    log_download_requested = true;
+}
+
+/*
+ * Open the log on first use rather than at startup: recovering the write
+ * position reads the whole NVS region, which would delay the first window
+ */
+static bool log_open(void)
+{
+    if (!log_opened) {
+        log_opened = true;
+        log_ready = (ei_result_log_nvs_open(&log_storage, EI_RESULT_LOG_NVS_INDEX) == 0)
+            && (ei_result_log_init(&result_log, &log_storage, log_batch, EI_RESULT_LOG_BATCH) == 0);
+    }
+    return log_ready;
+}
+
+static void log_result(const ei_impulse_result_t *result, uint16_t label, float score)
+{
+    ei_result_record_t record = { 0 };
+    record.timestamp_ms = (uint32_t)Timer_getMs();
+    record.label = (uint8_t)label;
+    record.score = (uint16_t)(score * 10000.0f);
+    record.dsp_ms = (uint16_t)result->timing.dsp;
+    record.classification_ms = (uint16_t)result->timing.classification;
+    ei_result_log_append(&result_log, &record);
+}
+
+/*
+ * Send the requested records, from flash in bulk, as raw ei_result_record_t.
+ * One chunk per call, so a long log does not hold up sampling: called every
+ * pass of the loop until the last record has been sent. A new request
+ * restarts the download from its sequence number.
+ */
+static void log_download(void)
+{
+#if EI_IMU_MEM_PLAN
+    ei_result_record_t *records = log_chunk;
+#else
+    ei_result_record_t records[EI_RESULT_LOG_CHUNK];
+#endif
+    size_t n;
+
+    if (log_download_requested) {
+        log_download_requested = false;
+        log_download_next = log_download_from;
+        log_downloading = true;
+        ei_result_log_flush(&result_log);
+    }
+    n = ei_result_log_read(&result_log, log_download_next, records, EI_RESULT_LOG_CHUNK);
+    if (n == 0) {
+        log_downloading = false;
+        return;
+    }
+    Serial_Out((char *)records, (int)(n * sizeof(ei_result_record_t)));
+    log_download_next = records[n - 1].seq + 1;
+}
+#endif
+
+#if EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME >= 6
+// 6-axis impulses (accelerometer + gyroscope) sample both sensors at their own rate
+static ei_fusion_window_t fusion;
+#endif
+
+/*
+ * The accelerometer is read every sample interval by sleeping after each read,
+ * so the period is the interval plus the I2C transfer, and varies with the bus
+ * load. Set EI_IMU_RESAMPLE=1 to read on absolute deadlines instead and
+ * interpolate the timestamped reads onto the grid of the model (see
+ * imu_fill_window_resampled). Applies to 3-axis float windows, fused 6-axis
+ * windows are always resampled. Set EI_IMU_SAMPLE_RATE=1 and add
+ * ei_sample_rate.c to measure the effective rate and jitter, printed by AT+STATS.
+ */
+#ifndef EI_IMU_RESAMPLE
+#define EI_IMU_RESAMPLE 0
+#endif
+
+#ifndef EI_IMU_SAMPLE_RATE
+#define EI_IMU_SAMPLE_RATE 0
+#endif
+
+#if EI_IMU_RESAMPLE
+#if EI_IMU_INT8_INPUT
+#error "EI_IMU_RESAMPLE is not supported with EI_IMU_INT8_INPUT"
+#endif
+static ei_fusion_window_t resample;
+#endif
+
+/*
+ * Set EI_IMU_COMMANDS=1 to accept AT commands on UART2 between inferences (see
+ * ei_cmd.h): the sample interval, the detection threshold, the output format and
+ * SDK debug output can then be changed, and statistics dumped, without a rebuild.
+ */
+#ifndef EI_IMU_COMMANDS
+#define EI_IMU_COMMANDS 0
+#endif
+
+// top score from which a result counts as a detection (pre-roll trigger, DETECT output)
+#ifndef EI_DETECT_THRESHOLD
+#if EI_IMU_PREROLL
+#define EI_DETECT_THRESHOLD EI_PREROLL_THRESHOLD
+#else
+#define EI_DETECT_THRESHOLD 0.8f
+#endif
+#endif
+
+/// settings that can be changed at runtime, see EI_IMU_COMMANDS
+static uint32_t sample_interval_ms = EI_CLASSIFIER_INTERVAL_MS;
+static float detect_threshold = EI_DETECT_THRESHOLD;
+static ei_output_format_t output_format = EI_OUTPUT_TEXT;
+static bool sdk_debug = false;
+
+/*
+ * Stop when a window could not be sampled, e.g. a 6-axis impulse without a
+ * bmi160_getGyroData driver (see ei_imu_minimal.c)
+ */
+static void imu_check(int ret)
+{
+    if (ret != 0) {
+        Serial_Printf("ERR: Failed to sample the IMU (%d)\r\n", ret);
+        while(1);
+    }
+}
+
+#if !EI_IMU_INT8_INPUT && EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME < 6
+/*
+ * Sample len floats of 3-axis accelerometer data at the current interval
+ */
+static int fill_window(float *buf, size_t len)
+{
+#if EI_IMU_RESAMPLE
+    if (imu_resample_init(&resample, buf, len, sample_interval_ms * 1000)) {
+        return -1;
+    }
+    return imu_fill_window_resampled(&resample);
+#else
+    return imu_fill_window(buf, len, sample_interval_ms);
+#endif
+}
+#endif
+
+/*
+ * Set EI_IMU_WINDOW_STATS=1 to keep running per-axis statistics (mean, RMS,
+ * standard deviation, min, max) of the window, updated only with the frames
+ * that enter and leave it (see ei_window_stats.h). The window then slides by
+ * EI_IMU_STRIDE_FRAMES frames per inference, and windows in which every axis
+ * has a standard deviation below EI_IMU_PREFILTER_MIN_STD are not classified.
+ */
+#ifndef EI_IMU_WINDOW_STATS
+#define EI_IMU_WINDOW_STATS 0
+#endif
+
+#define WINDOW_AXES     EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME
+#define WINDOW_FRAMES   (EI_CLASSIFIER_NN_INPUT_FRAME_SIZE / EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME)
+
+#if EI_IMU_WINDOW_STATS
+#include <string.h>
+#include "ei_window_stats.h"
+
+#if EI_IMU_INT8_INPUT
+#error "EI_IMU_WINDOW_STATS is not supported with EI_IMU_INT8_INPUT"
+#endif
+#if WINDOW_FRAMES > EI_WSTATS_MAX_FRAMES
+#error "EI_IMU_WINDOW_STATS: the window is longer than EI_WSTATS_MAX_FRAMES"
+#endif
+
+// new frames per inference, a full window by default
+#ifndef EI_IMU_STRIDE_FRAMES
+#define EI_IMU_STRIDE_FRAMES        WINDOW_FRAMES
+#endif
+#if (EI_IMU_STRIDE_FRAMES < WINDOW_FRAMES) && (EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME >= 6)
+#error "EI_IMU_STRIDE_FRAMES: fused 6-axis windows are always sampled whole"
+#endif
+
+// in m/s2, 0 classifies every window
+#ifndef EI_IMU_PREFILTER_MIN_STD
+#define EI_IMU_PREFILTER_MIN_STD    0.0f
+#endif
+
+static int32_t wstats_mem[EI_WSTATS_MEM_WORDS(WINDOW_FRAMES, WINDOW_AXES)];
+static ei_window_stats_t wstats;
+static float prefilter_min_std = EI_IMU_PREFILTER_MIN_STD;
+static uint32_t windows_prefiltered = 0;
+
+int ei_imu_axis_stats(uint8_t axis, ei_axis_stats_t *out)
+{
+    return ei_wstats_get(&wstats, axis, out);
+}
+
+/*
+ * Sample the next stride and update the statistics with the new frames only
+ */
+static void window_update(void)
+{
+    size_t new_frames = WINDOW_FRAMES;
+
+#if EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME >= 6
+    imu_check(imu_fill_window_fused(&fusion));
+#else
+    if (ei_wstats_full(&wstats) && EI_IMU_STRIDE_FRAMES < WINDOW_FRAMES) {
+        new_frames = EI_IMU_STRIDE_FRAMES;
+        memmove(data, &data[new_frames * WINDOW_AXES], (WINDOW_FRAMES - new_frames) * WINDOW_AXES * sizeof(float));
+    }
+    imu_check(fill_window(&data[(WINDOW_FRAMES - new_frames) * WINDOW_AXES], new_frames * WINDOW_AXES));
+#endif
+
+    for (size_t ix = WINDOW_FRAMES - new_frames; ix < WINDOW_FRAMES; ix++) {
+        ei_wstats_push(&wstats, &data[ix * WINDOW_AXES]);
+    }
+#if EI_IMU_PREROLL
+    // windows overlap, only record the new frames
+    preroll_record_window(&data[(WINDOW_FRAMES - new_frames) * WINDOW_AXES], new_frames * WINDOW_AXES);
+#endif
+}
+
+/*
+ * Cheap check ahead of the classifier and anomaly detection: nothing moves
+ */
+static bool window_is_quiet(void)
+{
+    ei_axis_stats_t stats;
+
+    if (prefilter_min_std <= 0.0f) {
+        return false;
+    }
+    for (uint8_t axis = 0; axis < WINDOW_AXES; axis++) {
+        if (ei_wstats_get(&wstats, axis, &stats) != 0 || stats.std >= prefilter_min_std) {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
+/*
+ * Set EI_IMU_CASCADE=1 and copy ei_cascade.* from the common directory to score
+ * every window with a cheap first stage, EI_IMU_CASCADE_STAGE1, and to run the
+ * impulse only on windows that score at least EI_IMU_CASCADE_THRESHOLD, plus
+ * EI_IMU_CASCADE_HOLD windows after them. The default first stage is the
+ * standard deviation of the acceleration magnitude against its noise floor;
+ * map it to a function that runs a second, small impulse on the window to gate
+ * on a model instead. ei_imu_cascade returns the pass rates and time per stage.
+ */
+#ifndef EI_IMU_CASCADE
+#define EI_IMU_CASCADE 0
+#endif
+
+#if EI_IMU_CASCADE
+#if EI_IMU_INT8_INPUT
+#error "EI_IMU_CASCADE is not supported with EI_IMU_INT8_INPUT"
+#endif
+#include <math.h>
+#include "ei_cascade.h"
+
+// with the motion detector, 0.5 is twice the noise floor
+#ifndef EI_IMU_CASCADE_THRESHOLD
+#define EI_IMU_CASCADE_THRESHOLD    0.5f
+#endif
+#ifndef EI_IMU_CASCADE_HOLD
+#define EI_IMU_CASCADE_HOLD         0
+#endif
+#ifndef EI_IMU_CASCADE_STAGE1
+#define EI_IMU_CASCADE_STAGE1       cascade_motion_stage1
+#endif
+
+#define CASCADE_AXES                ((EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME < 3) ? EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME : 3)
+
+static ei_cascade_t cascade;
+static ei_cascade_level_t cascade_level;
+
+static float accel_magnitude(const float *frame)
+{
+    float sum_sq = 0.0f;
+
+    for (size_t axis = 0; axis < CASCADE_AXES; axis++) {
+        sum_sq += frame[axis] * frame[axis];
+    }
+    return sqrtf(sum_sq);
+}
+
+/*
+ * Default first stage: standard deviation of the acceleration magnitude over
+ * the window, against its noise floor. Two passes, as gravity dominates the mean.
+ */
+static float cascade_motion_stage1(const float *window, size_t len)
+{
+    size_t frames = len / EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME;
+    float mean = 0.0f;
+    float var = 0.0f;
+
+    for (size_t ix = 0; ix < len; ix += EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME) {
+        mean += accel_magnitude(&window[ix]);
+    }
+    mean /= frames;
+    for (size_t ix = 0; ix < len; ix += EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME) {
+        float d = accel_magnitude(&window[ix]) - mean;
+        var += d * d;
+    }
+    return ei_cascade_level_score(&cascade_level, sqrtf(var / frames));
+}
+
+static void cascade_stage2_done(const ei_impulse_result_t *result)
+{
+    float max_val = 0.0f;
+
+    for (uint16_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        if (max_val < result->classification[ix].value) {
+            max_val = result->classification[ix].value;
+        }
+    }
+    ei_cascade_stage2_done(&cascade,
+        (uint32_t)(result->timing.dsp + result->timing.classification + result->timing.anomaly) * 1000,
+        result->label_detected && max_val >= detect_threshold);
+}
+
+int ei_imu_cascade(ei_cascade_t *out)
+{
+    *out = cascade;
+    return 0;
+}
+#endif
+
+/*
+ * Memory plan, see EI_IMU_MEM_PLAN. Every pass of the loop goes through these
+ * stages. The window is written while sampling and read by the DSP; the stepped
+ * inference writes its features in the DSP stage and reads them in the NN stage;
+ * the log chunk is only used to download the log. The window and the features
+ * overlap in the DSP stage, the chunk reuses the window. The region is sized
+ * here from the same lifetimes, and mem_plan_init stops if the layout does not
+ * fit. The SDK heap (features of ei_infer and the tensor arena) is counted but
+ * not placed, to report the peak of the task.
+ */
+#if EI_IMU_MEM_PLAN
+#include "ei_mem_plan.h"
+
+enum { MEM_WINDOW, MEM_DSP, MEM_NN, MEM_OUTPUT, MEM_N_STAGES };
+
+#define MEM_WINDOW_BYTES            EI_MEM_ALIGN_UP(EI_CLASSIFIER_NN_INPUT_FRAME_SIZE * sizeof(window_t))
+#if EI_IMU_WINDOW_STATS && (EI_IMU_STRIDE_FRAMES < WINDOW_FRAMES)
+// the window slides, its older frames are kept for the next pass
+#define MEM_WINDOW_STAGES           EI_MEM_ALL_STAGES
+#else
+#define MEM_WINDOW_STAGES           (EI_MEM_STAGE(MEM_WINDOW) | EI_MEM_STAGE(MEM_DSP))
+#endif
+#if EI_IMU_STEPPED_INFERENCE
+#define MEM_FEATURES_BYTES          EI_MEM_ALIGN_UP(EI_CLASSIFIER_NN_INPUT_FRAME_SIZE * sizeof(float))
+#else
+#define MEM_FEATURES_BYTES          0
+#endif
+#if EI_IMU_RESULT_LOG
+#define MEM_LOG_CHUNK_BYTES         EI_MEM_ALIGN_UP(EI_RESULT_LOG_CHUNK * sizeof(ei_result_record_t))
+#else
+#define MEM_LOG_CHUNK_BYTES         0
+#endif
+
+#ifndef EI_IMU_MEM_REGION_SIZE
+#if EI_IMU_WINDOW_STATS && (EI_IMU_STRIDE_FRAMES < WINDOW_FRAMES)
+#define EI_IMU_MEM_REGION_SIZE      (MEM_WINDOW_BYTES + EI_MEM_MAX(MEM_FEATURES_BYTES, MEM_LOG_CHUNK_BYTES))
+#else
+#define EI_IMU_MEM_REGION_SIZE      EI_MEM_MAX(MEM_WINDOW_BYTES + MEM_FEATURES_BYTES, MEM_LOG_CHUNK_BYTES)
+#endif
+#endif
+
+// SDK heap, only counted: the tensor arena, and the features of ei_infer
+#ifndef EI_IMU_MEM_ARENA_BYTES
+#ifdef EI_CLASSIFIER_TFLITE_ARENA_SIZE
+#define EI_IMU_MEM_ARENA_BYTES      EI_CLASSIFIER_TFLITE_ARENA_SIZE
+#else
+#define EI_IMU_MEM_ARENA_BYTES      0
+#endif
+#endif
+#if EI_IMU_STEPPED_INFERENCE
+#define MEM_SDK_FEATURES_BYTES      0
+#else
+#define MEM_SDK_FEATURES_BYTES      (EI_CLASSIFIER_NN_INPUT_FRAME_SIZE * sizeof(float))
+#endif
+
+static uint64_t mem_region[(EI_IMU_MEM_REGION_SIZE + 7) / 8];
+static float *mem_features;
+static ei_mem_plan_report_t mem_report;
+
+static ei_mem_buffer_t mem_buffers[] = {
+    { "window", MEM_WINDOW_BYTES, MEM_WINDOW_STAGES, false, (void **)&data, 0 },
+    { "features", MEM_FEATURES_BYTES, EI_MEM_STAGE(MEM_DSP) | EI_MEM_STAGE(MEM_NN), false, (void **)&mem_features, 0 },
+#if EI_IMU_RESULT_LOG
+    { "log chunk", MEM_LOG_CHUNK_BYTES, EI_MEM_STAGE(MEM_OUTPUT), false, (void **)&log_chunk, 0 },
+#endif
+    { "sdk features", MEM_SDK_FEATURES_BYTES, EI_MEM_STAGE(MEM_DSP) | EI_MEM_STAGE(MEM_NN), true, NULL, 0 },
+    { "sdk arena", EI_IMU_MEM_ARENA_BYTES, EI_MEM_STAGE(MEM_NN), true, NULL, 0 },
+};
+
+static void mem_plan_init(void)
+{
+    size_t n = sizeof(mem_buffers) / sizeof(mem_buffers[0]);
+    size_t region_size;
+
+    if (ei_mem_plan_place(mem_buffers, n, mem_region, sizeof(mem_region)) != 0) {
+        Serial_Printf("ERR: memory plan does not fit in EI_IMU_MEM_REGION_SIZE\r\n");
+        while(1);
+    }
+    ei_mem_plan_layout(mem_buffers, n, &region_size);
+    ei_mem_plan_get_report(mem_buffers, n, MEM_N_STAGES, region_size, &mem_report);
+#if EI_IMU_STEPPED_INFERENCE
+    ei_infer_stepped_set_features(mem_features);
+#endif
+}
+
+static void print_mem_plan(void)
+{
+    static const char *stages[] = { "window", "dsp", "nn", "output" };
+
+    Serial_Printf("Memory: %u byte region (%u reserved) for %u bytes of buffers, peak %u bytes in %s "
+                  "with %u bytes of SDK heap\r\n",
+        (unsigned)mem_report.region_bytes, (unsigned)sizeof(mem_region), (unsigned)mem_report.unshared_bytes,
+        (unsigned)mem_report.peak_bytes, stages[mem_report.peak_stage], (unsigned)mem_report.external_bytes);
+}
+#endif
+
+#if EI_IMU_COMMANDS
+#include "ei_cmd.h"
+
+static ei_cmd_parser_t cmd_parser;
+
+static void cmd_print(const char *str)
+{
+    Serial_Printf("%s", str);
+}
+
+static int cmd_interval(int argc, char **argv)
+{
+    int32_t ms;
+
+    if (argc == 0) {
+        Serial_Printf("INTERVAL=%u\r\n", (unsigned)sample_interval_ms);
+        return 0;
+    }
+    if (argc != 1 || ei_cmd_parse_int(argv[0], 1, 10000, &ms) != 0) {
+        return -1;
+    }
+    sample_interval_ms = (uint32_t)ms;
+#if EI_IMU_WINDOW_STATS
+    // the next window is sampled whole, at the new interval
+    ei_wstats_reset(&wstats);
+#endif
+#if EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME >= 6
+    imu_fusion_init(&fusion, data, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE,
+                    EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME, sample_interval_ms * 1000);
+#endif
+    return 0;
+}
+
+static int cmd_threshold(int argc, char **argv)
+{
+    if (argc == 0) {
+        Serial_Printf("THRESHOLD=%d%%\r\n", (int)(detect_threshold * 100.0f));
+        return 0;
+    }
+    if (argc != 1 || ei_cmd_parse_float(argv[0], 0.0f, 1.0f, &detect_threshold) != 0) {
+        return -1;
+    }
+    ei_set_output(output_format, detect_threshold);
+    return 0;
+}
+
+static int cmd_format(int argc, char **argv)
+{
+    static const char *names[] = { "TEXT", "CSV", "DETECT", "NONE" };
+
+    if (argc == 0) {
+        Serial_Printf("FORMAT=%s\r\n", names[output_format]);
+        return 0;
+    }
+    for (size_t ix = 0; argc == 1 && ix < sizeof(names) / sizeof(names[0]); ix++) {
+        if (ei_cmd_equals(argv[0], names[ix])) {
+            output_format = (ei_output_format_t)ix;
+            ei_set_output(output_format, detect_threshold);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int cmd_debug(int argc, char **argv)
+{
+    int32_t on;
+
+    if (argc == 0) {
+        Serial_Printf("DEBUG=%d\r\n", sdk_debug ? 1 : 0);
+        return 0;
+    }
+    if (argc != 1 || ei_cmd_parse_int(argv[0], 0, 1, &on) != 0) {
+        return -1;
+    }
+    sdk_debug = (on != 0);
+    return 0;
+}
+
+static int cmd_stats(int argc, char **argv)
+{
+    if (argc != 0) {
+        return -1;
+    }
+#if EI_IMU_STEPPED_INFERENCE
+    ei_infer_stepped_print_stats();
+#endif
+#if EI_IMU_RESULT_LOG
+    Serial_Printf("Result log: records %u..%u, %u flushes, %u pages erased, %u errors\r\n",
+        (unsigned)result_log.oldest_seq, (unsigned)result_log.next_seq, (unsigned)result_log.flushes,
+        (unsigned)result_log.pages_erased, (unsigned)result_log.storage_errors);
+#endif
+#if EI_IMU_PREROLL
+    Serial_Printf("Pre-roll: %u samples not recorded\r\n", (unsigned)preroll.not_recorded);
+#endif
+#if EI_IMU_WINDOW_STATS
+    ei_axis_stats_t axis_stats;
+    for (uint8_t axis = 0; axis < WINDOW_AXES; axis++) {
+        if (ei_wstats_get(&wstats, axis, &axis_stats) == 0) {
+            // in 1/100 m/s2
+            Serial_Printf("Axis %u: mean %d, rms %d, std %d, min %d, max %d\r\n", (unsigned)axis,
+                (int)(axis_stats.mean * 100.0f), (int)(axis_stats.rms * 100.0f), (int)(axis_stats.std * 100.0f),
+                (int)(axis_stats.min * 100.0f), (int)(axis_stats.max * 100.0f));
+        }
+    }
+    Serial_Printf("Prefilter: %u windows not classified\r\n", (unsigned)windows_prefiltered);
+#endif
+#if EI_IMU_CASCADE
+    uint32_t inputs = cascade.inputs ? cascade.inputs : 1;
+    uint32_t runs = cascade.stage2.runs ? cascade.stage2.runs : 1;
+    Serial_Printf("Cascade: %u of %u windows passed (%u%%), %u classified, %u detections; "
+                  "stage 1 avg %u us (max %u), stage 2 avg %u ms (max %u)\r\n",
+        (unsigned)cascade.passed, (unsigned)cascade.inputs, (unsigned)(cascade.passed * 100 / inputs),
+        (unsigned)cascade.stage2.runs, (unsigned)cascade.detections,
+        (unsigned)(cascade.stage1.total_us / inputs), (unsigned)cascade.stage1.max_us,
+        (unsigned)(cascade.stage2.total_us / runs / 1000), (unsigned)(cascade.stage2.max_us / 1000));
+#endif
+#if EI_IMU_STARTUP_TRACE
+    print_startup();
+#endif
+#if EI_IMU_MEM_PLAN
+    print_mem_plan();
+#endif
+#if EI_IMU_SAMPLE_RATE
+    ei_sample_rate_stats_t rate;
+    if (imu_sample_rate(&rate) == 0) {
+        // in 1/100 Hz and us
+        Serial_Printf("Sample rate: %u.%02u Hz, interval %u us (drift %d ppm), jitter %u us, min %u, max %u "
+                  "over %u intervals, %u gaps\r\n",
+            (unsigned)(rate.rate_hz * 100.0f) / 100, (unsigned)(rate.rate_hz * 100.0f) % 100,
+            (unsigned)rate.interval_us, (int)rate.drift_ppm, (unsigned)rate.jitter_us,
+            (unsigned)rate.min_us, (unsigned)rate.max_us, (unsigned)rate.intervals, (unsigned)rate.gaps);
+    }
+#endif
+#if EI_IMU_LATENCY
+    Serial_Printf("Latency (last sample to result, ms): avg %u, p50 %u, p90 %u, p99 %u, max %u over %u results\r\n",
+        (unsigned)(ei_latency_avg_us(&latency) / 1000), (unsigned)(ei_latency_percentile_us(&latency, 50) / 1000),
+        (unsigned)(ei_latency_percentile_us(&latency, 90) / 1000),
+        (unsigned)(ei_latency_percentile_us(&latency, 99) / 1000),
+        (unsigned)(latency.max_us / 1000), (unsigned)latency.count);
+#endif
+#if EI_IMU_ENERGY
+    ei_energy_report_t energy_report;
+    ei_energy_get_report(&energy, &energy_report);
+    Serial_Printf("Energy: duty %u.%u%%, %u uJ per inference, %u uW average over %u inferences\r\n",
+        (unsigned)(energy_report.duty_permille / 10), (unsigned)(energy_report.duty_permille % 10),
+        (unsigned)energy_report.uj_per_inference, (unsigned)energy_report.avg_uw,
+        (unsigned)energy_report.inferences);
+#endif
+    Serial_Printf("Commands: %u lines, %u errors\r\n", (unsigned)cmd_parser.lines, (unsigned)cmd_parser.errors);
+    return 0;
+}
+
+#if EI_IMU_WINDOW_STATS
+static int cmd_prefilter(int argc, char **argv)
+{
+    if (argc == 0) {
+        Serial_Printf("PREFILTER=%d (1/100 m/s2)\r\n", (int)(prefilter_min_std * 100.0f));
+        return 0;
+    }
+    return (argc == 1) ? ei_cmd_parse_float(argv[0], 0.0f, 100.0f, &prefilter_min_std) : -1;
+}
+#endif
+
+#if EI_IMU_CASCADE
+static int cmd_cascade(int argc, char **argv)
+{
+    int32_t hold = cascade.hold;
+
+    if (argc == 0) {
+        Serial_Printf("CASCADE=%d%%,%u\r\n", (int)(cascade.threshold * 100.0f), (unsigned)cascade.hold);
+        return 0;
+    }
+    if (argc > 2 || (argc == 2 && ei_cmd_parse_int(argv[1], 0, UINT16_MAX, &hold) != 0)) {
+        return -1;
+    }
+    if (ei_cmd_parse_float(argv[0], 0.0f, 1.0f, &cascade.threshold) != 0) {
+        return -1;
+    }
+    cascade.hold = (uint16_t)hold;
+    return 0;
+}
+#endif
+
+#if EI_IMU_RESULT_LOG
+static int cmd_log(int argc, char **argv)
+{
+    int32_t from = 0;
+
+    if (argc > 1 || (argc == 1 && ei_cmd_parse_int(argv[0], 0, INT32_MAX, &from) != 0)) {
+        return -1;
+    }
+    ei_log_request_download((uint32_t)from);
+    return 0;
+}
+#endif
+
+static const ei_cmd_t commands[] = {
+    { "INTERVAL", "sample interval in ms", cmd_interval },
+    { "THRESHOLD", "score of a detection (0..1)", cmd_threshold },
+    { "FORMAT", "output format: TEXT, CSV, DETECT or NONE", cmd_format },
+    { "DEBUG", "Edge Impulse SDK debug output (0 or 1)", cmd_debug },
+    { "STATS", "print statistics", cmd_stats },
+#if EI_IMU_WINDOW_STATS
+    { "PREFILTER", "skip windows with all axes below this standard deviation in m/s2, 0 => off", cmd_prefilter },
+#endif
+#if EI_IMU_CASCADE
+    { "CASCADE", "first stage score that wakes the impulse (0..1, 0 => always)[,hold windows]", cmd_cascade },
+#endif
+#if EI_IMU_RESULT_LOG
+    { "LOG", "download the result log, from a sequence number on", cmd_log },
+#endif
+};
+
+/*
+ * Execute the commands received since the last call, never blocks
+ */
+static void commands_poll(void)
+{
+    char buf[32];
+    int n;
+
+    do {
+        n = Serial_In(buf, sizeof(buf));
+        ei_cmd_feed(&cmd_parser, buf, (size_t)n);
+    } while (n == sizeof(buf));
+}
+#endif
 
 /*
  *  ======== thread example: inferencing loop ========
  */
 void inferThread(UArg a0, UArg a1)
 {
+#if EI_IMU_STARTUP_TRACE
+    ei_startup_begin(startup_now_us);
+#endif
     imu_init();
     ei_init();
 
+#if EI_IMU_MEM_PLAN
+    mem_plan_init();
+    print_mem_plan();
+#endif
+#if EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME >= 6
+    imu_fusion_init(&fusion, data, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE,
+                    EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME, sample_interval_ms * 1000);
+#endif
+#if EI_IMU_INT8_INPUT
+    ei_quant_init(&quant, EI_IMU_INT8_SCALE, EI_IMU_INT8_ZERO_POINT);
+#endif
+#if EI_IMU_PREROLL
+    ei_preroll_init(&preroll, preroll_buf, PREROLL_CAPACITY);
+#endif
+#if EI_IMU_WINDOW_STATS
+    ei_wstats_init(&wstats, WINDOW_AXES, WINDOW_FRAMES, 1000.0f, wstats_mem,
+                   sizeof(wstats_mem) / sizeof(wstats_mem[0]));
+#endif
+#if EI_IMU_COMMANDS
+    ei_cmd_init(&cmd_parser, commands, sizeof(commands) / sizeof(commands[0]), cmd_print);
+#endif
+    ei_set_output(output_format, detect_threshold);
+#if EI_IMU_ENERGY
+    ei_energy_init(&energy, NULL, energy_now_us);
+#endif
+#if EI_IMU_LATENCY
+    ei_latency_init(&latency, EI_IMU_LATENCY_UNIT_US);
+#endif
+#if EI_IMU_CASCADE
+    ei_cascade_init(&cascade, EI_IMU_CASCADE_THRESHOLD, EI_IMU_CASCADE_HOLD);
+    // follows stronger background vibration within ~16 windows, no lower than the sensor noise
+    ei_cascade_level_init(&cascade_level, 1.0f / 16.0f, 0.01f);
+#endif
+#if EI_IMU_STEPPED_INFERENCE
+    if (ei_infer_stepped_init(EI_IMU_STEP_BUDGET_US, step_yield) != 0) {
+        while(1);
+    }
+#endif
+
     while(1) {
-        imu_fill_window(data, EI_CLASSIFIER_RAW_SAMPLE_COUNT, EI_CLASSIFIER_INTERVAL_MS);
-        ei_impulse_result_t result = ei_infer(data, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE, false);
+        ei_impulse_result_t result = { 0 };
+#if EI_IMU_ENERGY
+        ei_energy_enter(&energy, EI_ENERGY_ACQUIRE);
+#endif
+#if EI_IMU_INT8_INPUT
+        imu_check(imu_fill_window_i8(data, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE, sample_interval_ms, &quant));
+#if EI_IMU_ENERGY
+        ei_energy_enter(&energy, EI_ENERGY_LOG);
+#endif
+        result = ei_infer_i8(data, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE, &quant, sdk_debug);
+#else
+        bool classify = true;
+#if EI_IMU_WINDOW_STATS
+        window_update();
+        if (window_is_quiet()) {
+            classify = false;
+            windows_prefiltered++;
+        }
+#elif EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME >= 6
+        imu_check(imu_fill_window_fused(&fusion));
+#else
+        imu_check(fill_window(data, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE));
+#endif
+#if EI_IMU_ENERGY
+        ei_energy_enter(&energy, EI_ENERGY_APP);
+#endif
+#if EI_IMU_PREROLL && !EI_IMU_WINDOW_STATS
+        preroll_record_window(data, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE);
+#endif
+#if EI_IMU_CASCADE
+        if (classify) {
+            // stage 1 takes well under a millisecond, time it in ticks
+            uint32_t stage1_start = Clock_getTicks();
+            float stage1_score = EI_IMU_CASCADE_STAGE1(data, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE);
+            classify = ei_cascade_gate(&cascade, stage1_score, (Clock_getTicks() - stage1_start) * Clock_tickPeriod);
+        }
+#endif
+        if (classify) {
+#if EI_IMU_ENERGY
+            ei_energy_enter(&energy, EI_ENERGY_LOG);
+#endif
+#if EI_IMU_STEPPED_INFERENCE
+            result = ei_infer_stepped(data, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE, sdk_debug);
+            if (result.label_detected) {
+                ei_infer_stepped_print_stats();
+            }
+#else
+            result = ei_infer(data, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE, sdk_debug);
+#endif
+#if EI_IMU_CASCADE
+            cascade_stage2_done(&result);
+#endif
+        } else {
+            // nothing to classify, initialize the SDK now rather than delay the first window that passes
+            ei_infer_prepare();
+        }
+#endif
+#if EI_IMU_ENERGY
+        energy_account_inference(&result);
+        ei_energy_enter(&energy, EI_ENERGY_LOG);
+#endif
         if (result.label_detected) {
+#if EI_IMU_LATENCY
+            ei_latency_add(&latency, ei_latency_since(imu_last_sample_us(),
+                (uint32_t)((uint64_t)Clock_getTicks() * Clock_tickPeriod)));
+#endif
             /*
              * add custom post-processing logic here.
              * Handle the inference result and drive application
@@ -77,7 +1130,41 @@ void inferThread(UArg a0, UArg a1)
                     result_idx = ix;
                 }
             }
+
+#if EI_IMU_STARTUP_TRACE
+            if (!ei_startup_complete()) {
+                ei_startup_mark(EI_STARTUP_FIRST_RESULT);
+                print_startup();
+            }
+#endif
+#if EI_IMU_RESULT_LOG
+            if (log_open()) {
+                log_result(&result, result_idx, max_val);
+            }
+#endif
+#if EI_IMU_PREROLL
+            if (max_val >= detect_threshold) {
+                // ignored while the previous snapshot is still being streamed
+                ei_preroll_trigger(&preroll, PREROLL_PRE_SAMPLES, PREROLL_POST_SAMPLES);
+            }
+#endif
+        }
+
+#if EI_IMU_RESULT_LOG
+        if ((log_download_requested || log_downloading) && log_open()) {
+            log_download();
         }
+#endif
+#if EI_IMU_PREROLL
+        // one chunk per window, as the log download, so sampling is not held up
+        ei_preroll_stream_chunk(&preroll, EI_PREROLL_CHUNK_SAMPLES, preroll_write_uart);
+#endif
+#if EI_IMU_ENERGY
+        ei_energy_enter(&energy, EI_ENERGY_APP);
+#endif
+#if EI_IMU_COMMANDS
+        commands_poll();
+#endif
     }
 }
 
@@ -91,7 +1178,7 @@ void ei_create_task(void) {
     Task_Params_init(&taskParams);
     taskParams.stack = eiTaskStack;
     taskParams.stackSize = EI_TASK_STACK_SIZE;
-    taskParams.priority = 1;
+    taskParams.priority = EI_TASK_PRIORITY;
 
     Task_construct(&eiTask, inferThread, &taskParams, NULL);
 }
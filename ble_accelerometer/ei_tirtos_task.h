@@ -34,7 +34,40 @@
 #ifndef APPLICATION_EI_TIRTOS_TASK_H_
 #define APPLICATION_EI_TIRTOS_TASK_H_
 
+#include <stdint.h>
+
 void * inferThread(void *arg0);
 void ei_createTask(void);
 
+/* Stream the logged results from from_seq on over UART2, see EI_IMU_RESULT_LOG */
+void ei_log_request_download(uint32_t from_seq);
+
+#if EI_IMU_WINDOW_STATS
+#include "ei_window_stats.h"
+
+/* Running statistics of one axis of the current window, see EI_IMU_WINDOW_STATS */
+int ei_imu_axis_stats(uint8_t axis, ei_axis_stats_t *out);
+#endif
+
+#if EI_IMU_ENERGY
+#include "ei_energy.h"
+
+/* Duty cycle and estimated energy since boot, see EI_IMU_ENERGY */
+int ei_imu_energy(ei_energy_report_t *out);
+#endif
+
+#if EI_IMU_LATENCY
+#include "ei_latency.h"
+
+/* Distribution of the time from the last sample of a window to its result, see EI_IMU_LATENCY */
+int ei_imu_latency(ei_latency_t *out);
+#endif
+
+#if EI_IMU_CASCADE
+#include "ei_cascade.h"
+
+/* Pass rates and time per stage of the cascade, see EI_IMU_CASCADE */
+int ei_imu_cascade(ei_cascade_t *out);
+#endif
+
 #endif /* APPLICATION_EI_TIRTOS_TASK_H_ */
@@ -0,0 +1,196 @@
+/* Incremental sliding window statistics. See ei_window_stats.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <math.h>
+#include <string.h>
+#include "ei_window_stats.h"
+
+// ei_wstats_get forms n * sum_sq, up to (n * STORED_MAX)^2: with n limited to
+// EI_WSTATS_MAX_FRAMES (2^11) that is at most 2^62, inside int64. At scale 1000
+// the stored range is +-1048 units, e.g. +-16 g of acceleration
+#define STORED_MAX      (1 << 20)
+
+/* Private functions ------------------------------------------------------- */
+static int32_t to_stored(const ei_window_stats_t *ws, float v)
+{
+    float s = v * ws->scale;
+
+    if (s >= (float)STORED_MAX) {
+        return STORED_MAX;
+    }
+    if (s <= -(float)STORED_MAX) {
+        return -STORED_MAX;
+    }
+    return (int32_t)lrintf(s);
+}
+
+static inline int32_t value_at(const ei_window_stats_t *ws, uint32_t pos, uint8_t axis)
+{
+    return ws->values[pos * ws->n_axes + axis];
+}
+
+/**
+ * @brief Monotonic queue update: drop the entries the new value makes
+ * irrelevant, then append it. is_max selects the maximum queue.
+ */
+static void queue_push(ei_window_stats_t *ws, uint8_t axis, bool is_max, int32_t v)
+{
+    uint32_t *queue = (is_max ? ws->max_queue : ws->min_queue) + axis * ws->n_frames;
+    uint32_t head = is_max ? ws->max_head[axis] : ws->min_head[axis];
+    uint32_t *len = is_max ? &ws->max_len[axis] : &ws->min_len[axis];
+
+    while (*len > 0) {
+        int32_t back = value_at(ws, queue[(head + *len - 1) % ws->n_frames], axis);
+        if (is_max ? (back > v) : (back < v)) {
+            break;
+        }
+        (*len)--;
+    }
+    queue[(head + *len) % ws->n_frames] = ws->pos;
+    (*len)++;
+}
+
+/**
+ * @brief Remove the frame at ws->pos, the oldest of a full window
+ */
+static void evict_oldest(ei_window_stats_t *ws)
+{
+    for (uint8_t axis = 0; axis < ws->n_axes; axis++) {
+        int64_t v = value_at(ws, ws->pos, axis);
+        ws->sum[axis] -= v;
+        ws->sum_sq[axis] -= v * v;
+
+        if (ws->min_len[axis] > 0 && ws->min_queue[axis * ws->n_frames + ws->min_head[axis]] == ws->pos) {
+            ws->min_head[axis] = (ws->min_head[axis] + 1) % ws->n_frames;
+            ws->min_len[axis]--;
+        }
+        if (ws->max_len[axis] > 0 && ws->max_queue[axis * ws->n_frames + ws->max_head[axis]] == ws->pos) {
+            ws->max_head[axis] = (ws->max_head[axis] + 1) % ws->n_frames;
+            ws->max_len[axis]--;
+        }
+    }
+    ws->count--;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Setup the statistics of a window of n_frames frames, at most
+ * EI_WSTATS_MAX_FRAMES
+ *
+ * @param scale resolution of the stored samples, e.g. 1000 for 0.001 m/s2
+ *
+ * @param mem caller owned memory of EI_WSTATS_MEM_WORDS(n_frames, n_axes) words
+ *
+ * @return int, 0 => OK
+ */
+int ei_wstats_init(ei_window_stats_t *ws, uint8_t n_axes, uint32_t n_frames, float scale,
+                   int32_t *mem, size_t mem_words)
+{
+    if (n_axes == 0 || n_axes > EI_WSTATS_MAX_AXES || n_frames == 0 || scale <= 0.0f
+            || n_frames > EI_WSTATS_MAX_FRAMES || mem == NULL || mem_words < EI_WSTATS_MEM_WORDS(n_frames, n_axes)) {
+        return -1;
+    }
+
+    memset(ws, 0, sizeof(ei_window_stats_t));
+    ws->n_axes = n_axes;
+    ws->n_frames = n_frames;
+    ws->scale = scale;
+    ws->values = mem;
+    ws->min_queue = (uint32_t *)&mem[n_frames * n_axes];
+    ws->max_queue = (uint32_t *)&mem[2 * n_frames * n_axes];
+
+    return 0;
+}
+
+/**
+ * @brief Empty the window, e.g. after a gap in the data
+ */
+void ei_wstats_reset(ei_window_stats_t *ws)
+{
+    ws->pos = 0;
+    ws->count = 0;
+    memset(ws->min_head, 0, sizeof(ws->min_head));
+    memset(ws->min_len, 0, sizeof(ws->min_len));
+    memset(ws->max_head, 0, sizeof(ws->max_head));
+    memset(ws->max_len, 0, sizeof(ws->max_len));
+    memset(ws->sum, 0, sizeof(ws->sum));
+    memset(ws->sum_sq, 0, sizeof(ws->sum_sq));
+}
+
+/**
+ * @brief Add one frame (n_axes values) to the window. Once the window is full
+ * the oldest frame leaves it.
+ */
+void ei_wstats_push(ei_window_stats_t *ws, const float *frame)
+{
+    if (ws->count == ws->n_frames) {
+        evict_oldest(ws);
+    }
+
+    for (uint8_t axis = 0; axis < ws->n_axes; axis++) {
+        int32_t v = to_stored(ws, frame[axis]);
+        ws->values[ws->pos * ws->n_axes + axis] = v;
+        ws->sum[axis] += v;
+        ws->sum_sq[axis] += (int64_t)v * v;
+        queue_push(ws, axis, false, v);
+        queue_push(ws, axis, true, v);
+    }
+
+    ws->pos = (ws->pos + 1) % ws->n_frames;
+    ws->count++;
+    ws->frames_pushed++;
+}
+
+/**
+ * @brief True once n_frames frames have been pushed since the last reset
+ */
+bool ei_wstats_full(const ei_window_stats_t *ws)
+{
+    return ws->count == ws->n_frames;
+}
+
+/**
+ * @brief Statistics of one axis over the frames currently in the window
+ *
+ * @return int, 0 => OK, -1 if the window is empty
+ */
+int ei_wstats_get(const ei_window_stats_t *ws, uint8_t axis, ei_axis_stats_t *out)
+{
+    if (axis >= ws->n_axes || ws->count == 0) {
+        return -1;
+    }
+
+    float n = (float)ws->count;
+    // n^2 * variance, exact in integers
+    int64_t var_n2 = (int64_t)ws->count * ws->sum_sq[axis] - ws->sum[axis] * ws->sum[axis];
+
+    out->mean = (float)ws->sum[axis] / (n * ws->scale);
+    out->rms = sqrtf((float)ws->sum_sq[axis] / n) / ws->scale;
+    out->std = sqrtf((float)var_n2) / (n * ws->scale);
+    out->min = (float)value_at(ws, ws->min_queue[axis * ws->n_frames + ws->min_head[axis]], axis) / ws->scale;
+    out->max = (float)value_at(ws, ws->max_queue[axis * ws->n_frames + ws->max_head[axis]], axis) / ws->scale;
+
+    return 0;
+}
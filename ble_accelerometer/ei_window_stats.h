@@ -0,0 +1,99 @@
+/* Incremental statistics over a sliding window of multi-axis samples. Every
+ * frame that enters the window is added to running per-axis sums, the frame
+ * leaving it is subtracted, and monotonic queues keep the window minimum and
+ * maximum. Updating the statistics costs O(1) per frame (amortized for
+ * min / max), so a window sliding by `stride` frames is updated in O(stride)
+ * instead of recomputing over the whole window.
+ *
+ * Samples are stored as integers in 1/scale units, so adding and removing
+ * them is exact and the sums never drift.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_WINDOW_STATS_H
+#define EI_WINDOW_STATS_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defines ----------------------------------------------------------------- */
+#ifndef EI_WSTATS_MAX_AXES
+#define EI_WSTATS_MAX_AXES          6
+#endif
+
+/** Longest window: bounds the int64 variance sums, see STORED_MAX */
+#define EI_WSTATS_MAX_FRAMES        2048
+
+/** Words of memory needed for a window of n_frames frames of n_axes values */
+#define EI_WSTATS_MEM_WORDS(n_frames, n_axes)   (3 * (n_frames) * (n_axes))
+
+/* Types ------------------------------------------------------------------- */
+
+/** Statistics of one axis over the current window, in the unit of the samples */
+typedef struct {
+    float mean;
+    float rms;
+    float std;
+    float min;
+    float max;
+} ei_axis_stats_t;
+
+typedef struct {
+    uint8_t n_axes;
+    uint32_t n_frames;          // window length
+    float scale;                // samples are stored as round(value * scale)
+
+    int32_t *values;            // n_frames x n_axes ring of stored samples
+    uint32_t *min_queue;        // per axis ring of positions, values increasing
+    uint32_t *max_queue;        // per axis ring of positions, values decreasing
+
+    uint32_t pos;               // ring position of the next frame
+    uint32_t count;             // frames in the window
+    uint32_t min_head[EI_WSTATS_MAX_AXES];
+    uint32_t min_len[EI_WSTATS_MAX_AXES];
+    uint32_t max_head[EI_WSTATS_MAX_AXES];
+    uint32_t max_len[EI_WSTATS_MAX_AXES];
+    int64_t sum[EI_WSTATS_MAX_AXES];
+    int64_t sum_sq[EI_WSTATS_MAX_AXES];
+
+    uint32_t frames_pushed;
+} ei_window_stats_t;
+
+/* Function prototypes ----------------------------------------------------- */
+int ei_wstats_init(ei_window_stats_t *ws, uint8_t n_axes, uint32_t n_frames, float scale,
+                   int32_t *mem, size_t mem_words);
+void ei_wstats_reset(ei_window_stats_t *ws);
+void ei_wstats_push(ei_window_stats_t *ws, const float *frame);
+bool ei_wstats_full(const ei_window_stats_t *ws);
+int ei_wstats_get(const ei_window_stats_t *ws, uint8_t axis, ei_axis_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
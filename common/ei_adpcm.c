@@ -0,0 +1,300 @@
+/* Streaming IMA-ADPCM codec. See ei_adpcm.h for an overview and the packet
+ * format.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+
+#include "ei_adpcm.h"
+
+/* Private variables ------------------------------------------------------- */
+static const int16_t step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t index_table[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief Move the state by a code, the same for encoder and decoder
+ */
+static int16_t apply_code(ei_adpcm_state_t *state, uint8_t code, int32_t delta)
+{
+    int32_t predictor = state->predictor + ((code & 8) ? -delta : delta);
+    int32_t index = state->step_index + index_table[code & 7];
+
+    predictor = (predictor > 32767) ? 32767 : ((predictor < -32768) ? -32768 : predictor);
+    state->predictor = (int16_t)predictor;
+    state->step_index = (uint8_t)((index < 0) ? 0 : ((index > 88) ? 88 : index));
+
+    return state->predictor;
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief Fletcher-16 of the header without its check field, and the codes.
+ * Sums are reduced once at the end, which holds for EI_ADPCM_MAX_PACKET_SAMPLES.
+ */
+static uint16_t packet_check(const uint8_t *packet, size_t size)
+{
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+
+    for (size_t ix = 0; ix < size; ix++) {
+        if (ix == EI_ADPCM_HEADER_SIZE - 2) {
+            ix++;
+            continue;
+        }
+        sum1 += packet[ix];
+        sum2 += sum1;
+    }
+
+    return (uint16_t)(((sum2 % 255) << 8) | (sum1 % 255));
+}
+
+static void start_packet(ei_adpcm_encoder_t *e)
+{
+    put16(&e->packet[0], EI_ADPCM_MAGIC);
+    put16(&e->packet[2], e->seq);
+    put16(&e->packet[6], (uint16_t)e->state.predictor);
+    e->packet[8] = e->state.step_index;
+    e->packet[9] = e->stream_id;
+}
+
+static void emit_packet(ei_adpcm_encoder_t *e)
+{
+    size_t size = EI_ADPCM_PACKET_SIZE(e->fill);
+
+    put16(&e->packet[4], e->fill);
+    put16(&e->packet[10], packet_check(e->packet, size));
+    e->write_fn(e->packet, size);
+
+    e->packets++;
+    e->seq++;
+    e->fill = 0;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Encode one sample
+ *
+ * @return uint8_t 4 bit code
+ */
+uint8_t ei_adpcm_encode_sample(ei_adpcm_state_t *state, int16_t sample)
+{
+    int32_t step = step_table[state->step_index];
+    int32_t diff = sample - state->predictor;
+    int32_t delta = step >> 3;
+    uint8_t code = 0;
+
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    // same delta as the decoder computes from the code, so both states agree
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 2;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 1;
+        delta += step;
+    }
+    apply_code(state, code, delta);
+
+    return code;
+}
+
+/**
+ * @brief Decode one 4 bit code
+ */
+int16_t ei_adpcm_decode_sample(ei_adpcm_state_t *state, uint8_t code)
+{
+    int32_t step = step_table[state->step_index];
+    int32_t delta = step >> 3;
+
+    if (code & 4) {
+        delta += step;
+    }
+    if (code & 2) {
+        delta += step >> 1;
+    }
+    if (code & 1) {
+        delta += step >> 2;
+    }
+
+    return apply_code(state, code, delta);
+}
+
+/**
+ * @brief Initialize an encoder at silence
+ *
+ * @param packet buffer for the packet being filled, at least
+ * EI_ADPCM_PACKET_SIZE(packet_samples) bytes
+ *
+ * @param packet_samples samples per packet, up to EI_ADPCM_MAX_PACKET_SAMPLES.
+ * Shorter packets lose less on a bad link, longer ones spend less on headers.
+ *
+ * @param stream_id written to every packet, e.g. incremented on every restart
+ * so the receiver can tell streams apart
+ *
+ * @param write_fn called with every complete packet, from ei_adpcm_encode
+ *
+ * @return int, 0 => OK
+ */
+int ei_adpcm_encoder_init(ei_adpcm_encoder_t *e, uint8_t *packet, size_t packet_size,
+                          uint16_t packet_samples, uint8_t stream_id,
+                          void (*write_fn)(const void *data, size_t len))
+{
+    if (packet == NULL || write_fn == NULL || packet_samples == 0
+        || packet_samples > EI_ADPCM_MAX_PACKET_SAMPLES || packet_size < EI_ADPCM_PACKET_SIZE(packet_samples)) {
+        return -1;
+    }
+
+    memset(e, 0, sizeof(ei_adpcm_encoder_t));
+    e->packet = packet;
+    e->packet_samples = packet_samples;
+    e->stream_id = stream_id;
+    e->write_fn = write_fn;
+
+    return 0;
+}
+
+/**
+ * @brief Encode samples, writing every packet that fills up. The work per
+ * sample is constant, plus the checksum and write_fn once per packet.
+ */
+void ei_adpcm_encode(ei_adpcm_encoder_t *e, const int16_t *samples, size_t n)
+{
+    for (size_t ix = 0; ix < n; ix++) {
+        if (e->fill == 0) {
+            start_packet(e);
+        }
+
+        uint8_t code = ei_adpcm_encode_sample(&e->state, samples[ix]);
+        uint8_t *byte = &e->packet[EI_ADPCM_HEADER_SIZE + e->fill / 2];
+        if (e->fill & 1) {
+            *byte |= (uint8_t)(code << 4);
+        } else {
+            *byte = code;
+        }
+
+        if (++e->fill == e->packet_samples) {
+            emit_packet(e);
+        }
+    }
+    e->samples += n;
+}
+
+/**
+ * @brief Write the packet being filled, if any, e.g. before the stream stops
+ */
+void ei_adpcm_flush(ei_adpcm_encoder_t *e)
+{
+    if (e->fill > 0) {
+        emit_packet(e);
+    }
+}
+
+/**
+ * @brief Decode the packet at the start of buf
+ *
+ * @param len bytes available in buf
+ *
+ * @param info header fields of the packet, may be NULL
+ *
+ * @param out decoded samples, room for max_samples
+ *
+ * @return int size of the packet in bytes, 0 if buf holds the start of a
+ * packet but not all of it yet, -1 if buf does not start with a valid packet
+ * (skip a byte and try again to resynchronize) or out is too small
+ */
+int ei_adpcm_decode_packet(const uint8_t *buf, size_t len, ei_adpcm_packet_info_t *info,
+                           int16_t *out, size_t max_samples)
+{
+    ei_adpcm_state_t state;
+    uint16_t n_samples;
+    size_t size;
+
+    if (len < 2) {
+        return (len == 0 || buf[0] == (EI_ADPCM_MAGIC & 0xff)) ? 0 : -1;
+    }
+    if (get16(&buf[0]) != EI_ADPCM_MAGIC) {
+        return -1;
+    }
+    if (len < EI_ADPCM_HEADER_SIZE) {
+        return 0;
+    }
+    n_samples = get16(&buf[4]);
+    state.predictor = (int16_t)get16(&buf[6]);
+    state.step_index = buf[8];
+    if (n_samples == 0 || n_samples > EI_ADPCM_MAX_PACKET_SAMPLES || state.step_index > 88
+        || n_samples > max_samples) {
+        return -1;
+    }
+    size = EI_ADPCM_PACKET_SIZE(n_samples);
+    if (len < size) {
+        return 0;
+    }
+    if (packet_check(buf, size) != get16(&buf[10])) {
+        return -1;
+    }
+
+    if (info != NULL) {
+        info->seq = get16(&buf[2]);
+        info->n_samples = n_samples;
+        info->stream_id = buf[9];
+        info->state = state;
+    }
+    for (uint16_t ix = 0; ix < n_samples; ix++) {
+        uint8_t byte = buf[EI_ADPCM_HEADER_SIZE + ix / 2];
+        out[ix] = ei_adpcm_decode_sample(&state, (ix & 1) ? (byte >> 4) : (byte & 0x0f));
+    }
+
+    return (int)size;
+}
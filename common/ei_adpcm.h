@@ -0,0 +1,99 @@
+/* Streaming IMA-ADPCM codec. 16 bit samples are encoded to 4 bits each as they
+ * arrive, in constant time per sample, and cut into packets that each carry the
+ * codec state at their first sample: a decoder can start at any packet, and a
+ * lost packet only costs its own samples. A packet is
+ *
+ *   ei_adpcm header, EI_ADPCM_HEADER_SIZE bytes, little-endian:
+ *     uint16 magic (EI_ADPCM_MAGIC), uint16 seq, uint16 n_samples,
+ *     int16 predictor, uint8 step_index, uint8 stream_id, uint16 check
+ *   (n_samples + 1) / 2 bytes of codes, first sample in the low nibble
+ *
+ * where check is the Fletcher-16 of the other header bytes and the codes, so a
+ * host can find packets in a byte stream shared with text output.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_ADPCM_H
+#define EI_ADPCM_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defines ----------------------------------------------------------------- */
+#define EI_ADPCM_MAGIC                  0x4441  // "AD"
+#define EI_ADPCM_HEADER_SIZE            12
+#define EI_ADPCM_MAX_PACKET_SAMPLES     8192
+#define EI_ADPCM_PACKET_SIZE(n_samples) (EI_ADPCM_HEADER_SIZE + ((n_samples) + 1u) / 2)
+
+/* Types ------------------------------------------------------------------- */
+
+/** Codec state, identical in encoder and decoder after every sample */
+typedef struct {
+    int16_t predictor;
+    uint8_t step_index;         // 0..88
+} ei_adpcm_state_t;
+
+typedef struct {
+    ei_adpcm_state_t state;
+    uint8_t stream_id;
+    uint16_t seq;               // of the packet being filled
+    uint16_t packet_samples;
+    uint16_t fill;              // samples in the packet being filled
+    uint8_t *packet;
+    void (*write_fn)(const void *data, size_t len);
+
+    uint32_t packets;           // written since init
+    uint64_t samples;
+} ei_adpcm_encoder_t;
+
+/** Header fields of a decoded packet */
+typedef struct {
+    uint16_t seq;
+    uint16_t n_samples;
+    uint8_t stream_id;
+    ei_adpcm_state_t state;     // at the first sample
+} ei_adpcm_packet_info_t;
+
+/* Function prototypes ----------------------------------------------------- */
+uint8_t ei_adpcm_encode_sample(ei_adpcm_state_t *state, int16_t sample);
+int16_t ei_adpcm_decode_sample(ei_adpcm_state_t *state, uint8_t code);
+
+int ei_adpcm_encoder_init(ei_adpcm_encoder_t *e, uint8_t *packet, size_t packet_size,
+                          uint16_t packet_samples, uint8_t stream_id,
+                          void (*write_fn)(const void *data, size_t len));
+void ei_adpcm_encode(ei_adpcm_encoder_t *e, const int16_t *samples, size_t n);
+void ei_adpcm_flush(ei_adpcm_encoder_t *e);
+
+int ei_adpcm_decode_packet(const uint8_t *buf, size_t len, ei_adpcm_packet_info_t *info,
+                           int16_t *out, size_t max_samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+/* Two stage cascade gate and statistics. See ei_cascade.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+
+#include "ei_cascade.h"
+
+/* Private functions ------------------------------------------------------- */
+
+static void stage_add(ei_cascade_stage_stats_t *s, uint32_t us)
+{
+    s->runs++;
+    s->total_us += us;
+    if (us > s->max_us) {
+        s->max_us = us;
+    }
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Initialize the cascade with empty statistics
+ *
+ * @param threshold first stage score from which the second stage runs, 0 runs
+ * it on every input
+ *
+ * @param hold number of inputs after the last pass that are still passed on
+ */
+void ei_cascade_init(ei_cascade_t *c, float threshold, uint16_t hold)
+{
+    c->threshold = threshold;
+    c->hold = hold;
+    c->hold_left = 0;
+    ei_cascade_reset_stats(c);
+}
+
+void ei_cascade_reset_stats(ei_cascade_t *c)
+{
+    c->inputs = 0;
+    c->passed = 0;
+    c->detections = 0;
+    memset(&c->stage1, 0, sizeof(c->stage1));
+    memset(&c->stage2, 0, sizeof(c->stage2));
+}
+
+/**
+ * @brief Account for one first stage run and decide on the second stage
+ *
+ * @param score of the first stage, 0..1
+ *
+ * @param stage1_us time the first stage took
+ *
+ * @return true to run the second stage on this input
+ */
+bool ei_cascade_gate(ei_cascade_t *c, float score, uint32_t stage1_us)
+{
+    c->inputs++;
+    stage_add(&c->stage1, stage1_us);
+
+    if (score >= c->threshold) {
+        c->passed++;
+        c->hold_left = c->hold;
+        return true;
+    }
+    if (c->hold_left > 0) {
+        c->hold_left--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Account for one second stage run
+ *
+ * @param stage2_us time the second stage took
+ *
+ * @param detected the second stage confirmed the first
+ */
+void ei_cascade_stage2_done(ei_cascade_t *c, uint32_t stage2_us, bool detected)
+{
+    stage_add(&c->stage2, stage2_us);
+    if (detected) {
+        c->detections++;
+    }
+}
+
+/**
+ * @brief Initialize a level detector. The floor starts at the first level scored.
+ *
+ * @param rise part of the distance to a louder level the floor moves per
+ * update, e.g. 1/64 follows a change of background within 64 inputs
+ *
+ * @param min_floor lowest floor, in units of the level
+ */
+void ei_cascade_level_init(ei_cascade_level_t *d, float rise, float min_floor)
+{
+    d->floor = 0.0f;
+    d->rise = rise;
+    d->min_floor = min_floor;
+}
+
+/**
+ * @brief Score a level (RMS, standard deviation, ...) against the noise floor,
+ * then update the floor
+ *
+ * @return float 1 - floor / level: 0 at or below the floor, 0.5 at twice the
+ * floor (+6 dB), towards 1 above
+ */
+float ei_cascade_level_score(ei_cascade_level_t *d, float level)
+{
+    float score = 0.0f;
+
+    if (d->floor == 0.0f) {
+        d->floor = (level > d->min_floor) ? level : d->min_floor;
+    } else if (level > d->floor) {
+        score = 1.0f - d->floor / level;
+        d->floor += (level - d->floor) * d->rise;
+    } else {
+        d->floor = (level > d->min_floor) ? level : d->min_floor;
+    }
+
+    return score;
+}
@@ -0,0 +1,82 @@
+/* Two stage cascade. A cheap first stage scores every slice or window, and the
+ * full impulse only runs when that score reaches a threshold, and for `hold`
+ * more inputs after it, so an event that spans several slices is classified
+ * as a whole. The cascade keeps the pass rates and the time spent per stage;
+ * the inputs themselves stay with the caller, which runs the second stage on
+ * the data it already buffered.
+ *
+ * ei_cascade_level_t is a first stage without a model: the level of the input
+ * against a noise floor that follows it down at once and up slowly.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_CASCADE_H
+#define EI_CASCADE_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Types ------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t runs;
+    uint64_t total_us;
+    uint32_t max_us;
+} ei_cascade_stage_stats_t;
+
+typedef struct {
+    float threshold;            // first stage score that runs the second stage, 0 => always
+    uint16_t hold;              // inputs after the last pass that still run the second stage
+    uint16_t hold_left;
+
+    uint32_t inputs;            // scored by the first stage
+    uint32_t passed;            // first stage score >= threshold
+    uint32_t detections;        // second stage runs that detected something
+    ei_cascade_stage_stats_t stage1;
+    ei_cascade_stage_stats_t stage2;
+} ei_cascade_t;
+
+typedef struct {
+    float floor;                // current noise floor, 0 until the first level
+    float rise;                 // part of the distance to a louder level the floor moves per update
+    float min_floor;
+} ei_cascade_level_t;
+
+/* Function prototypes ----------------------------------------------------- */
+void ei_cascade_init(ei_cascade_t *c, float threshold, uint16_t hold);
+void ei_cascade_reset_stats(ei_cascade_t *c);
+bool ei_cascade_gate(ei_cascade_t *c, float score, uint32_t stage1_us);
+void ei_cascade_stage2_done(ei_cascade_t *c, uint32_t stage2_us, bool detected);
+
+void ei_cascade_level_init(ei_cascade_level_t *d, float rise, float min_floor);
+float ei_cascade_level_score(ei_cascade_level_t *d, float level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
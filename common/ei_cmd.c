@@ -0,0 +1,218 @@
+/* AT style command parser. See ei_cmd.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <ctype.h>
+#include <errno.h>
+#include <string.h>
+#include "ei_cmd.h"
+
+/* Private functions ------------------------------------------------------- */
+static char *trim(char *str)
+{
+    while (*str == ' ') {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && end[-1] == ' ') {
+        *--end = '\0';
+    }
+
+    return str;
+}
+
+static void print_help(ei_cmd_parser_t *p)
+{
+    for (size_t ix = 0; ix < p->n_cmds; ix++) {
+        p->print("AT+");
+        p->print(p->cmds[ix].name);
+        p->print(" - ");
+        p->print(p->cmds[ix].help);
+        p->print("\r\n");
+    }
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Case insensitive string comparison, e.g. for keyword arguments
+ */
+bool ei_cmd_equals(const char *a, const char *b)
+{
+    while (*a && *b) {
+        if (toupper((unsigned char)*a) != toupper((unsigned char)*b)) {
+            return false;
+        }
+        a++;
+        b++;
+    }
+
+    return *a == *b;
+}
+
+/**
+ * @brief Setup a parser on a command table, which is kept by reference
+ *
+ * @param print writes responses, e.g. to the UART commands come from
+ */
+void ei_cmd_init(ei_cmd_parser_t *p, const ei_cmd_t *cmds, size_t n_cmds, void (*print)(const char *str))
+{
+    memset(p, 0, sizeof(ei_cmd_parser_t));
+    p->cmds = cmds;
+    p->n_cmds = n_cmds;
+    p->print = print;
+}
+
+/**
+ * @brief Feed received bytes, complete lines are executed right away.
+ * Lines end with CR or LF, backspace removes the last character.
+ */
+void ei_cmd_feed(ei_cmd_parser_t *p, const char *data, size_t len)
+{
+    for (size_t ix = 0; ix < len; ix++) {
+        char c = data[ix];
+
+        if (c == '\r' || c == '\n') {
+            if (p->overflow) {
+                p->errors++;
+                p->print("ERROR: line too long\r\n");
+            } else if (p->len > 0) {
+                p->line[p->len] = '\0';
+                ei_cmd_execute(p, p->line);
+            }
+            p->len = 0;
+            p->overflow = false;
+        } else if (c == '\b' || c == 0x7F) {
+            if (p->len > 0) {
+                p->len--;
+            }
+        } else if (p->len < EI_CMD_LINE_MAX - 1) {
+            p->line[p->len++] = c;
+        } else {
+            p->overflow = true;
+        }
+    }
+}
+
+/**
+ * @brief Execute one line, which is modified in place
+ *
+ * @return int, 0 => OK
+ */
+int ei_cmd_execute(ei_cmd_parser_t *p, char *line)
+{
+    char *argv[EI_CMD_MAX_ARGS];
+    int argc = 0;
+    int ret = -1;
+
+    p->lines++;
+    line = trim(line);
+
+    if (ei_cmd_equals(line, "AT")) {
+        ret = 0;
+    } else if (toupper((unsigned char)line[0]) == 'A' && toupper((unsigned char)line[1]) == 'T'
+            && line[2] == '+') {
+        char *name = &line[3];
+        char *args = strchr(name, '=');
+        char *query = strchr(name, '?');
+
+        if (args != NULL) {
+            *args++ = '\0';
+            while (args != NULL && argc < EI_CMD_MAX_ARGS) {
+                char *next = strchr(args, ',');
+                if (next != NULL) {
+                    *next++ = '\0';
+                }
+                argv[argc++] = trim(args);
+                args = next;
+            }
+            if (args != NULL) {
+                // more arguments than any command takes
+                argc = -1;
+            }
+        } else if (query != NULL && query[1] == '\0') {
+            *query = '\0';
+        }
+        name = trim(name);
+
+        if (argc >= 0) {
+            if (ei_cmd_equals(name, "HELP")) {
+                print_help(p);
+                ret = 0;
+            }
+            for (size_t ix = 0; ix < p->n_cmds; ix++) {
+                if (ei_cmd_equals(name, p->cmds[ix].name)) {
+                    ret = p->cmds[ix].fn(argc, argv);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (ret == 0) {
+        p->print("OK\r\n");
+    } else {
+        p->errors++;
+        p->print("ERROR\r\n");
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Parse a decimal (or 0x hexadecimal) integer argument
+ *
+ * @return int, 0 => OK, -1 if not a number or out of [min, max]
+ */
+int ei_cmd_parse_int(const char *str, int32_t min, int32_t max, int32_t *out)
+{
+    char *end;
+
+    errno = 0;
+    long v = strtol(str, &end, 0);
+    if (end == str || *end != '\0' || errno != 0 || v < min || v > max) {
+        return -1;
+    }
+    *out = (int32_t)v;
+
+    return 0;
+}
+
+/**
+ * @brief Parse a floating point argument
+ *
+ * @return int, 0 => OK, -1 if not a number or out of [min, max]
+ */
+int ei_cmd_parse_float(const char *str, float min, float max, float *out)
+{
+    char *end;
+
+    errno = 0;
+    float v = strtof(str, &end);
+    if (end == str || *end != '\0' || errno != 0 || !(v >= min && v <= max)) {
+        return -1;
+    }
+    *out = v;
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+/* Allocation free parser for AT style commands, e.g. received over a UART.
+ * Bytes are fed as they arrive, from any number of partial reads; once a line
+ * is complete it is split in place into a command name and comma separated
+ * arguments, and the matching handler from a caller supplied table is called:
+ *
+ *   AT+NAME             run the command, or print its current value
+ *   AT+NAME?            same
+ *   AT+NAME=arg1,arg2   set
+ *
+ * Every line is answered with OK or ERROR. AT+HELP lists the table.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_CMD_H
+#define EI_CMD_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defines ----------------------------------------------------------------- */
+#ifndef EI_CMD_LINE_MAX
+#define EI_CMD_LINE_MAX             64
+#endif
+
+#ifndef EI_CMD_MAX_ARGS
+#define EI_CMD_MAX_ARGS             4
+#endif
+
+/* Types ------------------------------------------------------------------- */
+
+/** Command handler, argc is 0 for AT+NAME and AT+NAME?. 0 => OK */
+typedef int (*ei_cmd_fn_t)(int argc, char **argv);
+
+typedef struct {
+    const char *name;           // without the AT+ prefix, matched case insensitive
+    const char *help;
+    ei_cmd_fn_t fn;
+} ei_cmd_t;
+
+typedef struct {
+    const ei_cmd_t *cmds;
+    size_t n_cmds;
+    void (*print)(const char *str);
+
+    char line[EI_CMD_LINE_MAX];
+    size_t len;
+    bool overflow;              // current line is too long and will be rejected
+
+    uint32_t lines;
+    uint32_t errors;
+} ei_cmd_parser_t;
+
+/* Function prototypes ----------------------------------------------------- */
+void ei_cmd_init(ei_cmd_parser_t *p, const ei_cmd_t *cmds, size_t n_cmds, void (*print)(const char *str));
+void ei_cmd_feed(ei_cmd_parser_t *p, const char *data, size_t len);
+int ei_cmd_execute(ei_cmd_parser_t *p, char *line);
+bool ei_cmd_equals(const char *a, const char *b);
+int ei_cmd_parse_int(const char *str, int32_t min, int32_t max, int32_t *out);
+int ei_cmd_parse_float(const char *str, float min, float max, float *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+/* Energy and CPU duty cycle accounting. See ei_energy.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+
+#include "ei_energy.h"
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief Attribute the time since the last state change to the current state
+ */
+static void account(ei_energy_t *e)
+{
+    uint64_t now = e->now_us();
+
+    if (now > e->state_start_us) {
+        e->time_us[e->state] += now - e->state_start_us;
+    }
+    e->state_start_us = now;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Rough CC1352P7 figures at 3.0 V: active at 48 MHz ~3.4 mA, idle with
+ * the power policy (CPU off, RAM and peripherals on) ~1 mA, idle with the UART
+ * transmitting ~1.2 mA. Measure your board and override them.
+ */
+void ei_energy_default_model(ei_energy_model_t *model)
+{
+    model->state_uw[EI_ENERGY_ACQUIRE] = 3000;
+    model->state_uw[EI_ENERGY_DSP] = 10200;
+    model->state_uw[EI_ENERGY_NN] = 10200;
+    model->state_uw[EI_ENERGY_LOG] = 3600;
+    model->state_uw[EI_ENERGY_APP] = 10200;
+    model->base_uw = 0;
+}
+
+/**
+ * @brief Start accounting in EI_ENERGY_APP
+ *
+ * @param model power per state, NULL for ei_energy_default_model
+ *
+ * @param now_us monotonic clock, e.g. ei_read_timer_us
+ */
+void ei_energy_init(ei_energy_t *e, const ei_energy_model_t *model, uint64_t (*now_us)(void))
+{
+    if (model == NULL) {
+        ei_energy_default_model(&e->model);
+    } else {
+        e->model = *model;
+    }
+    e->now_us = now_us;
+    e->state = EI_ENERGY_APP;
+    ei_energy_reset(e);
+}
+
+/**
+ * @brief Clear the accumulated time, the current state is kept
+ */
+void ei_energy_reset(ei_energy_t *e)
+{
+    memset(e->time_us, 0, sizeof(e->time_us));
+    e->inferences = 0;
+    e->start_us = e->now_us();
+    e->state_start_us = e->start_us;
+}
+
+/**
+ * @brief Switch state, the time since the last change goes to the previous state
+ *
+ * @return ei_energy_state_t the previous state, to return to after a nested section
+ */
+ei_energy_state_t ei_energy_enter(ei_energy_t *e, ei_energy_state_t state)
+{
+    ei_energy_state_t prev = e->state;
+
+    account(e);
+    e->state = state;
+
+    return prev;
+}
+
+/**
+ * @brief Move us of the time spent in the current state to another state.
+ * For work that is timed elsewhere, e.g. the DSP time reported by the SDK
+ * within a run_classifier call accounted as EI_ENERGY_NN.
+ */
+void ei_energy_charge(ei_energy_t *e, ei_energy_state_t state, uint64_t us)
+{
+    account(e);
+    if (us > e->time_us[e->state]) {
+        us = e->time_us[e->state];
+    }
+    e->time_us[e->state] -= us;
+    e->time_us[state] += us;
+}
+
+void ei_energy_inference_done(ei_energy_t *e)
+{
+    e->inferences++;
+}
+
+/**
+ * @brief Duty cycle and energy since the last reset, up to now
+ */
+void ei_energy_get_report(ei_energy_t *e, ei_energy_report_t *report)
+{
+    uint64_t active_us;
+    uint64_t energy_pj = 0;     // us * uW
+
+    account(e);
+    memset(report, 0, sizeof(ei_energy_report_t));
+    for (int s = 0; s < EI_ENERGY_N_STATES; s++) {
+        report->time_us[s] = e->time_us[s];
+        report->total_us += e->time_us[s];
+        energy_pj += e->time_us[s] * (e->model.state_uw[s] + e->model.base_uw);
+    }
+    report->inferences = e->inferences;
+    if (report->total_us == 0) {
+        return;
+    }
+
+    active_us = e->time_us[EI_ENERGY_DSP] + e->time_us[EI_ENERGY_NN] + e->time_us[EI_ENERGY_APP];
+    report->duty_permille = (uint32_t)((active_us * 1000) / report->total_us);
+    report->energy_uj = energy_pj / 1000000;
+    report->avg_uw = (uint32_t)(energy_pj / report->total_us);
+    if (e->inferences > 0) {
+        report->uj_per_inference = (uint32_t)(report->energy_uj / e->inferences);
+    }
+}
+
+const char *ei_energy_state_name(ei_energy_state_t state)
+{
+    static const char *names[EI_ENERGY_N_STATES] = { "acquire", "dsp", "nn", "log", "app" };
+
+    return ((unsigned)state < EI_ENERGY_N_STATES) ? names[state] : "?";
+}
@@ -0,0 +1,95 @@
+/* Energy and CPU duty cycle accounting. The application tells the estimator
+ * which state it is in - waiting for sensor data, DSP, inference, output or
+ * other work - and wall time is attributed to that state until the next
+ * change. Combined with a per state power model, this gives the duty cycle,
+ * the average power and the energy per inference, so gating and stride
+ * settings can be compared on what matters for a battery product. Time comes
+ * from a caller supplied microsecond clock, so the estimator also runs in the
+ * host simulator.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_ENERGY_H
+#define EI_ENERGY_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Types ------------------------------------------------------------------- */
+
+typedef enum {
+    EI_ENERGY_ACQUIRE = 0,      // waiting for sensor data, the CPU idles
+    EI_ENERGY_DSP,
+    EI_ENERGY_NN,               // inference and anomaly detection
+    EI_ENERGY_LOG,              // result output over the UART
+    EI_ENERGY_APP,              // any other processing
+    EI_ENERGY_N_STATES
+} ei_energy_state_t;
+
+/** Power drawn in each state, in uW */
+typedef struct {
+    uint32_t state_uw[EI_ENERGY_N_STATES];
+    uint32_t base_uw;           // always drawn, e.g. codec or sensor
+} ei_energy_model_t;
+
+typedef struct {
+    ei_energy_model_t model;
+    uint64_t (*now_us)(void);
+
+    ei_energy_state_t state;
+    uint64_t state_start_us;    // last state change
+    uint64_t start_us;          // last reset
+    uint64_t time_us[EI_ENERGY_N_STATES];
+    uint32_t inferences;
+} ei_energy_t;
+
+typedef struct {
+    uint64_t total_us;
+    uint64_t time_us[EI_ENERGY_N_STATES];
+    uint32_t inferences;
+    uint32_t duty_permille;     // DSP, NN and APP time over total time
+    uint64_t energy_uj;
+    uint32_t uj_per_inference;
+    uint32_t avg_uw;            // mJ per hour = avg_uw * 3.6
+} ei_energy_report_t;
+
+/* Function prototypes ----------------------------------------------------- */
+void ei_energy_default_model(ei_energy_model_t *model);
+void ei_energy_init(ei_energy_t *e, const ei_energy_model_t *model, uint64_t (*now_us)(void));
+void ei_energy_reset(ei_energy_t *e);
+ei_energy_state_t ei_energy_enter(ei_energy_t *e, ei_energy_state_t state);
+void ei_energy_charge(ei_energy_t *e, ei_energy_state_t state, uint64_t us);
+void ei_energy_inference_done(ei_energy_t *e);
+void ei_energy_get_report(ei_energy_t *e, ei_energy_report_t *report);
+const char *ei_energy_state_name(ei_energy_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
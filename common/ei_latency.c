@@ -0,0 +1,147 @@
+/* Latency histogram. See ei_latency.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+
+#include "ei_latency.h"
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief Bucket of a latency in units: 0..3 one unit wide, then four buckets
+ * per octave, [4,5) [5,6) [6,7) [7,8) [8,10) [10,12) ...
+ */
+static uint16_t bucket_of(uint32_t units)
+{
+    uint32_t octave = 0;
+    uint32_t ix;
+
+    if (units < 4) {
+        return (uint16_t)units;
+    }
+    for (uint32_t v = units; v > 1; v >>= 1) {
+        octave++;
+    }
+    ix = 4 * (octave - 1) + ((units >> (octave - 2)) & 3);
+
+    return (ix < EI_LATENCY_BUCKETS) ? (uint16_t)ix : (EI_LATENCY_BUCKETS - 1);
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Initialize an empty histogram
+ *
+ * @param unit_us width of the first buckets, e.g. 1000 to cover up to ~2 s
+ * with 40 buckets, or the clock resolution if that is coarser
+ */
+void ei_latency_init(ei_latency_t *h, uint32_t unit_us)
+{
+    h->unit_us = unit_us ? unit_us : 1;
+    ei_latency_reset(h);
+}
+
+void ei_latency_reset(ei_latency_t *h)
+{
+    h->count = 0;
+    h->last_us = 0;
+    h->min_us = UINT32_MAX;
+    h->max_us = 0;
+    h->total_us = 0;
+    memset(h->buckets, 0, sizeof(h->buckets));
+}
+
+void ei_latency_add(ei_latency_t *h, uint32_t us)
+{
+    h->count++;
+    h->last_us = us;
+    h->total_us += us;
+    if (us < h->min_us) {
+        h->min_us = us;
+    }
+    if (us > h->max_us) {
+        h->max_us = us;
+    }
+    h->buckets[bucket_of(us / h->unit_us)]++;
+}
+
+/**
+ * @brief Time between two stamps of a free running 32 bit us clock, correct
+ * across a wrap of the clock (every ~71 minutes)
+ */
+uint32_t ei_latency_since(uint32_t capture_us, uint32_t now_us)
+{
+    return now_us - capture_us;
+}
+
+uint32_t ei_latency_avg_us(const ei_latency_t *h)
+{
+    return h->count ? (uint32_t)(h->total_us / h->count) : 0;
+}
+
+/**
+ * @brief Upper end of a bucket, the last bucket is open ended
+ */
+uint32_t ei_latency_bucket_upper_us(const ei_latency_t *h, uint16_t bucket)
+{
+    uint32_t units;
+
+    if (bucket < 4) {
+        units = bucket + 1;
+    } else {
+        uint32_t octave = bucket / 4 + 1;
+        units = (5 + (bucket & 3)) << (octave - 2);
+    }
+
+    return units * h->unit_us;
+}
+
+/**
+ * @brief Latency that percent of the recorded latencies did not exceed,
+ * rounded up to the end of its bucket but no more than the maximum
+ *
+ * @return uint32_t latency in us, 0 if nothing was recorded
+ */
+uint32_t ei_latency_percentile_us(const ei_latency_t *h, uint8_t percent)
+{
+    uint64_t rank;
+    uint64_t seen = 0;
+
+    if (h->count == 0) {
+        return 0;
+    }
+    rank = ((uint64_t)h->count * (percent > 100 ? 100 : percent) + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+    for (uint16_t ix = 0; ix < EI_LATENCY_BUCKETS; ix++) {
+        seen += h->buckets[ix];
+        if (seen >= rank) {
+            uint32_t upper = ei_latency_bucket_upper_us(h, ix);
+            return (upper < h->max_us && ix < EI_LATENCY_BUCKETS - 1) ? upper : h->max_us;
+        }
+    }
+
+    return h->max_us;
+}
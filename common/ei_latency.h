@@ -0,0 +1,71 @@
+/* Latency histogram. Records the time from the capture of the data to the
+ * decision made on it, e.g. from the I2S interrupt that completed a slice to
+ * the result of the impulse, so the age of a result can be checked against a
+ * deadline rather than only the time spent in the SDK. Buckets are log-linear:
+ * four per octave of `unit_us`, so percentiles are within 25% at any scale
+ * while the histogram stays a few hundred bytes. Minimum, maximum and average
+ * are exact.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_LATENCY_H
+#define EI_LATENCY_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 4 buckets per octave, the last one also counts everything above 2048 units */
+#ifndef EI_LATENCY_BUCKETS
+#define EI_LATENCY_BUCKETS      40
+#endif
+
+/* Types ------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t unit_us;           // resolution of the first buckets
+    uint32_t count;
+    uint32_t last_us;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[EI_LATENCY_BUCKETS];
+} ei_latency_t;
+
+/* Function prototypes ----------------------------------------------------- */
+void ei_latency_init(ei_latency_t *h, uint32_t unit_us);
+void ei_latency_reset(ei_latency_t *h);
+void ei_latency_add(ei_latency_t *h, uint32_t us);
+uint32_t ei_latency_since(uint32_t capture_us, uint32_t now_us);
+uint32_t ei_latency_avg_us(const ei_latency_t *h);
+uint32_t ei_latency_percentile_us(const ei_latency_t *h, uint8_t percent);
+uint32_t ei_latency_bucket_upper_us(const ei_latency_t *h, uint16_t bucket);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
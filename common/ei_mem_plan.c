@@ -0,0 +1,188 @@
+/* Lifetime aware memory planner. See ei_mem_plan.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include "ei_mem_plan.h"
+
+/* Defines ----------------------------------------------------------------- */
+#ifndef EI_MEM_MAX_BUFFERS
+#define EI_MEM_MAX_BUFFERS          16
+#endif
+
+/* Private functions ------------------------------------------------------- */
+
+static bool placed_in_region(const ei_mem_buffer_t *buf)
+{
+    return !buf->external && buf->size > 0;
+}
+
+/**
+ * @brief Lowest aligned offset at which buf does not overlap any buffer in
+ * order[0..n_placed) that is live in one of its stages
+ */
+static size_t first_fit(const ei_mem_buffer_t *bufs, const uint8_t *order, size_t n_placed,
+                        const ei_mem_buffer_t *buf)
+{
+    size_t offset = 0;
+    bool moved;
+
+    do {
+        moved = false;
+        for (size_t ix = 0; ix < n_placed; ix++) {
+            const ei_mem_buffer_t *other = &bufs[order[ix]];
+            if ((other->stages & buf->stages) == 0) {
+                continue;
+            }
+            if (offset < other->offset + other->size && other->offset < offset + buf->size) {
+                offset = EI_MEM_ALIGN_UP(other->offset + other->size);
+                moved = true;
+            }
+        }
+    } while (moved);
+
+    return offset;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Assign an offset in the shared region to every buffer that is not
+ * external. Buffers are placed largest first, each at the lowest offset that
+ * is free in all of its stages, so a buffer goes where one that is dead during
+ * its stages was placed before.
+ *
+ * @param region_size size of the region the layout needs, in bytes
+ *
+ * @return int, 0 => OK
+ */
+int ei_mem_plan_layout(ei_mem_buffer_t *bufs, size_t n, size_t *region_size)
+{
+    uint8_t order[EI_MEM_MAX_BUFFERS];
+    size_t n_placed = 0;
+    size_t end = 0;
+
+    if (n > EI_MEM_MAX_BUFFERS) {
+        return -1;
+    }
+
+    // insertion sort by size, largest first, ties in table order
+    for (size_t ix = 0; ix < n; ix++) {
+        bufs[ix].offset = 0;
+        if (!placed_in_region(&bufs[ix])) {
+            continue;
+        }
+        size_t pos = n_placed++;
+        while (pos > 0 && bufs[order[pos - 1]].size < bufs[ix].size) {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = (uint8_t)ix;
+    }
+
+    for (size_t ix = 0; ix < n_placed; ix++) {
+        ei_mem_buffer_t *buf = &bufs[order[ix]];
+        buf->offset = first_fit(bufs, order, ix, buf);
+        if (buf->offset + buf->size > end) {
+            end = buf->offset + buf->size;
+        }
+    }
+
+    *region_size = end;
+    return 0;
+}
+
+/**
+ * @brief Lay out the buffers in region and set their pointers. External
+ * buffers and buffers of size 0 get NULL.
+ *
+ * @param region aligned to EI_MEM_ALIGN
+ *
+ * @return int, 0 => OK, -1 if the layout does not fit in region_size
+ */
+int ei_mem_plan_place(ei_mem_buffer_t *bufs, size_t n, void *region, size_t region_size)
+{
+    size_t needed;
+
+    if (ei_mem_plan_layout(bufs, n, &needed) != 0 || needed > region_size) {
+        return -1;
+    }
+    for (size_t ix = 0; ix < n; ix++) {
+        if (bufs[ix].ptr != NULL) {
+            *bufs[ix].ptr = placed_in_region(&bufs[ix]) ? (uint8_t *)region + bufs[ix].offset : NULL;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Bytes of the placed or the external buffers that are live in a stage
+ */
+size_t ei_mem_plan_stage_bytes(const ei_mem_buffer_t *bufs, size_t n, uint8_t stage, bool external)
+{
+    size_t bytes = 0;
+
+    for (size_t ix = 0; ix < n; ix++) {
+        if (bufs[ix].external == external && (bufs[ix].stages & EI_MEM_STAGE(stage))) {
+            bytes += bufs[ix].size;
+        }
+    }
+
+    return bytes;
+}
+
+/**
+ * @brief Summarize a layout
+ *
+ * @param n_stages stages of the application, up to EI_MEM_MAX_STAGES
+ *
+ * @param region_size as returned by ei_mem_plan_layout
+ */
+void ei_mem_plan_get_report(const ei_mem_buffer_t *bufs, size_t n, uint8_t n_stages,
+                            size_t region_size, ei_mem_plan_report_t *out)
+{
+    out->region_bytes = region_size;
+    out->lower_bound_bytes = 0;
+    out->unshared_bytes = 0;
+    out->peak_bytes = region_size;
+    out->peak_stage = 0;
+    out->external_bytes = 0;
+
+    for (size_t ix = 0; ix < n; ix++) {
+        if (placed_in_region(&bufs[ix])) {
+            out->unshared_bytes += bufs[ix].size;
+        }
+    }
+    for (uint8_t stage = 0; stage < n_stages && stage < EI_MEM_MAX_STAGES; stage++) {
+        size_t placed = ei_mem_plan_stage_bytes(bufs, n, stage, false);
+        size_t external = ei_mem_plan_stage_bytes(bufs, n, stage, true);
+        if (placed > out->lower_bound_bytes) {
+            out->lower_bound_bytes = placed;
+        }
+        if (stage == 0 || region_size + external > out->peak_bytes) {
+            out->peak_bytes = region_size + external;
+            out->peak_stage = stage;
+            out->external_bytes = external;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/* Lifetime aware memory planner. The application describes its buffers with
+ * the stages of its loop (e.g. sampling, DSP, inference, output) in which each
+ * one holds data, and buffers that are never live in the same stage are
+ * overlaid in one shared region. Buffers allocated elsewhere, such as the SDK
+ * heap or driver buffers, can be added as external: they are not placed but
+ * count towards the peak of the stages they are live in, so the report shows
+ * which stage sets the RAM requirement. Sizes are usually compile time
+ * constants, so the region can be a static array sized with the EI_MEM_*
+ * macros, and ei_mem_plan_place checks at init that the layout fits.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_MEM_PLAN_H
+#define EI_MEM_PLAN_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defines ----------------------------------------------------------------- */
+#define EI_MEM_MAX_STAGES           32
+#define EI_MEM_STAGE(n)             (1u << (n))
+#define EI_MEM_ALL_STAGES           0xffffffffu
+
+/* Offsets in the region are aligned to EI_MEM_ALIGN bytes */
+#ifndef EI_MEM_ALIGN
+#define EI_MEM_ALIGN                8
+#endif
+
+#define EI_MEM_ALIGN_UP(bytes)      (((bytes) + EI_MEM_ALIGN - 1) / EI_MEM_ALIGN * EI_MEM_ALIGN)
+#define EI_MEM_MAX(a, b)            ((a) > (b) ? (a) : (b))
+
+/* Types ------------------------------------------------------------------- */
+
+typedef struct {
+    const char *name;
+    size_t size;                // in bytes, 0 for a buffer that is not used
+    uint32_t stages;            // EI_MEM_STAGE bits of the stages it is live in
+    bool external;              // allocated elsewhere, only counted
+    void **ptr;                 // set to the buffer by ei_mem_plan_place, may be NULL
+    size_t offset;              // in the region, set by ei_mem_plan_layout
+} ei_mem_buffer_t;
+
+typedef struct {
+    size_t region_bytes;        // shared region needed by the layout
+    size_t lower_bound_bytes;   // placed buffers live in the busiest stage, no layout needs less
+    size_t unshared_bytes;      // placed buffers without overlays
+    size_t peak_bytes;          // region plus the external buffers of peak_stage
+    uint8_t peak_stage;
+    size_t external_bytes;      // external buffers live in peak_stage
+} ei_mem_plan_report_t;
+
+/* Function prototypes ----------------------------------------------------- */
+int ei_mem_plan_layout(ei_mem_buffer_t *bufs, size_t n, size_t *region_size);
+int ei_mem_plan_place(ei_mem_buffer_t *bufs, size_t n, void *region, size_t region_size);
+size_t ei_mem_plan_stage_bytes(const ei_mem_buffer_t *bufs, size_t n, uint8_t stage, bool external);
+void ei_mem_plan_get_report(const ei_mem_buffer_t *bufs, size_t n, uint8_t n_stages,
+                            size_t region_size, ei_mem_plan_report_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,226 @@
+/* Pre-roll capture buffer. See ei_preroll.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "ei_preroll.h"
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief Number of snapshot samples that have been recorded but not read yet
+ */
+static size_t readable(const ei_preroll_t *p)
+{
+    if (!p->snapshot_active) {
+        return 0;
+    }
+    uint64_t end = (p->written < p->snap_end) ? p->written : p->snap_end;
+
+    return (size_t)(end - p->read_pos);
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Setup the pre-roll store on a caller owned buffer
+ *
+ * @param capacity size of buf in samples, must cover pre + post trigger samples
+ *
+ * @return int, 0 => OK
+ */
+int ei_preroll_init(ei_preroll_t *p, int16_t *buf, size_t capacity)
+{
+    if (buf == NULL || capacity == 0) {
+        return -1;
+    }
+
+    memset(p, 0, sizeof(ei_preroll_t));
+    p->buf = buf;
+    p->capacity = capacity;
+
+    return 0;
+}
+
+/**
+ * @brief Record samples. Never blocks: samples that would overwrite unread
+ * snapshot data are dropped and counted in not_recorded. The ring then has a
+ * hole before the next sample written, later snapshots start after it.
+ *
+ * @return number of samples recorded
+ */
+size_t ei_preroll_write(ei_preroll_t *p, const int16_t *samples, size_t n)
+{
+    size_t allowed = n;
+
+    if (p->snapshot_active) {
+        // writing absolute index w overwrites w - capacity, which must stay below read_pos
+        uint64_t limit = p->read_pos + p->capacity;
+        allowed = (limit > p->written) ? (size_t)(limit - p->written) : 0;
+        if (allowed > n) {
+            allowed = n;
+        }
+    }
+
+    size_t pos = (size_t)(p->written % p->capacity);
+    size_t done = 0;
+    while (done < allowed) {
+        size_t run = p->capacity - pos;
+        if (run > allowed - done) {
+            run = allowed - done;
+        }
+        memcpy(&p->buf[pos], &samples[done], run * sizeof(int16_t));
+        done += run;
+        pos = 0;
+    }
+
+    p->written += allowed;
+    if (allowed < n) {
+        p->not_recorded += (uint32_t)(n - allowed);
+        p->contiguous_from = p->written;
+    }
+
+    return allowed;
+}
+
+/**
+ * @brief Freeze a snapshot around the current position. The snapshot holds up
+ * to pre_samples already recorded, none from before samples were last dropped,
+ * and completes once post_samples more have been written.
+ *
+ * @return int, 0 => OK, -1 if a snapshot is still pending or it does not fit
+ */
+int ei_preroll_trigger(ei_preroll_t *p, size_t pre_samples, size_t post_samples)
+{
+    if (p->snapshot_active || pre_samples + post_samples > p->capacity) {
+        return -1;
+    }
+
+    uint64_t oldest = (p->written > p->capacity) ? p->written - p->capacity : 0;
+    uint64_t start = (p->written > pre_samples) ? p->written - pre_samples : 0;
+    if (start < oldest) {
+        start = oldest;
+    }
+    if (start < p->contiguous_from) {
+        start = p->contiguous_from;
+    }
+
+    p->snap_start = start;
+    p->snap_end = p->written + post_samples;
+    p->read_pos = start;
+    p->snap_id++;
+    p->chunk_seq = 0;
+    p->snapshot_active = true;
+
+    return 0;
+}
+
+/**
+ * @brief True from the trigger until every snapshot sample has been read
+ */
+bool ei_preroll_snapshot_pending(const ei_preroll_t *p)
+{
+    return p->snapshot_active;
+}
+
+/**
+ * @brief Copy the next recorded snapshot samples. Post-trigger samples become
+ * readable as they are written.
+ *
+ * @return number of samples copied
+ */
+size_t ei_preroll_read(ei_preroll_t *p, int16_t *out, size_t max_samples)
+{
+    size_t n = readable(p);
+    if (n > max_samples) {
+        n = max_samples;
+    }
+
+    size_t done = 0;
+    while (done < n) {
+        size_t pos = (size_t)((p->read_pos + done) % p->capacity);
+        size_t run = p->capacity - pos;
+        if (run > n - done) {
+            run = n - done;
+        }
+        memcpy(&out[done], &p->buf[pos], run * sizeof(int16_t));
+        done += run;
+    }
+
+    p->read_pos += n;
+    if (p->read_pos >= p->snap_end) {
+        p->snapshot_active = false;
+    }
+
+    return n;
+}
+
+/**
+ * @brief Stream the next chunk of the snapshot straight from the ring, as an
+ * ei_preroll_chunk_header_t followed by the samples. Call it between
+ * inferences, max_samples bounds the time spent per call.
+ *
+ * @param write_fn output, e.g. a UART or BLE notification writer
+ *
+ * @return number of samples sent
+ */
+size_t ei_preroll_stream_chunk(ei_preroll_t *p, size_t max_samples,
+                               void (*write_fn)(const void *data, size_t len))
+{
+    size_t n = readable(p);
+    if (n > max_samples) {
+        n = max_samples;
+    }
+    if (n > UINT16_MAX) {
+        n = UINT16_MAX;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    ei_preroll_chunk_header_t header;
+    header.magic = EI_PREROLL_CHUNK_MAGIC;
+    header.snap_id = p->snap_id;
+    header.seq = p->chunk_seq++;
+    header.n_samples = (uint16_t)n;
+    header.remaining = (uint32_t)(p->snap_end - p->read_pos - n);
+    write_fn(&header, sizeof(header));
+
+    size_t done = 0;
+    while (done < n) {
+        size_t pos = (size_t)((p->read_pos + done) % p->capacity);
+        size_t run = p->capacity - pos;
+        if (run > n - done) {
+            run = n - done;
+        }
+        write_fn(&p->buf[pos], run * sizeof(int16_t));
+        done += run;
+    }
+
+    p->read_pos += n;
+    if (p->read_pos >= p->snap_end) {
+        p->snapshot_active = false;
+    }
+
+    return n;
+}
@@ -0,0 +1,83 @@
+/* Pre-roll capture buffer. Raw int16 samples are continuously written into a
+ * circular buffer. When a detection fires, a snapshot covering a configurable
+ * time before and after the trigger is frozen in place and can be streamed out
+ * in chunks. Acquisition is never stalled: while unread snapshot data would be
+ * overwritten, new samples are simply not recorded (and counted).
+ *
+ * The buffer must be written and read from the same thread, e.g. the inference loop.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_PREROLL_H
+#define EI_PREROLL_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defines ----------------------------------------------------------------- */
+#define EI_PREROLL_CHUNK_MAGIC      0x5052  // "PR"
+
+/* Types ------------------------------------------------------------------- */
+typedef struct {
+    int16_t *buf;
+    size_t capacity;            // in samples
+    uint64_t written;           // samples recorded since init
+    uint32_t not_recorded;      // samples not recorded to protect a snapshot
+    uint64_t contiguous_from;   // absolute sample index of the first sample after the last one not recorded
+
+    bool snapshot_active;
+    uint64_t snap_start;        // absolute sample index of the first snapshot sample
+    uint64_t snap_end;          // absolute sample index one past the last one
+    uint64_t read_pos;
+    uint16_t snap_id;
+    uint16_t chunk_seq;
+} ei_preroll_t;
+
+/** Header sent in front of every streamed chunk, followed by n_samples int16 */
+typedef struct {
+    uint16_t magic;
+    uint16_t snap_id;
+    uint16_t seq;
+    uint16_t n_samples;
+    uint32_t remaining;         // samples left in the snapshot after this chunk
+} ei_preroll_chunk_header_t;
+
+/* Function prototypes ----------------------------------------------------- */
+int ei_preroll_init(ei_preroll_t *p, int16_t *buf, size_t capacity);
+size_t ei_preroll_write(ei_preroll_t *p, const int16_t *samples, size_t n);
+int ei_preroll_trigger(ei_preroll_t *p, size_t pre_samples, size_t post_samples);
+bool ei_preroll_snapshot_pending(const ei_preroll_t *p);
+size_t ei_preroll_read(ei_preroll_t *p, int16_t *out, size_t max_samples);
+size_t ei_preroll_stream_chunk(ei_preroll_t *p, size_t max_samples,
+                               void (*write_fn)(const void *data, size_t len));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,352 @@
+/* Flash ring log of inference results. See ei_result_log.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stddef.h>
+#include <string.h>
+#include "ei_result_log.h"
+
+#define RECORD_SIZE     sizeof(ei_result_record_t)
+
+/* Private functions ------------------------------------------------------- */
+static inline uint32_t slot_offset(const ei_result_log_t *log, uint32_t page, uint32_t slot)
+{
+    // slot 0 of every page holds the header
+    return page * log->storage->page_size + (slot + 1) * RECORD_SIZE;
+}
+
+static uint16_t header_check(const ei_result_log_page_header_t *h)
+{
+    uint32_t x = h->magic ^ h->page_seq ^ h->first_seq ^ h->record_size;
+
+    return (uint16_t)((x ^ (x >> 16)) ^ 0x5AA5);
+}
+
+/**
+ * @brief CRC-8 over the record without its check byte, to detect torn writes
+ */
+static uint8_t record_check(const ei_result_record_t *r)
+{
+    const uint8_t *bytes = (const uint8_t *)r;
+    uint8_t crc = 0xFF;
+
+    for (size_t ix = 0; ix < RECORD_SIZE; ix++) {
+        if (ix == offsetof(ei_result_record_t, check)) {
+            continue;
+        }
+        crc ^= bytes[ix];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static bool read_header(ei_result_log_t *log, uint32_t page, ei_result_log_page_header_t *h)
+{
+    if (log->storage->read(log->storage->ctx, page * log->storage->page_size, h, sizeof(*h)) != 0) {
+        log->storage_errors++;
+        return false;
+    }
+
+    return h->magic == EI_RESULT_LOG_MAGIC && h->record_size == RECORD_SIZE
+        && h->check == header_check(h);
+}
+
+/**
+ * @brief Erase a page and make it the head page, starting at next_seq
+ */
+static int open_page(ei_result_log_t *log, uint32_t page, uint32_t page_seq)
+{
+    const ei_log_storage_t *s = log->storage;
+    ei_result_log_page_header_t h;
+
+    if (s->erase(s->ctx, page * s->page_size, s->page_size) != 0) {
+        log->storage_errors++;
+        return -1;
+    }
+    log->pages_erased++;
+
+    h.magic = EI_RESULT_LOG_MAGIC;
+    h.page_seq = page_seq;
+    h.first_seq = log->next_seq;
+    h.record_size = RECORD_SIZE;
+    h.check = header_check(&h);
+    if (s->write(s->ctx, page * s->page_size, &h, sizeof(h)) != 0) {
+        log->storage_errors++;
+        return -1;
+    }
+
+    log->head_page = page;
+    log->head_page_seq = page_seq;
+    log->head_first_seq = log->next_seq;
+    log->head_count = 0;
+    log->flushed_count = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Move on to the next page of the ring, dropping its records
+ */
+static int advance_page(ei_result_log_t *log)
+{
+    uint32_t page = (log->head_page + 1) % log->n_pages;
+    ei_result_log_page_header_t h;
+
+    if (read_header(log, page, &h)) {
+        // every page but the head page is full, the next page in the ring becomes the oldest
+        uint32_t dropped_until = h.first_seq + log->records_per_page;
+        if (dropped_until > log->oldest_seq) {
+            log->oldest_seq = dropped_until;
+        }
+    }
+
+    return open_page(log, page, log->head_page_seq + 1);
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Mount the log, recovering its state from flash. An empty or foreign
+ * region is formatted.
+ *
+ * @param storage region holding at least 2 pages, kept by reference
+ *
+ * @param batch RAM for the records not programmed yet. Records are programmed
+ * in one write once the batch or the page is full, a batch larger than a page
+ * is not used.
+ *
+ * @param batch_records capacity of batch
+ *
+ * @return int, 0 => OK
+ */
+int ei_result_log_init(ei_result_log_t *log, const ei_log_storage_t *storage,
+                       ei_result_record_t *batch, uint32_t batch_records)
+{
+    if (batch == NULL || batch_records == 0 || storage->page_size < 2 * RECORD_SIZE
+            || storage->page_size % RECORD_SIZE != 0 || storage->size % storage->page_size != 0
+            || storage->size / storage->page_size < 2) {
+        return -1;
+    }
+
+    memset(log, 0, sizeof(ei_result_log_t));
+    log->storage = storage;
+    log->pending = batch;
+    log->n_pages = storage->size / storage->page_size;
+    log->records_per_page = storage->page_size / RECORD_SIZE - 1;
+    log->batch_records = (batch_records < log->records_per_page) ? batch_records : log->records_per_page;
+
+    bool found = false;
+    uint32_t oldest_page_seq = 0;
+    for (uint32_t page = 0; page < log->n_pages; page++) {
+        ei_result_log_page_header_t h;
+        if (!read_header(log, page, &h)) {
+            continue;
+        }
+        if (!found || h.page_seq > log->head_page_seq) {
+            log->head_page = page;
+            log->head_page_seq = h.page_seq;
+            log->head_first_seq = h.first_seq;
+        }
+        if (!found || h.page_seq < oldest_page_seq) {
+            oldest_page_seq = h.page_seq;
+            log->oldest_seq = h.first_seq;
+        }
+        found = true;
+    }
+    if (!found) {
+        return ei_result_log_format(log);
+    }
+
+    // the head page is filled up to the first erased slot
+    uint32_t used = 0;
+    bool erased = false;
+    while (!erased && used < log->records_per_page) {
+        uint32_t n = log->records_per_page - used;
+        if (n > log->batch_records) {
+            n = log->batch_records;
+        }
+        if (storage->read(storage->ctx, slot_offset(log, log->head_page, used), log->pending,
+                          n * RECORD_SIZE) != 0) {
+            log->storage_errors++;
+            return -1;
+        }
+        for (uint32_t slot = 0; slot < n && !erased; slot++) {
+            const uint8_t *bytes = (const uint8_t *)&log->pending[slot];
+            erased = true;
+            for (size_t ix = 0; ix < RECORD_SIZE; ix++) {
+                erased = erased && (bytes[ix] == 0xFF);
+            }
+            if (!erased) {
+                used++;
+            }
+        }
+    }
+
+    log->head_count = used;
+    log->flushed_count = used;
+    log->next_seq = log->head_first_seq + used;
+
+    return 0;
+}
+
+/**
+ * @brief Erase the whole region and start an empty log
+ *
+ * @return int, 0 => OK
+ */
+int ei_result_log_format(ei_result_log_t *log)
+{
+    const ei_log_storage_t *s = log->storage;
+
+    if (s->erase(s->ctx, 0, s->size) != 0) {
+        log->storage_errors++;
+        return -1;
+    }
+    log->next_seq = 0;
+    log->oldest_seq = 0;
+
+    return open_page(log, 0, 0);
+}
+
+/**
+ * @brief Add a record, seq and check are filled in. The record is kept in RAM
+ * and programmed once the batch or the page is full, or on ei_result_log_flush.
+ *
+ * @return int, 0 => OK
+ */
+int ei_result_log_append(ei_result_log_t *log, const ei_result_record_t *record)
+{
+    if (log->head_count >= log->records_per_page) {
+        if (ei_result_log_flush(log) != 0 || advance_page(log) != 0) {
+            return -1;
+        }
+    }
+
+    ei_result_record_t *r = &log->pending[log->head_count - log->flushed_count];
+    *r = *record;
+    r->seq = log->next_seq;
+    r->check = record_check(r);
+
+    log->head_count++;
+    log->next_seq++;
+
+    if (log->head_count >= log->records_per_page
+            || log->head_count - log->flushed_count >= log->batch_records) {
+        return ei_result_log_flush(log);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Program all pending records, e.g. before a reset or power down.
+ * Only erased bytes are programmed, flushing often costs writes but no erases.
+ *
+ * @return int, 0 => OK
+ */
+int ei_result_log_flush(ei_result_log_t *log)
+{
+    uint32_t n = log->head_count - log->flushed_count;
+    if (n == 0) {
+        return 0;
+    }
+
+    const ei_log_storage_t *s = log->storage;
+    int ret = s->write(s->ctx, slot_offset(log, log->head_page, log->flushed_count),
+                       log->pending, n * RECORD_SIZE);
+    // a failed write is not retried, programming the same bytes twice is not allowed
+    log->flushed_count = log->head_count;
+    log->flushes++;
+    if (ret != 0) {
+        log->storage_errors++;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Bulk read of the records with a sequence number of at least from_seq,
+ * oldest first. Records still pending in RAM are included. Corrupted records
+ * are skipped.
+ *
+ * @param from_seq e.g. the last seq already downloaded + 1, 0 for everything
+ *
+ * @return number of records copied to out
+ */
+size_t ei_result_log_read(ei_result_log_t *log, uint32_t from_seq, ei_result_record_t *out, size_t max_records)
+{
+    const ei_log_storage_t *s = log->storage;
+    uint32_t rpp = log->records_per_page;
+    size_t n = 0;
+
+    if (from_seq < log->oldest_seq) {
+        from_seq = log->oldest_seq;
+    }
+
+    while (n < max_records && from_seq < log->next_seq) {
+        uint32_t page = log->head_page;
+        uint32_t page_first = log->head_first_seq;
+        if (from_seq < page_first) {
+            uint32_t back = (page_first - from_seq + rpp - 1) / rpp;
+            page = (log->head_page + log->n_pages - (back % log->n_pages)) % log->n_pages;
+            page_first -= back * rpp;
+        }
+        uint32_t slot = from_seq - page_first;
+
+        uint32_t run = rpp - slot;
+        if (run > max_records - n) {
+            run = (uint32_t)(max_records - n);
+        }
+        if (run > log->next_seq - from_seq) {
+            run = log->next_seq - from_seq;
+        }
+
+        if (page == log->head_page && slot >= log->flushed_count) {
+            memcpy(&out[n], &log->pending[slot - log->flushed_count], run * RECORD_SIZE);
+        } else {
+            if (page == log->head_page && slot + run > log->flushed_count) {
+                run = log->flushed_count - slot;
+            }
+            if (s->read(s->ctx, slot_offset(log, page, slot), &out[n], run * RECORD_SIZE) != 0) {
+                log->storage_errors++;
+                break;
+            }
+        }
+
+        size_t kept = n;
+        for (uint32_t ix = 0; ix < run; ix++) {
+            ei_result_record_t *r = &out[n + ix];
+            if (r->seq == from_seq + ix && r->check == record_check(r)) {
+                out[kept++] = *r;
+            }
+        }
+        n = kept;
+        from_seq += run;
+    }
+
+    return n;
+}
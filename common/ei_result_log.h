@@ -0,0 +1,122 @@
+/* Append-only log of compact inference results in a reserved flash region,
+ * organised as a ring of erase pages. Records are collected in RAM and
+ * programmed a batch at a time (or on ei_result_log_flush), every page is
+ * erased once per trip around the ring, and the oldest page is dropped when
+ * the ring is full. The state is recovered from the page headers at init, so
+ * the log survives resets; only records not programmed yet are lost. Records
+ * are read back by sequence number, in bulk, e.g. everything newer than what
+ * a central has already downloaded.
+ *
+ * Storage is accessed through ei_log_storage_t. Backends are provided for TI
+ * NVS (ei_result_log_nvs.c) and for a file on a host (ei_result_log_file.c).
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_RESULT_LOG_H
+#define EI_RESULT_LOG_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defines ----------------------------------------------------------------- */
+#define EI_RESULT_LOG_MAGIC         0x474C4945  // "EILG"
+#define EI_RESULT_LOG_NO_SEQ        0xFFFFFFFF
+
+/* Types ------------------------------------------------------------------- */
+
+/**
+ * Flash region used by the log. Erased bytes read 0xFF, write only has to
+ * program erased bytes. Callbacks return 0 on success.
+ */
+typedef struct {
+    uint32_t size;              // region size in bytes, a multiple of page_size
+    uint32_t page_size;         // erase unit
+    int (*read)(void *ctx, uint32_t offset, void *buf, size_t len);
+    int (*write)(void *ctx, uint32_t offset, const void *buf, size_t len);
+    int (*erase)(void *ctx, uint32_t offset, size_t len);
+    void *ctx;
+} ei_log_storage_t;
+
+/** One stored result, 16 bytes */
+typedef struct {
+    uint32_t seq;               // set by ei_result_log_append
+    uint32_t timestamp_ms;
+    uint16_t score;             // top score * 10000
+    uint8_t label;              // index of the top label
+    uint8_t check;              // set by ei_result_log_append
+    uint16_t dsp_ms;
+    uint16_t classification_ms;
+} ei_result_record_t;
+
+/** First slot of every page */
+typedef struct {
+    uint32_t magic;
+    uint32_t page_seq;          // incremented for every page opened
+    uint32_t first_seq;         // seq of the first record of the page
+    uint16_t record_size;
+    uint16_t check;
+} ei_result_log_page_header_t;
+
+typedef struct {
+    const ei_log_storage_t *storage;
+    ei_result_record_t *pending;    // records not programmed yet
+    uint32_t batch_records;     // capacity of pending
+    uint32_t n_pages;
+    uint32_t records_per_page;
+
+    uint32_t head_page;         // page being filled
+    uint32_t head_page_seq;
+    uint32_t head_first_seq;
+    uint32_t head_count;        // records in the head page, including pending ones
+    uint32_t flushed_count;     // records of the head page already programmed
+
+    uint32_t oldest_seq;        // first record still stored
+    uint32_t next_seq;          // seq of the next appended record
+
+    uint32_t flushes;
+    uint32_t pages_erased;
+    uint32_t storage_errors;
+} ei_result_log_t;
+
+/* Function prototypes ----------------------------------------------------- */
+int ei_result_log_init(ei_result_log_t *log, const ei_log_storage_t *storage,
+                       ei_result_record_t *batch, uint32_t batch_records);
+int ei_result_log_format(ei_result_log_t *log);
+int ei_result_log_append(ei_result_log_t *log, const ei_result_record_t *record);
+int ei_result_log_flush(ei_result_log_t *log);
+size_t ei_result_log_read(ei_result_log_t *log, uint32_t from_seq, ei_result_record_t *out, size_t max_records);
+
+/* Storage backends -------------------------------------------------------- */
+int ei_result_log_nvs_open(ei_log_storage_t *storage, unsigned int nvs_index);
+int ei_result_log_file_open(ei_log_storage_t *storage, const char *path, uint32_t size, uint32_t page_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+/* File backed ei_log_storage_t, for running and testing the result log on a
+ * host. Programming behaves like NOR flash: bits can only be cleared, erase
+ * sets them again.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include "ei_result_log.h"
+
+/* Private functions ------------------------------------------------------- */
+static int file_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    FILE *f = (FILE *)ctx;
+
+    if (fseek(f, (long)offset, SEEK_SET) != 0 || fread(buf, 1, len, f) != len) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int file_write(void *ctx, uint32_t offset, const void *buf, size_t len)
+{
+    FILE *f = (FILE *)ctx;
+    const uint8_t *in = (const uint8_t *)buf;
+    uint8_t block[64];
+
+    for (size_t done = 0; done < len; ) {
+        size_t n = (len - done < sizeof(block)) ? len - done : sizeof(block);
+        if (file_read(ctx, offset + (uint32_t)done, block, n) != 0) {
+            return -1;
+        }
+        for (size_t ix = 0; ix < n; ix++) {
+            block[ix] &= in[done + ix];
+        }
+        if (fseek(f, (long)(offset + done), SEEK_SET) != 0 || fwrite(block, 1, n, f) != n) {
+            return -1;
+        }
+        done += n;
+    }
+
+    return fflush(f);
+}
+
+static int file_erase(void *ctx, uint32_t offset, size_t len)
+{
+    FILE *f = (FILE *)ctx;
+    uint8_t block[64];
+
+    memset(block, 0xFF, sizeof(block));
+    if (fseek(f, (long)offset, SEEK_SET) != 0) {
+        return -1;
+    }
+    for (size_t done = 0; done < len; ) {
+        size_t n = (len - done < sizeof(block)) ? len - done : sizeof(block);
+        if (fwrite(block, 1, n, f) != n) {
+            return -1;
+        }
+        done += n;
+    }
+
+    return fflush(f);
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Use a file as flash region, it is created erased if it does not exist
+ *
+ * @return int, 0 => OK
+ */
+int ei_result_log_file_open(ei_log_storage_t *storage, const char *path, uint32_t size, uint32_t page_size)
+{
+    FILE *f = fopen(path, "r+b");
+
+    if (f == NULL) {
+        f = fopen(path, "w+b");
+        if (f == NULL) {
+            return -1;
+        }
+        if (file_erase(f, 0, size) != 0) {
+            fclose(f);
+            return -1;
+        }
+    }
+
+    storage->size = size;
+    storage->page_size = page_size;
+    storage->read = file_read;
+    storage->write = file_write;
+    storage->erase = file_erase;
+    storage->ctx = f;
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/* TI NVS backed ei_log_storage_t. The log uses a whole NVS region, which must
+ * not be shared with anything else (e.g. not CONFIG_NVSINTERNAL of the BLE stack).
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include "ei_result_log.h"
+
+#include <ti/drivers/NVS.h>
+
+/* Private functions ------------------------------------------------------- */
+static int nvs_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    return (NVS_read((NVS_Handle)ctx, offset, buf, len) == NVS_STATUS_SUCCESS) ? 0 : -1;
+}
+
+static int nvs_write(void *ctx, uint32_t offset, const void *buf, size_t len)
+{
+    return (NVS_write((NVS_Handle)ctx, offset, (void *)buf, len, NVS_WRITE_POST_VERIFY) == NVS_STATUS_SUCCESS) ? 0 : -1;
+}
+
+static int nvs_erase(void *ctx, uint32_t offset, size_t len)
+{
+    return (NVS_erase((NVS_Handle)ctx, offset, len) == NVS_STATUS_SUCCESS) ? 0 : -1;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Use an NVS region as flash region, pages are the NVS sectors
+ *
+ * @param nvs_index e.g. CONFIG_NVS_EI_LOG from ti_drivers_config.h
+ *
+ * @return int, 0 => OK
+ */
+int ei_result_log_nvs_open(ei_log_storage_t *storage, unsigned int nvs_index)
+{
+    NVS_Params params;
+    NVS_Attrs attrs;
+
+    NVS_init();
+    NVS_Params_init(&params);
+    NVS_Handle handle = NVS_open(nvs_index, &params);
+    if (handle == NULL) {
+        return -1;
+    }
+    NVS_getAttrs(handle, &attrs);
+
+    storage->size = (uint32_t)attrs.regionSize;
+    storage->page_size = (uint32_t)attrs.sectorSize;
+    storage->read = nvs_read;
+    storage->write = nvs_write;
+    storage->erase = nvs_erase;
+    storage->ctx = handle;
+
+    return 0;
+}
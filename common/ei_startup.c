@@ -0,0 +1,95 @@
+/* Startup timestamps. See ei_startup.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stddef.h>
+
+#include "ei_startup.h"
+
+/* Private variables ------------------------------------------------------- */
+static uint64_t (*startup_now_us)(void) = NULL;
+static uint64_t marks_us[EI_STARTUP_N_EVENTS];
+static bool marked[EI_STARTUP_N_EVENTS];
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Clear all marks and mark EI_STARTUP_BEGIN. Marks made before this
+ * call are ignored.
+ *
+ * @param now_us clock in us since boot, e.g. Clock_getTicks() * Clock_tickPeriod
+ */
+void ei_startup_begin(uint64_t (*now_us)(void))
+{
+    for (int ix = 0; ix < EI_STARTUP_N_EVENTS; ix++) {
+        marked[ix] = false;
+    }
+    startup_now_us = now_us;
+    ei_startup_mark(EI_STARTUP_BEGIN);
+}
+
+/**
+ * @brief Record the time of an event, if it has not been marked yet
+ */
+void ei_startup_mark(ei_startup_event_t event)
+{
+    if (startup_now_us == NULL || (unsigned)event >= EI_STARTUP_N_EVENTS || marked[event]) {
+        return;
+    }
+    marks_us[event] = startup_now_us();
+    marked[event] = true;
+}
+
+/**
+ * @brief Time of an event since boot
+ *
+ * @return int, 0 => OK, -1 if it has not happened yet
+ */
+int ei_startup_get_us(ei_startup_event_t event, uint64_t *us)
+{
+    if ((unsigned)event >= EI_STARTUP_N_EVENTS || !marked[event]) {
+        return -1;
+    }
+    *us = marks_us[event];
+    return 0;
+}
+
+/**
+ * @brief All events have been marked
+ */
+bool ei_startup_complete(void)
+{
+    for (int ix = 0; ix < EI_STARTUP_N_EVENTS; ix++) {
+        if (!marked[ix]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char *ei_startup_event_name(ei_startup_event_t event)
+{
+    static const char *names[EI_STARTUP_N_EVENTS] = { "init", "first sample", "classifier ready", "first result" };
+
+    return ((unsigned)event < EI_STARTUP_N_EVENTS) ? names[event] : "?";
+}
@@ -0,0 +1,61 @@
+/* Startup timestamps. Marks when the application started initializing, when
+ * the sensor captured its first sample, when the classifier was ready and when
+ * the first result was out, against a clock that starts at boot, so cold start
+ * and wake up times can be measured on target and in the host simulation.
+ * There is a single set of marks, so drivers and the application can mark
+ * events without sharing state; the first mark of an event counts.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_STARTUP_H
+#define EI_STARTUP_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Types ------------------------------------------------------------------- */
+
+typedef enum {
+    EI_STARTUP_BEGIN = 0,           // ei_startup_begin, start of the application init
+    EI_STARTUP_FIRST_SAMPLE,        // the sensor started capturing
+    EI_STARTUP_CLASSIFIER_READY,
+    EI_STARTUP_FIRST_RESULT,
+    EI_STARTUP_N_EVENTS
+} ei_startup_event_t;
+
+/* Function prototypes ----------------------------------------------------- */
+void ei_startup_begin(uint64_t (*now_us)(void));
+void ei_startup_mark(ei_startup_event_t event);
+int ei_startup_get_us(ei_startup_event_t event, uint64_t *us);
+bool ei_startup_complete(void);
+const char *ei_startup_event_name(ei_startup_event_t event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
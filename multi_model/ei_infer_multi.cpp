@@ -0,0 +1,306 @@
+/* A minimal example running an audio (keyword spotting) impulse and a motion
+ * (accelerometer) impulse on the same device, using the deadline scheduler in
+ * ei_scheduler.c. This file replaces ei_infer_minimal.cpp and
+ * ei_infer_minimal_audio.cpp: copy it together with the microphone and IMU
+ * drivers from the voice_recognition and ble_accelerometer examples.
+ *
+ * This example is provided for documentation purposes, has minimal testing, and
+ * may not include the latest optimizations utilized by the fully supported Edge
+ * Impulse firmware. For reference, see ei_run_impulse.cpp on github:
+ * https://github.com/edgeimpulse/firmware-ti-launchxl/blob/main/
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stdarg.h>
+#include <stdio.h>
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "ei_microphone_minimal_audio.h"
+#include "ei_scheduler.h"
+
+extern "C" {
+#include "ei_imu_minimal.h"
+}
+
+/// TI Drivers used for inferencing: timing and serial output
+#include <ti/drivers/UART2.h>
+#include "ti/drivers/Timer.h"
+#include "ti_drivers_config.h"
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <unistd.h>
+
+/*
+ * Both impulses must be exported from Edge Impulse as a single multi-impulse
+ * library, which gives every impulse its own set of symbols. Map the entry
+ * points and sizes of each impulse here, via Predefined Symbols. The defaults
+ * let this file build against a single exported impulse for bring-up.
+ */
+#ifndef EI_MOTION_RUN_CLASSIFIER
+#define EI_MOTION_RUN_CLASSIFIER            run_classifier
+#endif
+
+#ifndef EI_MOTION_RUN_CLASSIFIER_INIT
+#define EI_MOTION_RUN_CLASSIFIER_INIT       run_classifier_init
+#endif
+
+#ifndef EI_MOTION_RAW_SAMPLE_COUNT
+#define EI_MOTION_RAW_SAMPLE_COUNT          EI_CLASSIFIER_RAW_SAMPLE_COUNT
+#endif
+
+#ifndef EI_MOTION_FRAME_SIZE
+#define EI_MOTION_FRAME_SIZE                EI_CLASSIFIER_NN_INPUT_FRAME_SIZE
+#endif
+
+#ifndef EI_MOTION_INTERVAL_MS
+#define EI_MOTION_INTERVAL_MS               EI_CLASSIFIER_INTERVAL_MS
+#endif
+
+#ifndef EI_MOTION_LABEL_COUNT
+#define EI_MOTION_LABEL_COUNT               EI_CLASSIFIER_LABEL_COUNT
+#endif
+
+#ifndef EI_AUDIO_RUN_CLASSIFIER_CONTINUOUS
+#define EI_AUDIO_RUN_CLASSIFIER_CONTINUOUS  run_classifier_continuous
+#endif
+
+#ifndef EI_AUDIO_RUN_CLASSIFIER_INIT
+#define EI_AUDIO_RUN_CLASSIFIER_INIT        run_classifier_init
+#endif
+
+#ifndef EI_AUDIO_SLICE_SIZE
+#define EI_AUDIO_SLICE_SIZE                 EI_CLASSIFIER_SLICE_SIZE
+#endif
+
+#ifndef EI_AUDIO_FREQUENCY
+#define EI_AUDIO_FREQUENCY                  EI_CLASSIFIER_FREQUENCY
+#endif
+
+#ifndef EI_AUDIO_LABEL_COUNT
+#define EI_AUDIO_LABEL_COUNT                EI_CLASSIFIER_LABEL_COUNT
+#endif
+
+/* The audio slice must be classified before the next one completes */
+#define EI_AUDIO_DEADLINE_MS                ((EI_AUDIO_SLICE_SIZE * 1000) / EI_AUDIO_FREQUENCY)
+/* A motion window is acquired over its full duration, classify it before the next one */
+#define EI_MOTION_DEADLINE_MS               (EI_MOTION_RAW_SAMPLE_COUNT * EI_MOTION_INTERVAL_MS)
+
+/// state for timing and serial output
+static UART2_Handle uart = NULL;
+static Timer_Handle timer_handle = NULL;
+static uint64_t timer_count = 0;
+
+static float motion_data[EI_MOTION_FRAME_SIZE];
+
+/// private function prototypes
+void timer_Callback(Timer_Handle _myHandle, int_fast16_t _status);
+
+static void print_result(const char *name, ei_impulse_result_t *result, size_t label_count)
+{
+    // print the predictions, but only if valid labels are present
+    if (result->label_detected) {
+        ei_printf("\r\n%s predictions (DSP: %d ms., Classification: %d ms., Anomaly: %d ms.): \r\n",
+            name, result->timing.dsp, result->timing.classification, result->timing.anomaly);
+        for (size_t ix = 0; ix < label_count; ix++) {
+            ei_printf("    %s: \t", result->classification[ix].label);
+            // printing floating point
+            ei_printf("%d%%", (int32_t) (result->classification[ix].value * 100.0));
+            ei_printf("\r\n");
+        }
+    }
+}
+
+/* Scheduler callbacks ----------------------------------------------------- */
+static int audio_acquire(void *ctx)
+{
+    return ei_microphone_inference_record() ? 0 : -1;
+}
+
+static int audio_infer(void *ctx)
+{
+    signal_t signal;
+    signal.total_length = EI_AUDIO_SLICE_SIZE;
+    signal.get_data = &ei_microphone_audio_signal_get_data;
+    ei_impulse_result_t result = {0};
+
+    EI_IMPULSE_ERROR r = EI_AUDIO_RUN_CLASSIFIER_CONTINUOUS(&signal, &result, false);
+    if (r != EI_IMPULSE_OK) {
+        ei_printf("ERR: Failed to run audio classifier (%d)\r\n", r);
+        return -1;
+    }
+    print_result("audio", &result, EI_AUDIO_LABEL_COUNT);
+
+    return 0;
+}
+
+static int motion_acquire(void *ctx)
+{
+    return imu_fill_window(motion_data, EI_MOTION_FRAME_SIZE, EI_MOTION_INTERVAL_MS);
+}
+
+static int motion_infer(void *ctx)
+{
+    signal_t signal;
+    numpy::signal_from_buffer(motion_data, EI_MOTION_FRAME_SIZE, &signal);
+    ei_impulse_result_t result = {0};
+
+    EI_IMPULSE_ERROR r = EI_MOTION_RUN_CLASSIFIER(&signal, &result, false);
+    if (r != EI_IMPULSE_OK) {
+        ei_printf("ERR: Failed to run motion classifier (%d)\r\n", r);
+        return -1;
+    }
+    print_result("motion", &result, EI_MOTION_LABEL_COUNT);
+
+    return 0;
+}
+
+/*
+ * @brief Initialize peripherals, both acquisition pipelines, and the SDK. Run this exactly once
+ */
+void ei_init(void) {
+    // Setup up UART2 as target for ei_print functions
+    UART2_Params uartParams;
+    UART2_Params_init(&uartParams);
+    uartParams.baudRate = 115200;
+    uartParams.readMode = UART2_Mode_NONBLOCKING;
+    uart = UART2_open(CONFIG_UART2_0, &uartParams);
+
+    // Setup TIMER0 for measuring edge-impulse-sdk performance and scheduler deadlines
+    Timer_Params timer_params;
+    Timer_init();
+    Timer_Params_init(&timer_params);
+    timer_params.period = 1000;
+    timer_params.periodUnits = Timer_PERIOD_US;
+    timer_params.timerMode = Timer_CONTINUOUS_CALLBACK;
+    timer_params.timerCallback = timer_Callback;
+    timer_handle = Timer_open(CONFIG_TIMER_0, &timer_params);
+    Timer_start(timer_handle);
+
+    // edge-impulse-sdk initialization, once per impulse: each has its own
+    // continuous and moving average state. With a single exported impulse both
+    // map to run_classifier_init, which only resets that state again.
+    EI_AUDIO_RUN_CLASSIFIER_INIT();
+    EI_MOTION_RUN_CLASSIFIER_INIT();
+
+    if (imu_init()) {
+        ei_printf("ERR: Failed to initialize IMU\r\n");
+        while(1);
+    }
+    if (ei_microphone_init()) {
+        ei_printf("ERR: Failed to initialize microphone\r\n");
+        while(1);
+    }
+    ei_microphone_inference_start(EI_AUDIO_SLICE_SIZE);
+}
+
+/*
+ *  ======== mainThread example: audio and motion inferencing ========
+ */
+extern "C" void *mainThread(void *arg0)
+{
+    ei_init();
+
+    ei_sched_model_t audio = { 0 };
+    audio.name = "audio";
+    audio.deadline_ms = EI_AUDIO_DEADLINE_MS;
+    audio.period_ms = EI_AUDIO_DEADLINE_MS;
+    audio.priority = 1;
+    audio.acquire = audio_acquire;
+    audio.infer = audio_infer;
+
+    ei_sched_model_t motion = { 0 };
+    motion.name = "motion";
+    motion.deadline_ms = EI_MOTION_DEADLINE_MS;
+    motion.period_ms = EI_MOTION_DEADLINE_MS;
+    motion.priority = 0;
+    motion.acquire = motion_acquire;
+    motion.infer = motion_infer;
+
+    if (ei_sched_add_model(&audio) < 0 || ei_sched_add_model(&motion) < 0
+        || ei_sched_start()) {
+        ei_printf("ERR: Failed to start scheduler\r\n");
+        while(1);
+    }
+
+    while(1) {
+        sleep(10);
+        ei_sched_print_stats();
+    }
+}
+
+/*
+ * Workaround for usleep missing from some TIRTOS builds, even if posix is enabled
+ */
+__attribute__((weak)) extern "C" int usleep(useconds_t us) {
+    Task_sleep(1 / Clock_tickPeriod);
+    return 0;
+}
+
+/**
+ * @brief Get current time in ms.
+ *
+ * This method is referenced in the TI porting layer
+ * of the edge impulse SDK, and provides a simple interface to give hardware timing
+ * resources to the SDK for benchmarking purposes. The scheduler uses the same
+ * clock for release times and deadlines.
+ */
+extern "C" uint64_t Timer_getMs(void)
+{
+    return timer_count;
+}
+
+/**
+ * @brief Called by CONFIG_TIMER_0 interrupt to support `Timer_getMs`. Usage defined
+ * in `ei_init`
+ */
+void timer_Callback(Timer_Handle _myHandle, int_fast16_t _status)
+{
+    timer_count++;
+}
+
+/**
+ * @brief Allow edge impulse to write serial output, configured to output over UART2.
+ *
+ * @param string
+ * @param length
+ */
+extern "C" void Serial_Out(char *string, int length)
+{
+    size_t bytes_written;
+    UART2_write(uart, string, length, &bytes_written);
+}
+
+/**
+ * @brief printf for ei_scheduler.c. The SDK declares ei_printf with C++ linkage
+ * unless EI_C_LINKAGE=1, so C code cannot call it directly.
+ */
+extern "C" void Serial_Printf(const char *format, ...)
+{
+    char buf[256];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    ei_printf("%s", buf);
+}
@@ -0,0 +1,329 @@
+/* Deadline based scheduler for running more than one Edge Impulse model
+ * on a single device. See ei_scheduler.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#include "ei_scheduler.h"
+
+/*
+ * Implemented by the application, see ei_infer_multi.cpp. The SDK declares
+ * ei_read_timer_ms and ei_printf with C++ linkage unless EI_C_LINKAGE=1.
+ */
+extern uint64_t Timer_getMs(void);
+extern void Serial_Printf(const char *format, ...);
+
+/* Thread priorities, only used where the POSIX layer honours them (TI-RTOS) */
+#ifndef EI_SCHED_ACQ_PRIORITY
+#define EI_SCHED_ACQ_PRIORITY           2
+#endif
+
+#ifndef EI_SCHED_EXEC_PRIORITY
+#define EI_SCHED_EXEC_PRIORITY          1
+#endif
+
+/** Scheduler bookkeeping for one model */
+typedef struct {
+    ei_sched_model_t model;
+    ei_sched_stats_t stats;
+    pthread_t acq_thread;
+    bool pending;               // acquired, waiting for the executor
+    bool busy;                  // executor is running inference on it
+    uint64_t release_ms;
+    uint64_t deadline_abs_ms;
+} sched_slot_t;
+
+/* Private variables ------------------------------------------------------- */
+static sched_slot_t slots[EI_SCHED_MAX_MODELS];
+static int n_models = 0;
+static int n_acq_threads = 0;           // acquisition threads created by ei_sched_start
+
+static pthread_mutex_t sched_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t job_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t job_done = PTHREAD_COND_INITIALIZER;
+static pthread_t exec_thread;
+static volatile bool running = false;
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief Pick the pending job with the earliest absolute deadline, ties go to
+ * the model with the higher priority. Must be called with sched_lock held.
+ *
+ * @return index of the slot, or -1 if nothing is pending
+ */
+static int next_job(void)
+{
+    int best = -1;
+
+    for (int ix = 0; ix < n_models; ix++) {
+        if (!slots[ix].pending) {
+            continue;
+        }
+        if (best < 0
+            || slots[ix].deadline_abs_ms < slots[best].deadline_abs_ms
+            || (slots[ix].deadline_abs_ms == slots[best].deadline_abs_ms
+                && slots[ix].model.priority > slots[best].model.priority)) {
+            best = ix;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Wait one period of the model after a failed acquire, so a sensor that
+ * keeps failing does not spin the acquisition thread. Must be called with
+ * sched_lock held; ei_sched_stop ends the wait.
+ */
+static void acquire_backoff(sched_slot_t *slot)
+{
+    uint32_t period_ms = slot->model.period_ms ? slot->model.period_ms : slot->model.deadline_ms;
+    struct timespec until;
+
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += period_ms / 1000;
+    until.tv_nsec += (long)(period_ms % 1000) * 1000000L;
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+
+    // job_done is also signalled for the other models, wait out the whole period
+    int r = 0;
+    while (running && r == 0) {
+        r = pthread_cond_timedwait(&job_done, &sched_lock, &until);
+    }
+}
+
+/**
+ * @brief One acquisition thread per model. The thread does not call acquire
+ * again until the previous job has been run, so the acquisition buffer is never
+ * written while the executor is reading it.
+ */
+static void *acquisition_thread(void *arg0)
+{
+    sched_slot_t *slot = (sched_slot_t *)arg0;
+
+    while (running) {
+        int r = slot->model.acquire(slot->model.ctx);
+
+        pthread_mutex_lock(&sched_lock);
+        if (r != 0) {
+            slot->stats.errors++;
+            acquire_backoff(slot);
+        } else {
+            slot->release_ms = Timer_getMs();
+            slot->deadline_abs_ms = slot->release_ms + slot->model.deadline_ms;
+            slot->pending = true;
+            slot->stats.released++;
+            pthread_cond_signal(&job_ready);
+        }
+
+        while (running && (slot->pending || slot->busy)) {
+            pthread_cond_wait(&job_done, &sched_lock);
+        }
+        pthread_mutex_unlock(&sched_lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Single executor, non-preemptive earliest deadline first. Only one
+ * model runs at a time, which is what allows the models to share one arena.
+ */
+static void *executor_thread(void *arg0)
+{
+    pthread_mutex_lock(&sched_lock);
+    while (running) {
+        int ix = next_job();
+        if (ix < 0) {
+            pthread_cond_wait(&job_ready, &sched_lock);
+            continue;
+        }
+
+        sched_slot_t *slot = &slots[ix];
+        slot->pending = false;
+        slot->busy = true;
+        pthread_mutex_unlock(&sched_lock);
+
+        int r = slot->model.infer(slot->model.ctx);
+        uint64_t done_ms = Timer_getMs();
+
+        pthread_mutex_lock(&sched_lock);
+        uint32_t latency = (uint32_t)(done_ms - slot->release_ms);
+        slot->stats.last_latency_ms = latency;
+        if (latency > slot->stats.worst_latency_ms) {
+            slot->stats.worst_latency_ms = latency;
+        }
+        if (r != 0) {
+            slot->stats.errors++;
+        } else {
+            slot->stats.completed++;
+        }
+        if (done_ms > slot->deadline_abs_ms) {
+            slot->stats.missed++;
+        }
+        slot->busy = false;
+        pthread_cond_broadcast(&job_done);
+    }
+    pthread_mutex_unlock(&sched_lock);
+
+    return NULL;
+}
+
+static int create_thread(pthread_t *thread, void *(*fn)(void *), void *arg, int priority, size_t stack_size)
+{
+    pthread_attr_t attrs;
+    struct sched_param pri_param;
+
+#ifdef PTHREAD_STACK_MIN
+    // host builds have a much larger minimum stack than TI-RTOS
+    if (stack_size < PTHREAD_STACK_MIN) {
+        stack_size = PTHREAD_STACK_MIN;
+    }
+#endif
+
+    pthread_attr_init(&attrs);
+    pri_param.sched_priority = priority;
+    pthread_attr_setschedparam(&attrs, &pri_param);
+    pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_JOINABLE);
+    if (pthread_attr_setstacksize(&attrs, stack_size) != 0) {
+        pthread_attr_destroy(&attrs);
+        return -1;
+    }
+
+    int r = pthread_create(thread, &attrs, fn, arg);
+    pthread_attr_destroy(&attrs);
+
+    return (r == 0) ? 0 : -1;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Register a model with the scheduler. Must be called before ei_sched_start
+ *
+ * @return index of the model for ei_sched_get_stats, or -1 on error
+ */
+int ei_sched_add_model(const ei_sched_model_t *model)
+{
+    if (running || n_models >= EI_SCHED_MAX_MODELS
+        || model->acquire == NULL || model->infer == NULL) {
+        return -1;
+    }
+
+    memset(&slots[n_models], 0, sizeof(sched_slot_t));
+    slots[n_models].model = *model;
+
+    return n_models++;
+}
+
+/**
+ * @brief Start the executor and one acquisition thread per registered model
+ *
+ * @return int, 0 => OK
+ */
+int ei_sched_start(void)
+{
+    if (running || n_models == 0) {
+        return -1;
+    }
+    running = true;
+    n_acq_threads = 0;
+
+    if (create_thread(&exec_thread, executor_thread, NULL,
+                      EI_SCHED_EXEC_PRIORITY, EI_SCHED_EXEC_STACK_SIZE)) {
+        running = false;
+        return -1;
+    }
+
+    for (int ix = 0; ix < n_models; ix++) {
+        if (create_thread(&slots[ix].acq_thread, acquisition_thread, &slots[ix],
+                          EI_SCHED_ACQ_PRIORITY, EI_SCHED_ACQ_STACK_SIZE)) {
+            ei_sched_stop();
+            return -1;
+        }
+        n_acq_threads++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Stop scheduling. The executor is joined; acquisition threads exit the
+ * next time their acquire call returns, so they are detached rather than joined.
+ */
+void ei_sched_stop(void)
+{
+    pthread_mutex_lock(&sched_lock);
+    if (!running) {
+        pthread_mutex_unlock(&sched_lock);
+        return;
+    }
+    running = false;
+    pthread_cond_broadcast(&job_ready);
+    pthread_cond_broadcast(&job_done);
+    pthread_mutex_unlock(&sched_lock);
+
+    pthread_join(exec_thread, NULL);
+    for (int ix = 0; ix < n_acq_threads; ix++) {
+        pthread_detach(slots[ix].acq_thread);
+    }
+    n_acq_threads = 0;
+}
+
+/**
+ * @brief Copy the accounting of one model
+ *
+ * @return int, 0 => OK
+ */
+int ei_sched_get_stats(int model_idx, ei_sched_stats_t *stats)
+{
+    if (model_idx < 0 || model_idx >= n_models) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sched_lock);
+    *stats = slots[model_idx].stats;
+    pthread_mutex_unlock(&sched_lock);
+
+    return 0;
+}
+
+void ei_sched_print_stats(void)
+{
+    for (int ix = 0; ix < n_models; ix++) {
+        ei_sched_stats_t s;
+        ei_sched_get_stats(ix, &s);
+        Serial_Printf("%s: released %u, completed %u, missed %u, errors %u, latency %u ms (worst %u ms)\r\n",
+            slots[ix].model.name, (unsigned)s.released, (unsigned)s.completed,
+            (unsigned)s.missed, (unsigned)s.errors,
+            (unsigned)s.last_latency_ms, (unsigned)s.worst_latency_ms);
+    }
+}
@@ -0,0 +1,96 @@
+/* Deadline based scheduler for running more than one Edge Impulse model
+ * on a single device. Each model owns an acquisition thread that blocks on
+ * its sensor, and a single executor thread runs inference jobs one at a time,
+ * earliest deadline first. Because only one model is ever executing, the
+ * models time-multiplex the same tensor arena / heap region.
+ *
+ * The scheduler only relies on POSIX threads, so the same source runs on
+ * TI-RTOS (through the SimpleLink POSIX layer) and on a Linux host.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_SCHEDULER_H
+#define EI_SCHEDULER_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defines ----------------------------------------------------------------- */
+#ifndef EI_SCHED_MAX_MODELS
+#define EI_SCHED_MAX_MODELS             2
+#endif
+
+#ifndef EI_SCHED_ACQ_STACK_SIZE
+#define EI_SCHED_ACQ_STACK_SIZE         2048
+#endif
+
+#ifndef EI_SCHED_EXEC_STACK_SIZE
+#define EI_SCHED_EXEC_STACK_SIZE        4096
+#endif
+
+/* Types ------------------------------------------------------------------- */
+
+/** Description of one model managed by the scheduler */
+typedef struct {
+    const char *name;
+    /** relative deadline, from the moment acquire() returns, in ms */
+    uint32_t deadline_ms;
+    /** tie breaker between jobs with the same deadline, higher runs first */
+    uint8_t priority;
+    /** time between two buffers of the sensor in ms, a failed acquire is retried
+     * after this long; 0 => deadline_ms */
+    uint32_t period_ms;
+    /** blocks until a new buffer is ready for inference, returns 0 => OK */
+    int (*acquire)(void *ctx);
+    /** runs inference on the buffer produced by acquire, returns 0 => OK */
+    int (*infer)(void *ctx);
+    void *ctx;
+} ei_sched_model_t;
+
+/** Per model accounting, all times in ms */
+typedef struct {
+    uint32_t released;
+    uint32_t completed;
+    uint32_t missed;            // finished after the deadline
+    uint32_t errors;
+    uint32_t last_latency_ms;   // release to completion
+    uint32_t worst_latency_ms;
+} ei_sched_stats_t;
+
+/* Function prototypes ----------------------------------------------------- */
+int ei_sched_add_model(const ei_sched_model_t *model);
+int ei_sched_start(void);
+void ei_sched_stop(void);
+int ei_sched_get_stats(int model_idx, ei_sched_stats_t *stats);
+void ei_sched_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
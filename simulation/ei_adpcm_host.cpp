@@ -0,0 +1,400 @@
+/* Host side of ei_adpcm.c. Without in=, benchmarks the encoder on synthetic
+ * 16 kHz signals: throughput, SNR after decoding, bit rate, that decoding
+ * resumes exactly after lost packets, and that packets are found again in a
+ * stream mixed with text. With in=, decodes a capture of UART2 (packets of
+ * EI_AUDIO_ADPCM, possibly mixed with text output) into a WAV file.
+ *
+ * Options, as name=value:
+ *  seconds=10        of every benchmark signal
+ *  packet=256        samples per packet
+ *  slice=4000        samples passed to the encoder per call, as per I2S slice
+ *  loss=10           drop every loss-th packet in the resume test
+ *  in=               capture to decode
+ *  out=decoded.wav   decoded audio, one file per stream id: decoded_<id>.wav
+ *  rate=16000        sample rate written to the WAV header
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "ei_adpcm.h"
+
+#define BENCH_RATE      16000
+#define UART_BYTES_S    11520.0     // 115200 baud, 8N1
+
+typedef struct {
+    uint32_t seconds;
+    uint32_t packet;
+    uint32_t slice;
+    uint32_t loss;
+    uint32_t rate;
+    const char *in;
+    const char *out;
+} host_options_t;
+
+/* Private variables ------------------------------------------------------- */
+static host_options_t options = { 10, 256, 4000, 10, 16000, NULL, "decoded.wav" };
+static std::vector<uint8_t> *sink = NULL;
+
+/* Private functions ------------------------------------------------------- */
+
+static void sink_write(const void *data, size_t len)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    sink->insert(sink->end(), bytes, bytes + len);
+}
+
+static int16_t clip16(double v)
+{
+    return (int16_t)(v > 32767.0 ? 32767.0 : (v < -32768.0 ? -32768.0 : v));
+}
+
+/**
+ * @brief Synthetic test signals, 0: tone, 1: chirp, 2: voiced speech-like,
+ * 3: white noise, 4: quiet tone
+ */
+static const char *make_signal(int kind, std::vector<int16_t> &x)
+{
+    uint32_t lcg = 12345;
+    double phase = 0.0;
+
+    for (size_t n = 0; n < x.size(); n++) {
+        double t = (double)n / BENCH_RATE;
+        double v = 0.0;
+        switch (kind) {
+        case 0:
+            v = 16384.0 * sin(2 * M_PI * 440.0 * t);
+            break;
+        case 1: {
+            // 50 Hz to 7 kHz and back every 4 s
+            double sweep = fmod(t, 4.0) / 2.0;
+            double f = 50.0 + 6950.0 * (sweep < 1.0 ? sweep : 2.0 - sweep);
+            phase += 2 * M_PI * f / BENCH_RATE;
+            v = 16384.0 * sin(phase);
+            break;
+        }
+        case 2: {
+            // harmonics of a gliding pitch under formant-like weights, 4 syllables per second
+            double f0 = 120.0 + 60.0 * sin(2 * M_PI * 0.7 * t);
+            double env = 0.5 - 0.5 * cos(2 * M_PI * 4.0 * t);
+            phase += 2 * M_PI * f0 / BENCH_RATE;
+            for (int h = 1; h <= 30 && h * f0 < 7500.0; h++) {
+                double f = h * f0;
+                double w = 1.0 / (1.0 + pow((f - 500.0) / 200.0, 2)) + 0.6 / (1.0 + pow((f - 1500.0) / 300.0, 2))
+                         + 0.3 / (1.0 + pow((f - 2500.0) / 400.0, 2));
+                v += w * sin(h * phase);
+            }
+            v *= 6000.0 * env;
+            break;
+        }
+        case 3:
+            lcg = lcg * 1664525u + 1013904223u;
+            v = ((int32_t)(lcg >> 16) - 32768) * 0.1;
+            break;
+        default:
+            v = 164.0 * sin(2 * M_PI * 440.0 * t);
+            break;
+        }
+        x[n] = clip16(v);
+    }
+
+    static const char *names[] = { "tone 440 Hz -6 dBFS", "chirp 50-7000 Hz -6 dBFS", "voiced speech-like",
+                                   "white noise -20 dBFS", "tone 440 Hz -46 dBFS" };
+    return names[kind];
+}
+
+static void encode_all(const std::vector<int16_t> &x, std::vector<uint8_t> &out, uint8_t stream_id)
+{
+    ei_adpcm_encoder_t enc;
+    std::vector<uint8_t> packet(EI_ADPCM_PACKET_SIZE(options.packet));
+
+    out.clear();
+    sink = &out;
+    ei_adpcm_encoder_init(&enc, packet.data(), packet.size(), (uint16_t)options.packet, stream_id, sink_write);
+    for (size_t ix = 0; ix < x.size(); ix += options.slice) {
+        size_t n = (x.size() - ix < options.slice) ? x.size() - ix : options.slice;
+        ei_adpcm_encode(&enc, &x[ix], n);
+    }
+    ei_adpcm_flush(&enc);
+}
+
+/**
+ * @brief Decode every packet found in a byte stream, skipping anything else
+ *
+ * @return size_t bytes skipped
+ */
+static size_t decode_all(const std::vector<uint8_t> &in, std::vector<int16_t> &y,
+                         std::vector<ei_adpcm_packet_info_t> *infos)
+{
+    std::vector<int16_t> block(EI_ADPCM_MAX_PACKET_SAMPLES);
+    ei_adpcm_packet_info_t info;
+    size_t pos = 0;
+    size_t skipped = 0;
+
+    y.clear();
+    while (pos < in.size()) {
+        int r = ei_adpcm_decode_packet(&in[pos], in.size() - pos, &info, block.data(), block.size());
+        if (r > 0) {
+            y.insert(y.end(), block.begin(), block.begin() + info.n_samples);
+            if (infos != NULL) {
+                infos->push_back(info);
+            }
+            pos += (size_t)r;
+        } else if (r < 0) {
+            pos++;
+            skipped++;
+        } else {
+            skipped += in.size() - pos;
+            break;
+        }
+    }
+
+    return skipped;
+}
+
+static double snr_db(const std::vector<int16_t> &x, const std::vector<int16_t> &y)
+{
+    double signal = 0.0;
+    double noise = 0.0;
+
+    for (size_t n = 0; n < x.size() && n < y.size(); n++) {
+        double e = (double)x[n] - y[n];
+        signal += (double)x[n] * x[n];
+        noise += e * e;
+    }
+    return (noise > 0.0) ? 10.0 * log10(signal / noise) : INFINITY;
+}
+
+static void bench(void)
+{
+    std::vector<int16_t> x((size_t)options.seconds * BENCH_RATE);
+    std::vector<int16_t> y;
+    std::vector<uint8_t> coded;
+
+    printf("%u s per signal, %u samples per packet (%u bytes), %u samples per encoder call\n",
+        (unsigned)options.seconds, (unsigned)options.packet, (unsigned)EI_ADPCM_PACKET_SIZE(options.packet),
+        (unsigned)options.slice);
+    printf("%-26s %8s %10s %10s %10s %9s\n", "signal", "SNR dB", "enc ns/smp", "dec ns/smp", "kbit/s", "UART load");
+
+    for (int kind = 0; kind < 5; kind++) {
+        const char *name = make_signal(kind, x);
+        uint32_t passes = 0;
+        clock_t start = clock();
+        do {
+            encode_all(x, coded, 0);
+            passes++;
+        } while (clock() - start < CLOCKS_PER_SEC / 4);
+        double enc_ns = (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / ((double)passes * x.size());
+
+        passes = 0;
+        start = clock();
+        do {
+            decode_all(coded, y, NULL);
+            passes++;
+        } while (clock() - start < CLOCKS_PER_SEC / 4);
+        double dec_ns = (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / ((double)passes * x.size());
+
+        double bytes_per_s = (double)coded.size() / options.seconds;
+        printf("%-26s %8.1f %10.2f %10.2f %10.1f %8.0f%%\n", name, snr_db(x, y), enc_ns, dec_ns,
+            bytes_per_s * 8 / 1000.0, 100.0 * bytes_per_s / UART_BYTES_S);
+    }
+
+    // resume: drop packets, the survivors must decode exactly as without loss
+    std::vector<int16_t> y_loss;
+    std::vector<uint8_t> lossy;
+    std::vector<ei_adpcm_packet_info_t> infos;
+    size_t pos = 0;
+    uint32_t ix = 0;
+    uint32_t dropped = 0;
+
+    make_signal(2, x);
+    encode_all(x, coded, 1);
+    decode_all(coded, y, NULL);
+    while (pos < coded.size()) {
+        size_t size = EI_ADPCM_PACKET_SIZE(coded[pos + 4] | (coded[pos + 5] << 8));
+        if (options.loss == 0 || ++ix % options.loss != 0) {
+            lossy.insert(lossy.end(), coded.begin() + pos, coded.begin() + pos + size);
+        } else {
+            dropped++;
+        }
+        pos += size;
+    }
+    decode_all(lossy, y_loss, &infos);
+    size_t mismatches = 0;
+    size_t at = 0;
+    for (size_t p = 0; p < infos.size(); p++) {
+        size_t first = (size_t)infos[p].seq * options.packet;
+        for (uint16_t n = 0; n < infos[p].n_samples; n++) {
+            mismatches += (y_loss[at + n] != y[first + n]);
+        }
+        at += infos[p].n_samples;
+    }
+    printf("resume: %u of %u packets dropped, %u decoded, %u samples differ from the lossless decode\n",
+        (unsigned)dropped, (unsigned)(infos.size() + dropped), (unsigned)infos.size(), (unsigned)mismatches);
+
+    // resync: text between packets, as when sharing UART2 with the predictions
+    std::vector<uint8_t> mixed;
+    const char *text = "\r\nPredictions (DSP: 12 ms., Classification: 3 ms., Anomaly: 0 ms.): \r\n    noise: \t98%\r\n";
+    pos = 0;
+    ix = 0;
+    while (pos < coded.size()) {
+        size_t size = EI_ADPCM_PACKET_SIZE(coded[pos + 4] | (coded[pos + 5] << 8));
+        if (ix++ % 4 == 0) {
+            mixed.insert(mixed.end(), text, text + strlen(text));
+        }
+        mixed.insert(mixed.end(), coded.begin() + pos, coded.begin() + pos + size);
+        pos += size;
+    }
+    infos.clear();
+    size_t skipped = decode_all(mixed, y_loss, &infos);
+    printf("resync: %u of %u packets found among %u bytes of text, output %s\n", (unsigned)infos.size(), (unsigned)ix,
+        (unsigned)skipped, (y_loss == y) ? "identical" : "differs");
+}
+
+static void write_wav(const char *path, const std::vector<int16_t> &y, uint32_t rate)
+{
+    FILE *f = fopen(path, "wb");
+    uint32_t data_bytes = (uint32_t)(y.size() * 2);
+    uint8_t h[44];
+
+    if (f == NULL) {
+        printf("cannot write %s\n", path);
+        return;
+    }
+    memcpy(h, "RIFF", 4);
+    uint32_t v = 36 + data_bytes;
+    memcpy(h + 4, &v, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    v = 16;
+    memcpy(h + 16, &v, 4);
+    uint16_t s = 1;                 // PCM
+    memcpy(h + 20, &s, 2);
+    memcpy(h + 22, &s, 2);          // mono
+    memcpy(h + 24, &rate, 4);
+    v = rate * 2;
+    memcpy(h + 28, &v, 4);
+    s = 2;
+    memcpy(h + 32, &s, 2);
+    s = 16;
+    memcpy(h + 34, &s, 2);
+    memcpy(h + 36, "data", 4);
+    memcpy(h + 40, &data_bytes, 4);
+    fwrite(h, 1, sizeof(h), f);
+    fwrite(y.data(), 2, y.size(), f);
+    fclose(f);
+}
+
+/**
+ * @brief Decode a capture, lost packets are replaced by silence of the length
+ * of the packet before them
+ */
+static int decode_capture(void)
+{
+    std::vector<uint8_t> in;
+    std::vector<int16_t> y;
+    std::vector<ei_adpcm_packet_info_t> infos;
+    FILE *f = fopen(options.in, "rb");
+    uint8_t buf[4096];
+    size_t n;
+
+    if (f == NULL) {
+        printf("cannot open %s\n", options.in);
+        return 1;
+    }
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        in.insert(in.end(), buf, buf + n);
+    }
+    fclose(f);
+
+    size_t skipped = decode_all(in, y, &infos);
+
+    // split by stream, fill gaps in the sequence numbers
+    std::vector<int16_t> stream;
+    size_t at = 0;
+    uint32_t lost = 0;
+    for (size_t p = 0; p < infos.size(); p++) {
+        const ei_adpcm_packet_info_t *info = &infos[p];
+        if (p > 0 && info->stream_id == infos[p - 1].stream_id) {
+            uint16_t gap = (uint16_t)(info->seq - infos[p - 1].seq - 1);
+            stream.insert(stream.end(), (size_t)gap * infos[p - 1].n_samples, 0);
+            lost += gap;
+        }
+        stream.insert(stream.end(), y.begin() + at, y.begin() + at + info->n_samples);
+        at += info->n_samples;
+
+        if (p + 1 == infos.size() || infos[p + 1].stream_id != info->stream_id) {
+            char path[512];
+            const char *dot = strrchr(options.out, '.');
+            int stem = dot ? (int)(dot - options.out) : (int)strlen(options.out);
+            snprintf(path, sizeof(path), "%.*s_%u%s", stem, options.out, (unsigned)info->stream_id, dot ? dot : "");
+            write_wav(path, stream, options.rate);
+            printf("stream %u: %.3f s to %s\n", (unsigned)info->stream_id, (double)stream.size() / options.rate, path);
+            stream.clear();
+        }
+    }
+    printf("%u packets, %u lost, %u bytes of other data skipped\n", (unsigned)infos.size(), (unsigned)lost,
+        (unsigned)skipped);
+
+    return 0;
+}
+
+static bool parse_option(const char *arg)
+{
+    unsigned a;
+
+    if (strncmp(arg, "in=", 3) == 0) { options.in = arg + 3; return true; }
+    if (strncmp(arg, "out=", 4) == 0) { options.out = arg + 4; return true; }
+    if (sscanf(arg, "seconds=%u", &a) == 1 && a > 0) { options.seconds = a; return true; }
+    if (sscanf(arg, "packet=%u", &a) == 1 && a > 0 && a <= EI_ADPCM_MAX_PACKET_SAMPLES) {
+        options.packet = a;
+        return true;
+    }
+    if (sscanf(arg, "slice=%u", &a) == 1 && a > 0) { options.slice = a; return true; }
+    if (sscanf(arg, "loss=%u", &a) == 1) { options.loss = a; return true; }
+    if (sscanf(arg, "rate=%u", &a) == 1 && a > 0) { options.rate = a; return true; }
+
+    return false;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+    for (int ix = 1; ix < argc; ix++) {
+        if (!parse_option(argv[ix])) {
+            printf("unknown option %s, see the top of ei_adpcm_host.cpp\n", argv[ix]);
+            return 1;
+        }
+    }
+
+    if (options.in != NULL) {
+        return decode_capture();
+    }
+    bench();
+
+    return 0;
+}
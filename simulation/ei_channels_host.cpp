@@ -0,0 +1,203 @@
+/* Host check and benchmark of ei_audio_channels.cpp, the stereo front end of
+ * EI_AUDIO_STEREO. Feeds interleaved pseudo random frames through the channel
+ * views and the delay-and-sum combiner buffer by buffer, in place as the
+ * microphone driver does, and compares every output sample with the sum of
+ * the delayed reference channels, for delays on either channel. Then times
+ * the combiner with and without a delay and the selection of one channel.
+ * Exits with 1 if an output differs.
+ *
+ * Options, as name=value:
+ *  frames=4000       stereo frames per buffer, EI_CLASSIFIER_SLICE_SIZE
+ *  buffers=3         per delay in the check
+ *  seconds=1         of each benchmark
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/* Include ----------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "ei_audio_channels.h"
+
+typedef struct {
+    uint32_t frames;
+    uint32_t buffers;
+    uint32_t seconds;
+} host_options_t;
+
+/* Private variables ------------------------------------------------------- */
+static host_options_t options = { 4000, 3, 1 };
+
+/* Private functions ------------------------------------------------------- */
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Run options.buffers buffers through the combiner and count the
+ * output samples that differ from (a[n] + b[n - delay]) / 2, or
+ * (a[n + delay] + b[n]) / 2 for a negative delay, with zeros before the start
+ */
+static uint32_t check_das(int delay)
+{
+    size_t total = (size_t)options.frames * options.buffers;
+    std::vector<int16_t> ref_a(total);
+    std::vector<int16_t> ref_b(total);
+    std::vector<int16_t> buf(2 * options.frames);
+    ei_audio_view_t views[2];
+    ei_audio_das_t das;
+    uint32_t seed = 1;
+    uint32_t errors = 0;
+
+    for (size_t ix = 0; ix < total; ix++) {
+        seed = seed * 1103515245u + 12345u;
+        ref_a[ix] = (int16_t)(seed >> 16);
+        seed = seed * 1103515245u + 12345u;
+        ref_b[ix] = (int16_t)(seed >> 16);
+    }
+
+    ei_audio_das_init(&das, delay);
+    for (uint32_t k = 0; k < options.buffers; k++) {
+        for (uint32_t ix = 0; ix < options.frames; ix++) {
+            buf[2 * ix] = ref_a[k * options.frames + ix];
+            buf[2 * ix + 1] = ref_b[k * options.frames + ix];
+        }
+        ei_audio_channel_views(buf.data(), options.frames, 2, views);
+        ei_audio_das_process(&das, &views[0], &views[1], buf.data());
+
+        for (uint32_t ix = 0; ix < options.frames; ix++) {
+            long n = (long)k * options.frames + ix;
+            int32_t a = ref_a[n];
+            int32_t b = ref_b[n];
+            if (delay > 0) {
+                b = (n - delay >= 0) ? ref_b[n - delay] : 0;
+            } else if (delay < 0) {
+                a = (n + delay >= 0) ? ref_a[n + delay] : 0;
+            }
+            errors += (buf[ix] != (int16_t)((a + b) >> 1));
+        }
+    }
+
+    return errors;
+}
+
+static uint32_t check_select(void)
+{
+    std::vector<int16_t> buf(2 * options.frames);
+    std::vector<int16_t> right(options.frames);
+    ei_audio_view_t views[2];
+    uint32_t errors = 0;
+
+    for (uint32_t ix = 0; ix < options.frames; ix++) {
+        buf[2 * ix] = (int16_t)ix;
+        buf[2 * ix + 1] = right[ix] = (int16_t)~ix;
+    }
+    ei_audio_channel_views(buf.data(), options.frames, 2, views);
+    ei_audio_select(&views[1], buf.data());
+    for (uint32_t ix = 0; ix < options.frames; ix++) {
+        errors += (buf[ix] != right[ix]);
+    }
+
+    return errors;
+}
+
+/**
+ * @brief Frames per second through views + combiner (delay >= 0) or views +
+ * select (delay < 0), on a buffer that changes between calls
+ */
+static double bench(int delay)
+{
+    std::vector<int16_t> buf(2 * options.frames, 1);
+    ei_audio_view_t views[2];
+    ei_audio_das_t das;
+    uint64_t calls = 0;
+
+    ei_audio_das_init(&das, delay < 0 ? 0 : delay);
+    double start = now_s();
+    double elapsed;
+    do {
+        for (int ix = 0; ix < 100; ix++) {
+            ei_audio_channel_views(buf.data(), options.frames, 2, views);
+            if (delay < 0) {
+                ei_audio_select(&views[1], buf.data());
+            } else {
+                ei_audio_das_process(&das, &views[0], &views[1], buf.data());
+            }
+            buf[7] ^= (int16_t)calls++;
+        }
+        elapsed = now_s() - start;
+    } while (elapsed < options.seconds);
+
+    return (double)calls * options.frames / elapsed;
+}
+
+static bool parse_option(const char *arg)
+{
+    unsigned a;
+
+    if (sscanf(arg, "frames=%u", &a) == 1 && a > EI_AUDIO_MAX_DELAY) { options.frames = a; return true; }
+    if (sscanf(arg, "buffers=%u", &a) == 1 && a > 0) { options.buffers = a; return true; }
+    if (sscanf(arg, "seconds=%u", &a) == 1 && a > 0) { options.seconds = a; return true; }
+
+    return false;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+    const int delays[] = { -(EI_AUDIO_MAX_DELAY - 1), -7, -1, 0, 1, 7, EI_AUDIO_MAX_DELAY - 1 };
+    uint32_t failed = 0;
+
+    for (int ix = 1; ix < argc; ix++) {
+        if (!parse_option(argv[ix])) {
+            printf("unknown option %s, see the top of ei_channels_host.cpp\n", argv[ix]);
+            return 1;
+        }
+    }
+
+    printf("%u frames per buffer, %u buffers per delay\n", (unsigned)options.frames, (unsigned)options.buffers);
+    for (size_t ix = 0; ix < sizeof(delays) / sizeof(delays[0]); ix++) {
+        uint32_t errors = check_das(delays[ix]);
+        printf("delay-and-sum, delay %3d: %u samples differ\n", delays[ix], (unsigned)errors);
+        failed += (errors != 0);
+    }
+    uint32_t errors = check_select();
+    printf("select right: %u samples differ\n", (unsigned)errors);
+    failed += (errors != 0);
+
+    double das0 = bench(0);
+    double das7 = bench(7);
+    double sel = bench(-1);
+    printf("delay-and-sum, no delay: %.1f Mframes/s, %.2f us per buffer\n", das0 / 1e6, options.frames * 1e6 / das0);
+    printf("delay-and-sum, delay 7:  %.1f Mframes/s, %.2f us per buffer\n", das7 / 1e6, options.frames * 1e6 / das7);
+    printf("select:                  %.1f Mframes/s, %.2f us per buffer\n", sel / 1e6, options.frames * 1e6 / sel);
+
+    return failed ? 1 : 0;
+}
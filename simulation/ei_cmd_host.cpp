@@ -0,0 +1,232 @@
+/* Host driver of ei_cmd.c. Feeds scripted AT command input to ei_cmd_feed,
+ * whole, one byte at a time and split at pseudo random points, as partial
+ * UART reads would deliver it, and checks the responses. The command table
+ * mirrors the STRIDE and THRESHOLD handlers of ei_infer_minimal_audio.cpp,
+ * including the stride limit without a continuous model window. With in=,
+ * feeds a file (or - for stdin) and prints the responses instead.
+ *
+ * Options, as name=value:
+ *  stride_max=1      largest AT+STRIDE accepted, 1 as the voice example
+ *                    without EI_AUDIO_FEATURE_CACHE or EI_AUDIO_STORED_WINDOW
+ *  seed=1            of the split points
+ *  in=               input to feed instead of the script
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/* Include ----------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "ei_cmd.h"
+
+typedef struct {
+    const char *input;
+    const char *expected;       // responses, with the stride limit applied where it matters
+} cmd_case_t;
+
+/* Private variables ------------------------------------------------------- */
+static int32_t stride_max = 1;
+static int32_t stride = 1;
+static float threshold = 0.8f;
+static uint32_t seed = 1;
+static std::string out;
+
+/* Private functions ------------------------------------------------------- */
+
+static void out_print(const char *str)
+{
+    out += str;
+}
+
+static int cmd_stride(int argc, char **argv)
+{
+    if (argc == 0) {
+        char line[32];
+        snprintf(line, sizeof(line), "STRIDE=%u\r\n", (unsigned)stride);
+        out_print(line);
+        return 0;
+    }
+    return (argc == 1) ? ei_cmd_parse_int(argv[0], 1, stride_max, &stride) : -1;
+}
+
+static int cmd_threshold(int argc, char **argv)
+{
+    if (argc == 0) {
+        char line[32];
+        snprintf(line, sizeof(line), "THRESHOLD=%d%%\r\n", (int)(threshold * 100.0f + 0.5f));
+        out_print(line);
+        return 0;
+    }
+    return (argc == 1) ? ei_cmd_parse_float(argv[0], 0.0f, 1.0f, &threshold) : -1;
+}
+
+static int cmd_args(int argc, char **argv)
+{
+    out_print("ARGS");
+    for (int ix = 0; ix < argc; ix++) {
+        out_print(ix ? "," : "=");
+        out_print(argv[ix]);
+    }
+    out_print("\r\n");
+    return 0;
+}
+
+static const ei_cmd_t commands[] = {
+    { "STRIDE", "classify one out of every n slices", cmd_stride },
+    { "THRESHOLD", "detection threshold, 0..1", cmd_threshold },
+    { "ARGS", "echo the arguments", cmd_args },
+};
+
+static uint32_t next_random(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 16;
+}
+
+/**
+ * @brief Feed input in chunks of at most max_chunk bytes, 0 for random sizes
+ */
+static std::string run(const char *input, size_t max_chunk)
+{
+    ei_cmd_parser_t parser;
+    size_t len = strlen(input);
+
+    ei_cmd_init(&parser, commands, sizeof(commands) / sizeof(commands[0]), out_print);
+    stride = 1;
+    threshold = 0.8f;
+    out.clear();
+    for (size_t pos = 0; pos < len;) {
+        size_t n = max_chunk ? max_chunk : 1 + next_random() % 9;
+        if (n > len - pos) {
+            n = len - pos;
+        }
+        ei_cmd_feed(&parser, &input[pos], n);
+        pos += n;
+    }
+
+    return out;
+}
+
+static std::string escaped(const std::string &str)
+{
+    std::string e;
+    for (size_t ix = 0; ix < str.size(); ix++) {
+        if (str[ix] == '\r') {
+            e += "\\r";
+        } else if (str[ix] == '\n') {
+            e += "\\n";
+        } else {
+            e += str[ix];
+        }
+    }
+    return e;
+}
+
+static int run_script(void)
+{
+    std::string too_long = "AT+ARGS=" + std::string(EI_CMD_LINE_MAX, 'x') + "\r\nAT\r\n";
+    std::string stride_set = (stride_max >= 3) ? "OK\r\nSTRIDE=3\r\nOK\r\n" : "ERROR\r\nSTRIDE=1\r\nOK\r\n";
+    const cmd_case_t cases[] = {
+        { "AT\r\n", "OK\r\n" },
+        { "at+stride?\r\n", "STRIDE=1\r\nOK\r\n" },
+        { "AT+STRIDE=3\r\nAT+STRIDE\r\n", stride_set.c_str() },
+        { "AT+STRIDE=0\r\nAT+STRIDE=99\nAT+STRIDE=2x\r\n", "ERROR\r\nERROR\r\nERROR\r\n" },
+        { "AT+THRESHOLD= 0.55 \r\nAT+THRESHOLD?\r\n", "OK\r\nTHRESHOLD=55%\r\nOK\r\n" },
+        { "AT+THRESHOLD=1.5\r\n", "ERROR\r\n" },
+        { "AT+ARGS=a, b ,c,d\r\nAT+ARGS=a,b,c,d,e\r\n", "ARGS=a,b,c,d\r\nOK\r\nERROR\r\n" },
+        { "AT+FOO\r\nFOO\r\n\r\n\n", "ERROR\r\nERROR\r\n" },
+        { "AT+STR\bRIDE?\r\nAT+X\x7F" "ARGS\r\n", "STRIDE=1\r\nOK\r\nARGS\r\nOK\r\n" },
+        { "AT+HELP\r\n", "AT+STRIDE - classify one out of every n slices\r\nAT+THRESHOLD - detection threshold, 0..1\r\n"
+                         "AT+ARGS - echo the arguments\r\nOK\r\n" },
+        { too_long.c_str(), "ERROR: line too long\r\nOK\r\n" },
+    };
+    static const size_t chunks[] = { 1000000, 1, 2, 3, 0, 0, 0 };
+    int failed = 0;
+
+    for (size_t ix = 0; ix < sizeof(cases) / sizeof(cases[0]); ix++) {
+        for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+            std::string got = run(cases[ix].input, chunks[c]);
+            if (got != cases[ix].expected) {
+                printf("FAIL %s (chunks of %s)\n  expected %s\n  got      %s\n", escaped(cases[ix].input).c_str(),
+                    chunks[c] ? std::to_string(chunks[c]).c_str() : "random",
+                    escaped(cases[ix].expected).c_str(), escaped(got).c_str());
+                failed++;
+                break;
+            }
+        }
+    }
+    printf("%u cases, %d failed, AT+STRIDE limit %d\n", (unsigned)(sizeof(cases) / sizeof(cases[0])), failed,
+        (int)stride_max);
+
+    return failed ? 1 : 0;
+}
+
+static int run_file(const char *path)
+{
+    FILE *f = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+    ei_cmd_parser_t parser;
+    char buf[64];
+    size_t n;
+
+    if (f == NULL) {
+        printf("cannot open %s\n", path);
+        return 1;
+    }
+    ei_cmd_init(&parser, commands, sizeof(commands) / sizeof(commands[0]), out_print);
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        out.clear();
+        ei_cmd_feed(&parser, buf, n);
+        fputs(out.c_str(), stdout);
+    }
+    printf("%u lines, %u errors\n", (unsigned)parser.lines, (unsigned)parser.errors);
+    if (f != stdin) {
+        fclose(f);
+    }
+
+    return 0;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+    const char *in = NULL;
+    unsigned a;
+
+    for (int ix = 1; ix < argc; ix++) {
+        if (sscanf(argv[ix], "stride_max=%u", &a) == 1) {
+            stride_max = (int32_t)a;
+        } else if (sscanf(argv[ix], "seed=%u", &a) == 1) {
+            seed = a;
+        } else if (strncmp(argv[ix], "in=", 3) == 0) {
+            in = &argv[ix][3];
+        } else {
+            printf("unknown option %s, see the top of ei_cmd_host.cpp\n", argv[ix]);
+            return 1;
+        }
+    }
+
+    return in ? run_file(in) : run_script();
+}
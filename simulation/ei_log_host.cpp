@@ -0,0 +1,216 @@
+/* Host test of ei_result_log.c on the file backend of ei_result_log_file.c,
+ * which keeps NOR flash semantics (erase to 0xFF, programming only clears
+ * bits). Appends records through several wraps of the ring and checks after
+ * every step that the stored records are consecutive and intact, that a
+ * chunked read as the AT+LOG download does it returns the same records, and
+ * that a remount, of the same storage or of the file opened again, recovers
+ * the oldest and next sequence numbers. A reset with unflushed records loses
+ * at most the pending batch. Exits with 1 if a case fails.
+ *
+ * Options, as name=value:
+ *  path=ei_log_host.bin  flash image, recreated at start
+ *  size=1024             region size in bytes
+ *  page=256              erase unit
+ *  batch=4               records programmed per flash write
+ *  chunk=7               records per read of the download
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/* Include ----------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "ei_result_log.h"
+
+typedef struct {
+    const char *path;
+    uint32_t size;
+    uint32_t page;
+    uint32_t batch;
+    uint32_t chunk;
+} host_options_t;
+
+/* Private variables ------------------------------------------------------- */
+static host_options_t options = { "ei_log_host.bin", 1024, 256, 4, 7 };
+static uint32_t failed = 0;
+static uint32_t cases = 0;
+
+/* Private functions ------------------------------------------------------- */
+
+static void check(bool ok, const char *what)
+{
+    cases++;
+    if (!ok) {
+        failed++;
+        printf("FAIL: %s\n", what);
+    }
+}
+
+/** Records are derived from their sequence number, so any record can be verified */
+static void append(ei_result_log_t *log, uint32_t n)
+{
+    for (uint32_t ix = 0; ix < n; ix++) {
+        ei_result_record_t record = { 0 };
+        uint32_t seq = log->next_seq;
+        record.timestamp_ms = seq * 100;
+        record.label = (uint8_t)(seq % 3);
+        record.score = (uint16_t)(seq * 7);
+        record.dsp_ms = (uint16_t)seq;
+        if (ei_result_log_append(log, &record) != 0) {
+            check(false, "append");
+            return;
+        }
+    }
+}
+
+static bool record_ok(const ei_result_record_t *record)
+{
+    return record->timestamp_ms == record->seq * 100 && record->label == record->seq % 3
+        && record->score == (uint16_t)(record->seq * 7) && record->dsp_ms == (uint16_t)record->seq;
+}
+
+/**
+ * @brief Read everything from the oldest record on, in one go and in chunks,
+ * and check both against the sequence numbers the log reports
+ */
+static void verify(ei_result_log_t *log, const char *when)
+{
+    std::vector<ei_result_record_t> all(options.size / sizeof(ei_result_record_t));
+    std::vector<ei_result_record_t> chunk(options.chunk);
+    char what[128];
+    bool ok = true;
+
+    size_t n = ei_result_log_read(log, 0, all.data(), all.size());
+    for (size_t ix = 0; ix < n; ix++) {
+        ok = ok && record_ok(&all[ix]) && all[ix].seq == log->oldest_seq + ix;
+    }
+    snprintf(what, sizeof(what), "%s: %u records from %u to %u, read %u consecutive and intact", when,
+        (unsigned)(log->next_seq - log->oldest_seq), (unsigned)log->oldest_seq, (unsigned)log->next_seq,
+        (unsigned)n);
+    check(ok && n == log->next_seq - log->oldest_seq, what);
+
+    // as log_download, one chunk per pass of the task
+    uint32_t from = 0;
+    size_t total = 0;
+    size_t got;
+    ok = true;
+    while ((got = ei_result_log_read(log, from, chunk.data(), chunk.size())) > 0) {
+        for (size_t ix = 0; ix < got; ix++) {
+            ok = ok && total + ix < n && memcmp(&chunk[ix], &all[total + ix], sizeof(ei_result_record_t)) == 0;
+        }
+        total += got;
+        from = chunk[got - 1].seq + 1;
+    }
+    snprintf(what, sizeof(what), "%s: chunked read of %u records matches", when, (unsigned)total);
+    check(ok && total == n, what);
+}
+
+static void test(void)
+{
+    std::vector<ei_result_record_t> batch(options.batch);
+    ei_log_storage_t storage;
+    ei_result_log_t log;
+    ei_result_log_t remount;
+    char what[128];
+
+    remove(options.path);
+    check(ei_result_log_file_open(&storage, options.path, options.size, options.page) == 0, "open new file");
+    check(ei_result_log_init(&log, &storage, batch.data(), options.batch) == 0, "init erased region");
+    uint32_t capacity = (log.n_pages - 1) * log.records_per_page;
+    printf("%u pages of %u records, at least %u records kept\n", (unsigned)log.n_pages,
+        (unsigned)log.records_per_page, (unsigned)capacity);
+    verify(&log, "empty");
+
+    // fill, then wrap the ring three times, remounting in between
+    for (int round = 0; round < 4; round++) {
+        append(&log, capacity + log.records_per_page / 2);
+        ei_result_log_flush(&log);
+        snprintf(what, sizeof(what), "round %d", round);
+        verify(&log, what);
+        check(log.next_seq - log.oldest_seq >= capacity, "wrapped log keeps at least the capacity");
+
+        check(ei_result_log_init(&remount, &storage, batch.data(), options.batch) == 0, "remount");
+        snprintf(what, sizeof(what), "round %d remount recovers oldest %u and next %u", round,
+            (unsigned)log.oldest_seq, (unsigned)log.next_seq);
+        check(remount.oldest_seq == log.oldest_seq && remount.next_seq == log.next_seq, what);
+        log = remount;
+    }
+
+    // reset with a pending batch: the programmed records survive, the new ones follow them
+    uint32_t flushed = log.next_seq;
+    append(&log, options.batch - 1);
+    check(ei_result_log_init(&remount, &storage, batch.data(), options.batch) == 0, "remount after reset");
+    snprintf(what, sizeof(what), "reset loses only the pending batch, next %u (flushed up to %u)",
+        (unsigned)remount.next_seq, (unsigned)flushed);
+    check(remount.next_seq >= flushed && remount.next_seq <= log.next_seq, what);
+    log = remount;
+    append(&log, log.records_per_page + 3);
+    ei_result_log_flush(&log);
+    verify(&log, "after reset");
+
+    // reopen the image, as after a power cycle of the host
+    fclose((FILE *)storage.ctx);
+    check(ei_result_log_file_open(&storage, options.path, options.size, options.page) == 0, "open existing file");
+    check(ei_result_log_init(&remount, &storage, batch.data(), options.batch) == 0, "init existing file");
+    snprintf(what, sizeof(what), "reopened file recovers oldest %u and next %u", (unsigned)log.oldest_seq,
+        (unsigned)log.next_seq);
+    check(remount.oldest_seq == log.oldest_seq && remount.next_seq == log.next_seq, what);
+    verify(&remount, "reopened");
+    check(remount.storage_errors == 0 && log.storage_errors == 0, "no storage errors");
+    fclose((FILE *)storage.ctx);
+}
+
+static bool parse_option(const char *arg)
+{
+    unsigned a;
+
+    if (strncmp(arg, "path=", 5) == 0) { options.path = arg + 5; return true; }
+    if (sscanf(arg, "size=%u", &a) == 1 && a > 0) { options.size = a; return true; }
+    if (sscanf(arg, "page=%u", &a) == 1 && a > 0) { options.page = a; return true; }
+    if (sscanf(arg, "batch=%u", &a) == 1 && a > 0) { options.batch = a; return true; }
+    if (sscanf(arg, "chunk=%u", &a) == 1 && a > 0) { options.chunk = a; return true; }
+
+    return false;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+    for (int ix = 1; ix < argc; ix++) {
+        if (!parse_option(argv[ix])) {
+            printf("unknown option %s, see the top of ei_log_host.cpp\n", argv[ix]);
+            return 1;
+        }
+    }
+    if (options.size % options.page != 0) {
+        printf("size must be a multiple of page\n");
+        return 1;
+    }
+
+    test();
+    printf("%u of %u checks passed\n", (unsigned)(cases - failed), (unsigned)cases);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,242 @@
+/* Host benchmark of ei_audio_preprocess.cpp. Runs the DC blocker and AGC of
+ * EI_AUDIO_PREPROCESS on synthetic 16 kHz signals, one I2S slice per call as
+ * the microphone driver does, and prints the host time per sample next to the
+ * cycle budget of the target, the gain and output level the AGC settles at,
+ * how long that takes, the DC left after the filter and the clipped samples.
+ * The host time is not the target time: the time per slice on target is
+ * printed by AT+STATS of the voice example.
+ *
+ * Options, as name=value:
+ *  seconds=10        of every signal
+ *  slice=4000        samples per call, EI_CLASSIFIER_SLICE_SIZE
+ *  mhz=48            target CPU clock, for the cycles per sample available
+ *  budget=5          percent of the CPU the preprocessing may take
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/* Include ----------------------------------------------------------------- */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "ei_audio_preprocess.h"
+#include "arm_math.h"
+
+#define BENCH_RATE      16000
+#define DBFS(rms)       (20.0 * log10((rms) / 32768.0 + 1e-12))
+
+typedef struct {
+    uint32_t seconds;
+    uint32_t slice;
+    uint32_t mhz;
+    uint32_t budget;
+} host_options_t;
+
+/* Private variables ------------------------------------------------------- */
+static host_options_t options = { 10, 4000, 48, 5 };
+
+/* Private functions ------------------------------------------------------- */
+
+static int16_t clip16(double v)
+{
+    return (int16_t)(v > 32767.0 ? 32767.0 : (v < -32768.0 ? -32768.0 : v));
+}
+
+/**
+ * @brief Synthetic test signals with the DC offset of a MEMS microphone,
+ * 0: voiced speech-like, 1: quiet tone, 2: loud tone, 3: white noise,
+ * 4: near silence
+ */
+static const char *make_signal(int kind, std::vector<int16_t> &x)
+{
+    uint32_t lcg = 12345;
+    double phase = 0.0;
+
+    for (size_t n = 0; n < x.size(); n++) {
+        double t = (double)n / BENCH_RATE;
+        double v = 0.0;
+        switch (kind) {
+        case 0: {
+            // harmonics of a gliding pitch under formant-like weights, 4 syllables per second
+            double f0 = 120.0 + 60.0 * sin(2 * M_PI * 0.7 * t);
+            double env = 0.5 - 0.5 * cos(2 * M_PI * 4.0 * t);
+            phase += 2 * M_PI * f0 / BENCH_RATE;
+            for (int h = 1; h <= 30 && h * f0 < 7500.0; h++) {
+                double f = h * f0;
+                double w = 1.0 / (1.0 + pow((f - 500.0) / 200.0, 2)) + 0.6 / (1.0 + pow((f - 1500.0) / 300.0, 2))
+                         + 0.3 / (1.0 + pow((f - 2500.0) / 400.0, 2));
+                v += w * sin(h * phase);
+            }
+            v *= 2000.0 * env;
+            break;
+        }
+        case 1:
+            v = 328.0 * sin(2 * M_PI * 440.0 * t);
+            break;
+        case 2:
+            v = 29000.0 * sin(2 * M_PI * 440.0 * t);
+            break;
+        case 3:
+            lcg = lcg * 1664525u + 1013904223u;
+            v = ((int32_t)(lcg >> 16) - 32768) * 0.1;
+            break;
+        default:
+            lcg = lcg * 1664525u + 1013904223u;
+            v = ((int32_t)(lcg >> 16) - 32768) * 0.0005;
+            break;
+        }
+        x[n] = clip16(v + 600.0);
+    }
+
+    static const char *names[] = { "voiced speech-like", "tone 440 Hz -40 dBFS", "tone 440 Hz -1 dBFS",
+                                   "white noise -20 dBFS", "noise -70 dBFS" };
+    return names[kind];
+}
+
+static void process_all(std::vector<int16_t> &y)
+{
+    for (size_t ix = 0; ix < y.size(); ix += options.slice) {
+        size_t n = (y.size() - ix < options.slice) ? y.size() - ix : options.slice;
+        ei_audio_pp_process(&y[ix], (uint32_t)n);
+    }
+}
+
+static double rms_of(const int16_t *x, size_t n, double *mean)
+{
+    double sum = 0.0;
+    double sq = 0.0;
+
+    for (size_t ix = 0; ix < n; ix++) {
+        sum += x[ix];
+        sq += (double)x[ix] * x[ix];
+    }
+    *mean = sum / n;
+    return sqrt(sq / n - *mean * *mean);
+}
+
+static void bench(void)
+{
+    std::vector<int16_t> x((size_t)options.seconds * BENCH_RATE);
+    std::vector<int16_t> y;
+    ei_audio_pp_config_t config;
+    ei_audio_pp_stats_t stats;
+
+    ei_audio_pp_default_config(&config);
+    double slice_ms = options.slice * 1000.0 / BENCH_RATE;
+    double budget_cycles = options.mhz * 1e6 / BENCH_RATE * options.budget / 100.0;
+    printf("%u s per signal, %u samples per slice (%.1f ms), target -20 dBFS\n", (unsigned)options.seconds,
+        (unsigned)options.slice, slice_ms);
+    printf("budget: %u%% of %u MHz, %.0f cycles per sample, %.0f us per slice\n", (unsigned)options.budget,
+        (unsigned)options.mhz, budget_cycles, budget_cycles * options.slice / options.mhz);
+    printf("%-22s %9s %9s %9s %9s %9s %8s\n", "signal", "ns/smp", "gain", "out dBFS", "settle s", "DC out", "clipped");
+
+    for (int kind = 0; kind < 5; kind++) {
+        const char *name = make_signal(kind, x);
+
+        uint32_t passes = 0;
+        clock_t start = clock();
+        do {
+            y = x;
+            ei_audio_pp_init(&config);
+            process_all(y);
+            passes++;
+        } while (clock() - start < CLOCKS_PER_SEC / 4);
+        double ns = (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / ((double)passes * x.size());
+        ei_audio_pp_get_stats(&stats);
+
+        // settled: the first slice from which every slice is within 3 dB of the level of the last one
+        size_t slices = (y.size() + options.slice - 1) / options.slice;
+        std::vector<double> level(slices);
+        double mean;
+        for (size_t s = 0; s < slices; s++) {
+            size_t n = (y.size() - s * options.slice < options.slice) ? y.size() - s * options.slice : options.slice;
+            level[s] = DBFS(rms_of(&y[s * options.slice], n, &mean));
+        }
+        size_t settled = slices - 1;
+        while (settled > 0 && fabs(level[settled - 1] - level[slices - 1]) < 3.0) {
+            settled--;
+        }
+        size_t tail = (y.size() > BENCH_RATE) ? BENCH_RATE : y.size();
+        double out = rms_of(&y[y.size() - tail], tail, &mean);
+
+        printf("%-22s %9.2f %5u/256 %9.1f %9.2f %9.1f %8u\n", name, ns, (unsigned)stats.gain_q8, DBFS(out),
+            settled * slice_ms / 1000.0, mean, (unsigned)stats.clipped);
+    }
+    printf("host time is a lower bound, measure the target with AT+STATS (Preprocess: ... us per slice)\n");
+}
+
+static bool parse_option(const char *arg)
+{
+    unsigned a;
+
+    if (sscanf(arg, "seconds=%u", &a) == 1 && a > 0) { options.seconds = a; return true; }
+    if (sscanf(arg, "slice=%u", &a) == 1 && a > 0) { options.slice = a; return true; }
+    if (sscanf(arg, "mhz=%u", &a) == 1 && a > 0) { options.mhz = a; return true; }
+    if (sscanf(arg, "budget=%u", &a) == 1 && a > 0 && a <= 100) { options.budget = a; return true; }
+
+    return false;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+uint64_t ei_read_timer_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/* reference C, as in ei_sim_shims.cpp */
+extern "C" void arm_rms_q15(const q15_t *pSrc, uint32_t blockSize, q15_t *pResult)
+{
+    uint64_t sum = 0;
+
+    for (uint32_t ix = 0; ix < blockSize; ix++) {
+        sum += (int32_t)pSrc[ix] * pSrc[ix];
+    }
+    *pResult = (q15_t)sqrt((double)sum / blockSize);
+}
+
+extern "C" void arm_scale_q15(const q15_t *pSrc, q15_t scaleFract, int8_t shift, q15_t *pDst, uint32_t blockSize)
+{
+    for (uint32_t ix = 0; ix < blockSize; ix++) {
+        int32_t v = ((int32_t)pSrc[ix] * scaleFract) >> (15 - shift);
+        pDst[ix] = (q15_t)((v > INT16_MAX) ? INT16_MAX : ((v < INT16_MIN) ? INT16_MIN : v));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    for (int ix = 1; ix < argc; ix++) {
+        if (!parse_option(argv[ix])) {
+            printf("unknown option %s, see the top of ei_preprocess_host.cpp\n", argv[ix]);
+            return 1;
+        }
+    }
+
+    bench();
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+/* Host run of the multi_model scheduler (ei_scheduler.c) on pthreads, in real
+ * time. Two models stand in for the audio and motion impulses: acquire sleeps
+ * until the next period of the sensor, and infer keeps the CPU busy for the
+ * given time. Checks that only one inference runs at a time, as the shared
+ * arena requires, reports sensor periods missed because the acquisition
+ * thread was still waiting for its previous job, and prints the scheduler
+ * statistics. Exits with 1 if inferences overlapped, or with the defaults if
+ * a deadline was missed.
+ *
+ * With motion_fail=1 every motion acquire fails at once, as a sensor error
+ * would: the scheduler must wait a period between attempts instead of spinning.
+ * Exits with 1 if the motion errors are not about one per period, or audio
+ * missed a deadline.
+ *
+ * Options, as name=value:
+ *  seconds=5             to run
+ *  audio_period_ms=250   slice period, also the deadline
+ *  audio_infer_ms=60
+ *  motion_period_ms=1000 window duration, also the deadline
+ *  motion_infer_ms=120
+ *  motion_fail=0         1: motion acquire always fails
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/* Include ----------------------------------------------------------------- */
+#include <atomic>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ei_scheduler.h"
+
+typedef struct {
+    uint32_t period_ms;
+    uint32_t infer_ms;
+    uint64_t next_ms;           // end of the next sensor period
+    uint32_t periods_missed;    // acquire was called after the period had already ended
+    bool fail;                  // acquire returns an error at once
+} host_model_t;
+
+/* Private variables ------------------------------------------------------- */
+static uint32_t seconds = 5;
+static host_model_t audio = { 250, 60, 0, 0, false };
+static host_model_t motion = { 1000, 120, 0, 0, false };
+static std::atomic<int> inferring(0);
+static std::atomic<uint32_t> overlaps(0);
+static uint64_t start_ms = 0;
+
+/* Private functions ------------------------------------------------------- */
+
+static uint64_t host_ms(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Blocks until the next period of the sensor ends, as a DMA or a
+ * window of samples would complete
+ */
+static int host_acquire(void *ctx)
+{
+    host_model_t *m = (host_model_t *)ctx;
+    uint64_t now = host_ms();
+
+    if (m->fail) {
+        return -1;
+    }
+    if (m->next_ms == 0) {
+        m->next_ms = now + m->period_ms;
+    }
+    while (m->next_ms <= now) {
+        // the buffer of this period was overwritten while the job was pending
+        m->periods_missed++;
+        m->next_ms += m->period_ms;
+    }
+    usleep((useconds_t)((m->next_ms - now) * 1000));
+    m->next_ms += m->period_ms;
+
+    return 0;
+}
+
+static int host_infer(void *ctx)
+{
+    host_model_t *m = (host_model_t *)ctx;
+
+    if (inferring.fetch_add(1) != 0) {
+        overlaps++;
+    }
+    uint64_t end = host_ms() + m->infer_ms;
+    while (host_ms() < end) {
+        // CPU bound, as the impulse
+    }
+    inferring.fetch_sub(1);
+
+    return 0;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+extern "C" uint64_t Timer_getMs(void)
+{
+    return host_ms() - start_ms;
+}
+
+extern "C" void Serial_Printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned a;
+
+    for (int ix = 1; ix < argc; ix++) {
+        if (sscanf(argv[ix], "seconds=%u", &a) == 1) {
+            seconds = a;
+        } else if (sscanf(argv[ix], "audio_period_ms=%u", &a) == 1) {
+            audio.period_ms = a;
+        } else if (sscanf(argv[ix], "audio_infer_ms=%u", &a) == 1) {
+            audio.infer_ms = a;
+        } else if (sscanf(argv[ix], "motion_period_ms=%u", &a) == 1) {
+            motion.period_ms = a;
+        } else if (sscanf(argv[ix], "motion_infer_ms=%u", &a) == 1) {
+            motion.infer_ms = a;
+        } else if (sscanf(argv[ix], "motion_fail=%u", &a) == 1) {
+            motion.fail = (a != 0);
+        } else {
+            printf("unknown option %s, see the top of ei_sched_host.cpp\n", argv[ix]);
+            return 1;
+        }
+    }
+    start_ms = host_ms();
+
+    ei_sched_model_t audio_model = { 0 };
+    audio_model.name = "audio";
+    audio_model.deadline_ms = audio.period_ms;
+    audio_model.period_ms = audio.period_ms;
+    audio_model.priority = 1;
+    audio_model.acquire = host_acquire;
+    audio_model.infer = host_infer;
+    audio_model.ctx = &audio;
+
+    ei_sched_model_t motion_model = audio_model;
+    motion_model.name = "motion";
+    motion_model.deadline_ms = motion.period_ms;
+    motion_model.period_ms = motion.period_ms;
+    motion_model.priority = 0;
+    motion_model.ctx = &motion;
+
+    int audio_idx = ei_sched_add_model(&audio_model);
+    int motion_idx = ei_sched_add_model(&motion_model);
+    if (audio_idx < 0 || motion_idx < 0 || ei_sched_start() != 0) {
+        printf("failed to start the scheduler\n");
+        return 1;
+    }
+    sleep(seconds);
+    ei_sched_stop();
+
+    ei_sched_print_stats();
+    ei_sched_stats_t audio_stats;
+    ei_sched_stats_t motion_stats;
+    ei_sched_get_stats(audio_idx, &audio_stats);
+    ei_sched_get_stats(motion_idx, &motion_stats);
+    printf("sensor periods missed: audio %u, motion %u; overlapping inferences %u\n",
+        (unsigned)audio.periods_missed, (unsigned)motion.periods_missed, (unsigned)overlaps.load());
+
+    if (overlaps.load() != 0) {
+        return 1;
+    }
+    if (motion.fail) {
+        // one failed attempt per period, plus the one at the start
+        uint32_t max_errors = seconds * 1000 / motion.period_ms + 1;
+        printf("motion acquire errors %u (at most %u expected)\n", (unsigned)motion_stats.errors, (unsigned)max_errors);
+        if (motion_stats.errors == 0 || motion_stats.errors > max_errors || audio_stats.missed != 0) {
+            return 1;
+        }
+    }
+    // the defaults fit: the longest job plus an audio job is shorter than the audio period
+    if (argc == 1 && (audio_stats.missed + motion_stats.missed + audio.periods_missed + motion.periods_missed) != 0) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,492 @@
+/* Simulation of the voice_recognition microphone pipeline. The unmodified
+ * ei_microphone_minimal_audio.cpp runs against simulated I2S DMA completions
+ * and message queues, and the classifier is replaced by injected DSP and
+ * inference durations. Reports per slice latency, every loss of audio with
+ * its cause, the duty cycle and energy estimate of ei_energy.h, the time to
+ * the first result (ei_startup.h), and checks the capture time stamps of the
+ * driver against the simulated DMA completions. With sweep=1, searches the longest
+ * inference time at which no audio is lost. Built with EI_AUDIO_SLICE_CONTROLLER=1
+ * and ei_slice_controller.cpp, the stride controller of ei_infer_audio decides
+ * which slices are classified, on the simulated clock, and every classified
+ * model window is checked to be made of consecutive slices. Built with
+ * EI_AUDIO_ADPCM=1 and ei_adpcm.c, every slice is encoded and written to the
+ * blocking UART before its DSP, as the ADPCM stream of ei_infer_audio, to see
+ * at which uart_us the stream costs audio.
+ *
+ * Options, as name=value:
+ *  seconds=60        virtual time to simulate
+ *  dsp_us=20000      DSP time per slice
+ *  nn_us=100000      inference time per slice
+ *  jitter=0          +/- percent of variation of both
+ *  spike_us=0        added to the inference time of every spike_every-th slice
+ *  spike_every=0
+ *  isr_us=20         I2S interrupt time
+ *  init_us=0         run_classifier_init
+ *  staged=1          start the microphone before run_classifier_init, as
+ *                    ei_init does; 0 initializes the classifier first
+ *  uart_us=87        per character printed, 115200 baud
+ *  load=P:C          higher priority load of C us every P us, repeatable
+ *  seed=1            of the jitter
+ *  sweep=0           search the overrun threshold of nn_us instead
+ *  echo=0            print the output of the driver
+ *  cache=0           with the controller: 1 runs the DSP on every slice, as
+ *                    EI_AUDIO_FEATURE_CACHE, 0 classifies the stored window,
+ *                    as EI_AUDIO_STORED_WINDOW, with dsp_us per slice of it
+ *  max_stride=0      with the controller, 0 for the slices per model window
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "ei_sim_kernel.h"
+#include "ei_sim_shims.h"
+#include "ei_microphone_minimal_audio.h"
+#include "ei_energy.h"
+#include "ei_startup.h"
+#include "ei_latency.h"
+#include "model-parameters/model_metadata.h"
+
+#ifndef EI_AUDIO_SLICE_CONTROLLER
+#define EI_AUDIO_SLICE_CONTROLLER   0
+#endif
+
+#if EI_AUDIO_SLICE_CONTROLLER
+#include "ei_slice_controller.h"
+#endif
+
+#ifndef EI_AUDIO_ADPCM
+#define EI_AUDIO_ADPCM              0
+#endif
+
+#if EI_AUDIO_ADPCM
+#include "ei_adpcm.h"
+
+#ifndef EI_AUDIO_ADPCM_PACKET_SAMPLES
+#define EI_AUDIO_ADPCM_PACKET_SAMPLES   256
+#endif
+#endif
+
+#define MAX_LOADS   8
+
+typedef struct {
+    uint32_t seconds;
+    uint32_t dsp_us;
+    uint32_t nn_us;
+    uint32_t jitter;
+    uint32_t spike_us;
+    uint32_t spike_every;
+    uint32_t seed;
+    uint32_t init_us;
+    bool staged;
+    bool sweep;
+    bool cache;
+    uint32_t max_stride;
+    uint32_t load_period_us[MAX_LOADS];
+    uint32_t load_cpu_us[MAX_LOADS];
+    int n_loads;
+} audio_scenario_t;
+
+typedef struct {
+    uint32_t results;
+    uint32_t gaps;              // the slice does not follow the previous one
+    uint64_t samples_lost;
+    uint32_t torn;              // the DMA overwrote the slice before the DSP was done with it
+    uint64_t cpu_us;            // injected DSP and inference time
+    ei_sim_stats_t queue_wait;  // buffer completed -> handed to the classifier
+    ei_sim_stats_t latency;     // buffer completed -> result
+    uint32_t stamp_error_us;    // largest difference of the driver capture stamp to the completion
+    ei_latency_t capture;       // driver capture stamp -> result, as EI_AUDIO_LATENCY measures it
+    ei_microphone_stats_t mic;
+    ei_energy_t energy;
+#if EI_AUDIO_SLICE_CONTROLLER
+    ei_slice_ctrl_t ctrl;
+    uint8_t max_stride_used;
+    uint32_t window_gaps;       // classified windows that are not made of consecutive slices
+    uint64_t window_first[EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW];
+    uint32_t window_next;
+    uint32_t window_slices;
+#endif
+#if EI_AUDIO_ADPCM
+    ei_adpcm_encoder_t adpcm;
+    uint64_t adpcm_bytes;
+    uint32_t adpcm_worst_us;    // encoding and writing of a slice
+#endif
+} audio_report_t;
+
+/* Private variables ------------------------------------------------------- */
+static audio_scenario_t scenario = { 60, 20000, 100000, 0, 0, 0, 1, 0, true, false, false, 0, { 0 }, { 0 }, 0 };
+static audio_report_t report;
+#if EI_AUDIO_ADPCM
+static uint8_t adpcm_packet[EI_ADPCM_PACKET_SIZE(EI_AUDIO_ADPCM_PACKET_SAMPLES)];
+#endif
+
+/* Private functions ------------------------------------------------------- */
+
+static void classifier_init(const audio_scenario_t *sc)
+{
+    ei_sim_busy(sc->init_us);
+    report.cpu_us += sc->init_us;
+    ei_startup_mark(EI_STARTUP_CLASSIFIER_READY);
+}
+
+#if EI_AUDIO_SLICE_CONTROLLER
+static void ctrl_init(const audio_scenario_t *sc)
+{
+    ei_slice_ctrl_config_t config;
+
+    // as in ei_init
+    config.slice_period_us = (EI_CLASSIFIER_SLICE_SIZE * 1000) / (EI_CLASSIFIER_FREQUENCY / 1000);
+    config.max_stride = sc->max_stride ? sc->max_stride : EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW;
+    config.queue_limit = 1;
+    config.budget_pct = 90;
+    config.recover_cycles = 8;
+    ei_slice_ctrl_init(&report.ctrl, &config);
+}
+
+/**
+ * @brief Keep the first sample of the slices of the model window, as the
+ * feature cache or the stored window does, to check it when it is classified
+ */
+static void window_push(uint64_t first_sample)
+{
+    report.window_first[report.window_next] = first_sample;
+    report.window_next = (report.window_next + 1) % EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW;
+    if (report.window_slices < EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW) {
+        report.window_slices++;
+    }
+}
+
+static bool window_contiguous(void)
+{
+    for (uint32_t ix = 1; ix < EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW; ix++) {
+        uint32_t prev = (report.window_next + ix - 1) % EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW;
+        uint32_t cur = (report.window_next + ix) % EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW;
+        if (report.window_first[cur] != report.window_first[prev] + EI_CLASSIFIER_SLICE_SIZE) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+#if EI_AUDIO_ADPCM
+static void adpcm_write_uart(const void *data, size_t len)
+{
+    report.adpcm_bytes += len;
+    ei_sim_uart_write(len);
+}
+
+/**
+ * @brief As adpcm_slice of ei_infer_audio, the task waits for the UART
+ */
+static void adpcm_slice(const int16_t *slice)
+{
+    uint64_t start_us = ei_sim_now_us();
+    ei_adpcm_encode(&report.adpcm, slice, EI_CLASSIFIER_SLICE_SIZE);
+    uint32_t took_us = (uint32_t)(ei_sim_now_us() - start_us);
+    if (took_us > report.adpcm_worst_us) {
+        report.adpcm_worst_us = took_us;
+    }
+}
+#endif
+
+/**
+ * @brief The inference thread: record a slice, then spend the DSP and
+ * inference time of the impulse on it, as ei_infer_audio does
+ */
+static void audio_task(void *arg)
+{
+    const audio_scenario_t *sc = (const audio_scenario_t *)arg;
+    uint64_t next_sample = 0;
+    bool have_prev = false;
+
+    if (!sc->staged) {
+        classifier_init(sc);
+    }
+    ei_microphone_inference_start(EI_CLASSIFIER_SLICE_SIZE);
+    // also marked by the driver when built with EI_AUDIO_STARTUP_TRACE=1
+    ei_startup_mark(EI_STARTUP_FIRST_SAMPLE);
+    if (sc->staged) {
+        classifier_init(sc);
+    }
+
+    while (1) {
+        ei_sim_i2s_buffer_t info;
+
+        ei_energy_enter(&report.energy, EI_ENERGY_ACQUIRE);
+        ei_microphone_inference_record();
+        if (ei_sim_i2s_buffer_info(ei_microphone_slice_buffer(), &info) != 0) {
+            continue;
+        }
+        if (have_prev && info.first_sample != next_sample) {
+            report.gaps++;
+            if (info.first_sample > next_sample) {
+                report.samples_lost += info.first_sample - next_sample;
+            }
+        }
+        next_sample = info.first_sample + info.n_samples;
+        have_prev = true;
+        ei_sim_stats_add(&report.queue_wait, ei_sim_now_us() - info.done_us);
+        uint32_t capture_us = ei_microphone_slice_capture_us();
+        uint32_t stamp_error = (capture_us > (uint32_t)info.done_us) ? capture_us - (uint32_t)info.done_us
+                                                                     : (uint32_t)info.done_us - capture_us;
+        if (stamp_error > report.stamp_error_us) {
+            report.stamp_error_us = stamp_error;
+        }
+#if EI_AUDIO_ADPCM
+        ei_energy_enter(&report.energy, EI_ENERGY_APP);
+        adpcm_slice(ei_microphone_slice_buffer());
+#endif
+
+        uint32_t dsp_us = ei_sim_jitter(sc->dsp_us, sc->jitter);
+#if EI_AUDIO_SLICE_CONTROLLER
+        uint64_t start_us = ei_sim_now_us();
+        bool run_nn = ei_slice_ctrl_should_process(&report.ctrl);
+        window_push(info.first_sample);
+        if (report.ctrl.stride > report.max_stride_used) {
+            report.max_stride_used = report.ctrl.stride;
+        }
+        if (!sc->cache) {
+            // the slice is copied out at once, run_classifier does the DSP of the whole window
+            run_nn = run_nn && (report.window_slices == EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW);
+            dsp_us = run_nn ? dsp_us * EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW : 0;
+        }
+#endif
+        ei_energy_enter(&report.energy, EI_ENERGY_DSP);
+        ei_sim_busy(dsp_us);
+        if (ei_sim_now_us() > info.reuse_us && (sc->cache || !EI_AUDIO_SLICE_CONTROLLER)) {
+            report.torn++;
+        }
+        report.cpu_us += dsp_us;
+#if EI_AUDIO_SLICE_CONTROLLER
+        if (sc->cache) {
+            run_nn = run_nn && (report.window_slices == EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW);
+        }
+        if (!run_nn) {
+            ei_energy_enter(&report.energy, EI_ENERGY_APP);
+            ei_slice_ctrl_update(&report.ctrl, (uint32_t)(ei_sim_now_us() - start_us), ei_microphone_queue_depth());
+            continue;
+        }
+        if (!window_contiguous()) {
+            report.window_gaps++;
+        }
+#endif
+
+        uint32_t nn_us = ei_sim_jitter(sc->nn_us, sc->jitter);
+        if (sc->spike_every && (report.results + 1) % sc->spike_every == 0) {
+            nn_us += sc->spike_us;
+        }
+        ei_energy_enter(&report.energy, EI_ENERGY_NN);
+        ei_sim_busy(nn_us);
+        ei_energy_enter(&report.energy, EI_ENERGY_APP);
+        ei_energy_inference_done(&report.energy);
+
+        report.cpu_us += nn_us;
+        report.results++;
+        ei_startup_mark(EI_STARTUP_FIRST_RESULT);
+        ei_sim_stats_add(&report.latency, ei_sim_now_us() - info.done_us);
+        ei_latency_add(&report.capture, ei_latency_since(capture_us, (uint32_t)ei_sim_now_us()));
+#if EI_AUDIO_SLICE_CONTROLLER
+        ei_slice_ctrl_update(&report.ctrl, (uint32_t)(ei_sim_now_us() - start_us), ei_microphone_queue_depth());
+#endif
+    }
+}
+
+static uint64_t run(const audio_scenario_t *sc)
+{
+    memset(&report, 0, sizeof(report));
+    ei_sim_reset((uint64_t)sc->seconds * 1000000ULL, sc->seed);
+    ei_sim_shims_reset();
+    for (int ix = 0; ix < sc->n_loads; ix++) {
+        ei_sim_add_load(sc->load_period_us[ix], sc->load_cpu_us[ix]);
+    }
+
+    if (ei_microphone_init() != 0) {
+        printf("ei_microphone_init failed\n");
+        exit(1);
+    }
+    ei_microphone_reset_stats();
+    ei_energy_init(&report.energy, NULL, ei_sim_now_us);
+    ei_latency_init(&report.capture, 1000);
+    ei_startup_begin(ei_sim_now_us);
+#if EI_AUDIO_SLICE_CONTROLLER
+    ctrl_init(sc);
+#endif
+#if EI_AUDIO_ADPCM
+    ei_adpcm_encoder_init(&report.adpcm, adpcm_packet, sizeof(adpcm_packet), EI_AUDIO_ADPCM_PACKET_SAMPLES, 0,
+                          adpcm_write_uart);
+#endif
+
+    uint64_t end_us = ei_sim_run(audio_task, (void *)sc);
+
+    ei_microphone_get_stats(&report.mic);
+    ei_microphone_inference_end();
+
+    return end_us;
+}
+
+static uint64_t audio_lost(const audio_report_t *r)
+{
+    uint64_t lost = r->mic.dropped_queue_full + r->mic.dropped_overrun + r->mic.seq_lost + r->gaps + r->torn;
+#if EI_AUDIO_SLICE_CONTROLLER
+    lost += r->window_gaps;
+#endif
+    return lost;
+}
+
+static void print_report(const audio_scenario_t *sc, uint64_t end_us)
+{
+    const ei_microphone_stats_t *m = &report.mic;
+
+    printf("slice %u samples (%.3f ms), DSP %.3f ms, inference %.3f ms, jitter %u%%\n",
+        (unsigned)EI_CLASSIFIER_SLICE_SIZE, EI_CLASSIFIER_SLICE_SIZE * 1000.0 / EI_CLASSIFIER_FREQUENCY,
+        sc->dsp_us / 1000.0, sc->nn_us / 1000.0, (unsigned)sc->jitter);
+    printf("buffers: produced %u, delivered %u, results %u\n", m->frames_produced, m->frames_delivered,
+        report.results);
+    printf("dropped: not recording %u, skip %u, queue full %u, overrun %u, partial %u\n",
+        m->dropped_not_recording, m->dropped_skip, m->dropped_queue_full, m->dropped_overrun,
+        m->partial_frames);
+    printf("sequence: %u gaps, %u lost, max queue depth %u\n", m->seq_gaps, m->seq_lost, m->max_queue_depth);
+    printf("slices: %u not contiguous (%llu samples lost), %u overwritten by the DMA during DSP\n",
+        report.gaps, (unsigned long long)report.samples_lost, report.torn);
+    printf("cpu: %.1f%% of %.3f s, %u lines printed by the driver\n",
+        end_us ? 100.0 * report.cpu_us / end_us : 0.0, end_us / 1e6, ei_sim_print_lines());
+#if EI_AUDIO_SLICE_CONTROLLER
+    const ei_slice_ctrl_t *c = &report.ctrl;
+    printf("controller (%s): stride %u, at most %u, %u slices classified, %u skipped, "
+        "%u overloads, %u increases, %u decreases\n",
+        sc->cache ? "feature cache" : "stored window", (unsigned)c->stride, (unsigned)report.max_stride_used,
+        c->slices_processed, c->slices_skipped, c->overloads, c->stride_increases, c->stride_decreases);
+    printf("classified windows: %u, %u not made of consecutive slices\n", report.results, report.window_gaps);
+#endif
+#if EI_AUDIO_ADPCM
+    printf("adpcm: %u packets, %.1f kbit/s, %u us per char, worst slice %.3f ms of %.3f ms\n",
+        (unsigned)report.adpcm.packets, end_us ? report.adpcm_bytes * 8000.0 / end_us : 0.0,
+        (unsigned)ei_sim_config.uart_us_per_char, report.adpcm_worst_us / 1000.0,
+        EI_CLASSIFIER_SLICE_SIZE * 1000.0 / EI_CLASSIFIER_FREQUENCY);
+#endif
+    ei_sim_stats_print("queue wait", &report.queue_wait);
+    ei_sim_stats_print("latency", &report.latency);
+    printf("capture stamps: within %u us of the DMA completion, latency from them p50<=%.3f p90<=%.3f p99<=%.3f ms\n",
+        (unsigned)report.stamp_error_us, ei_latency_percentile_us(&report.capture, 50) / 1000.0,
+        ei_latency_percentile_us(&report.capture, 90) / 1000.0,
+        ei_latency_percentile_us(&report.capture, 99) / 1000.0);
+
+    ei_energy_report_t energy;
+    ei_energy_get_report(&report.energy, &energy);
+    printf("energy: duty %.1f%%, %u uJ per inference, %u uW average (%.1f mJ/h)\n",
+        energy.duty_permille / 10.0, (unsigned)energy.uj_per_inference, (unsigned)energy.avg_uw,
+        energy.avg_uw * 3.6);
+
+    uint64_t us;
+    printf("startup (%s):", sc->staged ? "staged" : "classifier first");
+    for (int ev = 0; ev < EI_STARTUP_N_EVENTS; ev++) {
+        if (ei_startup_get_us((ei_startup_event_t)ev, &us) == 0) {
+            printf(" %s %.3f ms", ei_startup_event_name((ei_startup_event_t)ev), us / 1000.0);
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Longest inference time without any loss, by bisection in steps of 100us
+ */
+static void sweep(audio_scenario_t sc)
+{
+    uint32_t slice_us = (uint32_t)(EI_CLASSIFIER_SLICE_SIZE * 1000000ULL / EI_CLASSIFIER_FREQUENCY);
+    uint32_t lo = 0;
+    uint32_t hi = 4 * slice_us;
+
+    while (hi - lo > 100) {
+        sc.nn_us = lo + (hi - lo) / 2;
+        run(&sc);
+        if (audio_lost(&report) == 0) {
+            lo = sc.nn_us;
+        } else {
+            hi = sc.nn_us;
+        }
+    }
+
+    printf("overrun threshold: inference <= %.1f ms with DSP %.3f ms (slice %.3f ms)\n\n",
+        lo / 1000.0, sc.dsp_us / 1000.0, slice_us / 1000.0);
+    sc.nn_us = lo;
+    print_report(&sc, run(&sc));
+    printf("\n");
+    sc.nn_us = hi;
+    print_report(&sc, run(&sc));
+}
+
+static bool parse_option(audio_scenario_t *sc, const char *arg)
+{
+    unsigned a, b;
+
+    if (sscanf(arg, "load=%u:%u", &a, &b) == 2 && sc->n_loads < MAX_LOADS) {
+        sc->load_period_us[sc->n_loads] = a;
+        sc->load_cpu_us[sc->n_loads] = b;
+        sc->n_loads++;
+        return true;
+    }
+    if (sscanf(arg, "seconds=%u", &a) == 1) { sc->seconds = a; return true; }
+    if (sscanf(arg, "dsp_us=%u", &a) == 1) { sc->dsp_us = a; return true; }
+    if (sscanf(arg, "nn_us=%u", &a) == 1) { sc->nn_us = a; return true; }
+    if (sscanf(arg, "jitter=%u", &a) == 1) { sc->jitter = a; return true; }
+    if (sscanf(arg, "spike_us=%u", &a) == 1) { sc->spike_us = a; return true; }
+    if (sscanf(arg, "spike_every=%u", &a) == 1) { sc->spike_every = a; return true; }
+    if (sscanf(arg, "seed=%u", &a) == 1) { sc->seed = a; return true; }
+    if (sscanf(arg, "sweep=%u", &a) == 1) { sc->sweep = (a != 0); return true; }
+    if (sscanf(arg, "init_us=%u", &a) == 1) { sc->init_us = a; return true; }
+    if (sscanf(arg, "staged=%u", &a) == 1) { sc->staged = (a != 0); return true; }
+    if (sscanf(arg, "isr_us=%u", &a) == 1) { ei_sim_config.i2s_isr_us = a; return true; }
+    if (sscanf(arg, "uart_us=%u", &a) == 1) { ei_sim_config.uart_us_per_char = a; return true; }
+    if (sscanf(arg, "echo=%u", &a) == 1) { ei_sim_config.echo = (a != 0); return true; }
+    if (sscanf(arg, "cache=%u", &a) == 1) { sc->cache = (a != 0); return true; }
+    if (sscanf(arg, "max_stride=%u", &a) == 1) { sc->max_stride = a; return true; }
+
+    return false;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+    clock_t start = clock();
+
+    for (int ix = 1; ix < argc; ix++) {
+        if (!parse_option(&scenario, argv[ix])) {
+            printf("unknown option %s, see the top of ei_sim_audio.cpp\n", argv[ix]);
+            return 1;
+        }
+    }
+
+    if (scenario.sweep) {
+        sweep(scenario);
+    } else {
+        print_report(&scenario, run(&scenario));
+    }
+
+    printf("host time %.3f s\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+
+    return 0;
+}
@@ -0,0 +1,564 @@
+/* Simulation of the ble_accelerometer inference task. The unmodified
+ * ei_tirtos_task.c and ei_imu_minimal.c run against a simulated BMI160 and
+ * Task_sleep on virtual ticks; ei_infer is replaced by injected DSP and
+ * inference durations. Reports the achieved sample period and jitter, the
+ * time to fill a window and the latency of the results, optionally with a
+ * higher priority load such as the BLE stack. Float windows are compared with
+ * the simulated acceleration on the nominal grid of the model, starting at the
+ * first sample of the window, to show the error of the sampling time base.
+ * With EI_IMU_STEPPED_INFERENCE the injected times run as the steps of
+ * ei_step_exec.c, on the virtual clock and with the yield of the task.
+ * With EI_IMU_INT8_INPUT the float window of the same reads is rebuilt from
+ * the sample times, and the int8 window is checked against ei_quantize_f32 of
+ * it and, dequantized as ei_infer_i8 hands it to the SDK, against the floats.
+ *
+ * Options, as name=value:
+ *  seconds=60        virtual time to simulate
+ *  dsp_us=2000       DSP time per window
+ *  nn_us=10000       inference time per window
+ *  jitter=0          +/- percent of variation of both
+ *  dsp_blocks=1      DSP steps the DSP time is split into, stepped inference
+ *  imu_read_us=400   blocking I2C transfer per sensor read
+ *  imu_jitter=0      +/- percent of variation of the transfer
+ *  init_us=0         run_classifier_init, spent by the first inference
+ *  tick_us=10        Clock_tickPeriod, 10 in the BLE stack configuration
+ *  uart_us=87        per character printed, 115200 baud
+ *  shake=P:D         shake the accelerometer for D ms every P ms
+ *  load=P:C          higher priority load of C us every P us, repeatable
+ *  seed=1            of the jitter
+ *  echo=0            print the output of the task
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "ei_sim_kernel.h"
+#include "ei_sim_shims.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+#include "ei_infer_minimal.h"
+#include "model-parameters/model_metadata.h"
+#include "ei_step_exec.h"
+#include <ti/sysbios/knl/Clock.h>
+
+#define MAX_LOADS   8
+
+extern "C" void ei_create_task(void);
+
+#if EI_IMU_ENERGY
+#include "ei_energy.h"
+
+extern "C" int ei_imu_energy(ei_energy_report_t *out);
+#endif
+
+#if EI_IMU_CASCADE
+#include "ei_cascade.h"
+
+extern "C" int ei_imu_cascade(ei_cascade_t *out);
+#endif
+
+#if EI_IMU_STARTUP_TRACE
+#include "ei_startup.h"
+#endif
+
+#if EI_IMU_LATENCY
+#include "ei_latency.h"
+
+extern "C" int ei_imu_latency(ei_latency_t *out);
+#endif
+
+#if EI_IMU_SAMPLE_RATE
+#include "ei_sample_rate.h"
+
+extern "C" int imu_sample_rate(ei_sample_rate_stats_t *out);
+#endif
+
+#define CONVERT_G_TO_MS2    9.80665f
+
+typedef struct {
+    uint32_t seconds;
+    uint32_t dsp_us;
+    uint32_t nn_us;
+    uint32_t jitter;
+    uint32_t seed;
+    uint32_t init_us;
+    uint32_t dsp_blocks;
+    uint32_t load_period_us[MAX_LOADS];
+    uint32_t load_cpu_us[MAX_LOADS];
+    int n_loads;
+} ble_scenario_t;
+
+typedef struct {
+    uint32_t results;
+    uint64_t cpu_us;
+    uint32_t window_samples;    // accelerometer samples since the last inference
+    uint64_t first_us;          // of the current window
+    uint64_t last_us;           // latest accelerometer sample
+    ei_sim_stats_t interval;    // between samples of one window
+    ei_sim_stats_t fill;        // first to last sample of a window
+    ei_sim_stats_t latency;     // last sample -> result
+    ei_sim_stats_t samples;     // per window, stored as "us" in the histogram
+    uint32_t error_windows;
+    double error_sq;            // window against the signal on the nominal grid, in (m/s2)^2
+    uint64_t error_n;
+    double error_max;
+    uint64_t sample_us[EI_CLASSIFIER_RAW_SAMPLE_COUNT];     // of the accelerometer reads of the window
+    uint32_t i8_windows;
+    uint64_t i8_values;
+    uint32_t i8_mismatch;       // int8 values that differ from quantizing the float window
+    uint32_t i8_saturated;      // float values outside the int8 range
+    double i8_error_sq;         // dequantized against the float window, in (m/s2)^2
+    double i8_error_max;        // of the values that are not saturated
+} ble_report_t;
+
+/* Private variables ------------------------------------------------------- */
+static ble_scenario_t scenario = { 60, 2000, 10000, 0, 1, 0, 1, { 0 }, { 0 }, 0 };
+static ble_report_t report;
+static ei_step_exec_t step_exec;
+static bool stepped_ready = false;
+static uint32_t step_dsp_us;            // of the current inference, per DSP step
+static uint32_t step_nn_us;
+static bool classifier_ready = false;
+
+/* Private functions ------------------------------------------------------- */
+
+static void imu_sampled(int channel, uint64_t at_us)
+{
+    if (channel != 0) {
+        return;
+    }
+    if (report.window_samples == 0) {
+        report.first_us = at_us;
+    } else {
+        ei_sim_stats_add(&report.interval, at_us - report.last_us);
+    }
+    if (report.window_samples < EI_CLASSIFIER_RAW_SAMPLE_COUNT) {
+        report.sample_us[report.window_samples] = at_us;
+    }
+    report.last_us = at_us;
+    report.window_samples++;
+}
+
+/**
+ * @brief Compare a window with the acceleration at the times the impulse
+ * assumes: row k at k intervals after the first sample of the window
+ */
+static void check_window(const float *data, size_t len)
+{
+#if !EI_IMU_WINDOW_STATS
+    float expected[3];
+    size_t rows = len / EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME;
+
+    if (report.window_samples == 0) {
+        return;
+    }
+    for (size_t row = 0; row < rows; row++) {
+        ei_sim_imu_signal(report.first_us + (uint64_t)row * EI_CLASSIFIER_INTERVAL_MS * 1000, expected);
+        for (int axis = 0; axis < 3; axis++) {
+            double error = data[row * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME + axis] - expected[axis] * CONVERT_G_TO_MS2;
+            report.error_sq += error * error;
+            report.error_n++;
+            if (fabs(error) > report.error_max) {
+                report.error_max = fabs(error);
+            }
+        }
+    }
+    report.error_windows++;
+#endif
+}
+
+#if EI_IMU_INT8_INPUT
+/**
+ * @brief Replay the reads of the window through the float and the int8 path:
+ * the int8 window must be ei_quantize_f32 of the floats, and dequantized in
+ * the chunks the SDK reads (i8_get_data) within half a step of them
+ */
+static void check_window_i8(const int8_t *data, size_t len, const ei_quant_params_t *params)
+{
+    const size_t chunk = 32;
+    float floats[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME];
+    float dequantized[chunk];
+    int8_t quantized[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME];
+    float window[EI_CLASSIFIER_NN_INPUT_FRAME_SIZE];
+
+    if (report.window_samples * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME < len) {
+        return;
+    }
+    for (size_t row = 0; row < len / EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME; row++) {
+        // what bmi160_getData returned, converted as imu_sample does
+        ei_sim_imu_signal(report.sample_us[row], floats);
+        for (int axis = 0; axis < EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME; axis++) {
+            floats[axis] *= CONVERT_G_TO_MS2;
+            window[row * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME + axis] = floats[axis];
+        }
+        ei_quantize_f32(floats, quantized, EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME, params);
+        for (int axis = 0; axis < EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME; axis++) {
+            if (quantized[axis] != data[row * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME + axis]) {
+                report.i8_mismatch++;
+            }
+        }
+    }
+
+    for (size_t offset = 0; offset < len; offset += chunk) {
+        size_t n = (len - offset < chunk) ? len - offset : chunk;
+        ei_dequantize_i8(&data[offset], dequantized, n, params);
+        for (size_t ix = 0; ix < n; ix++) {
+            float real = window[offset + ix];
+            double error = fabs(dequantized[ix] - real);
+            report.i8_values++;
+            if (real * params->inv_scale + params->zero_point > 127.5f
+                || real * params->inv_scale + params->zero_point < -128.5f) {
+                report.i8_saturated++;
+                continue;
+            }
+            report.i8_error_sq += error * error;
+            if (error > report.i8_error_max) {
+                report.i8_error_max = error;
+            }
+        }
+    }
+    report.i8_windows++;
+}
+#endif
+
+static int sim_step_dsp(void *ctx, uint32_t block_ix)
+{
+    ei_sim_busy(step_dsp_us);
+    return 0;
+}
+
+static int sim_step_classify(void *ctx, uint32_t arg)
+{
+    ei_sim_busy(step_nn_us);
+    return 0;
+}
+
+static void print_steps(void)
+{
+    printf("steps: budget %u us, %u passes, %u yields, %u over budget, longest burst %.3f ms\n",
+        (unsigned)step_exec.budget_us, (unsigned)step_exec.passes, (unsigned)step_exec.yields,
+        (unsigned)step_exec.overruns, step_exec.worst_burst_us / 1000.0);
+    for (uint8_t ix = 0; ix < step_exec.n_steps; ix++) {
+        const ei_step_t *step = &step_exec.steps[ix];
+        printf("  %s %u: worst %.3f ms, avg %.3f ms\n", step->name, (unsigned)step->arg, step->worst_us / 1000.0,
+            step->runs ? step->total_us / 1000.0 / step->runs : 0.0);
+    }
+}
+
+/**
+ * @brief Spend the injected DSP and inference time, and account for the window
+ */
+static ei_impulse_result_t simulate_inference(bool stepped)
+{
+    ei_impulse_result_t result;
+    uint32_t dsp_us = ei_sim_jitter(scenario.dsp_us, scenario.jitter);
+    uint32_t nn_us = ei_sim_jitter(scenario.nn_us, scenario.jitter);
+
+    if (report.window_samples > 0) {
+        ei_sim_stats_add(&report.fill, report.last_us - report.first_us);
+        ei_sim_stats_add(&report.samples, report.window_samples);
+    }
+
+    ei_infer_prepare();
+
+    if (stepped) {
+        // wall time of the steps, the load preempting them is part of it as on target
+        step_dsp_us = dsp_us / scenario.dsp_blocks;
+        step_nn_us = nn_us;
+        if (ei_step_exec_run(&step_exec) != 0) {
+            printf("step executor failed\n");
+            exit(1);
+        }
+    } else {
+        ei_sim_busy(dsp_us);
+        ei_sim_busy(nn_us);
+    }
+
+    memset(&result, 0, sizeof(result));
+    result.timing.dsp = (int)(dsp_us / 1000);
+    result.timing.classification = (int)(nn_us / 1000);
+    result.classification[0].label = "idle";
+    result.classification[0].value = 1.0f;
+    result.label_detected = true;
+
+    report.cpu_us += dsp_us + nn_us;
+    report.results++;
+    if (report.window_samples > 0) {
+        ei_sim_stats_add(&report.latency, ei_sim_now_us() - report.last_us);
+    }
+    report.window_samples = 0;
+
+    return result;
+}
+
+static void ble_task(void *arg)
+{
+    Task_Struct *task = ei_sim_constructed_task();
+
+    task->fxn(task->arg0, task->arg1);
+}
+
+static void print_report(uint64_t end_us)
+{
+    printf("window %u samples every %.3f ms (%.3f ms), DSP %.3f ms, inference %.3f ms, jitter %u%%\n",
+        (unsigned)EI_CLASSIFIER_RAW_SAMPLE_COUNT, (double)EI_CLASSIFIER_INTERVAL_MS,
+        EI_CLASSIFIER_RAW_SAMPLE_COUNT * (double)EI_CLASSIFIER_INTERVAL_MS,
+        scenario.dsp_us / 1000.0, scenario.nn_us / 1000.0, (unsigned)scenario.jitter);
+    printf("results %u, cpu %.1f%% of %.3f s, %u lines printed, tick %u us\n", report.results,
+        end_us ? 100.0 * report.cpu_us / end_us : 0.0, end_us / 1e6, ei_sim_print_lines(),
+        (unsigned)Clock_tickPeriod);
+    if (report.samples.count > 0) {
+        printf("samples per window: min %llu, max %llu\n",
+            (unsigned long long)report.samples.best, (unsigned long long)report.samples.worst);
+    }
+    ei_sim_stats_print("sample interval", &report.interval);
+    ei_sim_stats_print("window fill", &report.fill);
+    ei_sim_stats_print("latency", &report.latency);
+    if (stepped_ready) {
+        print_steps();
+    }
+    if (report.error_n > 0) {
+        printf("window error: rms %.4f, max %.4f m/s2 over %u windows\n", sqrt(report.error_sq / report.error_n),
+            report.error_max, (unsigned)report.error_windows);
+    }
+#if EI_IMU_INT8_INPUT
+    if (report.i8_windows > 0) {
+        uint64_t n = report.i8_values - report.i8_saturated;
+        printf("int8 window: %u windows, %u of %llu values differ from the float path, %u saturated, "
+               "dequantized error rms %.4f, max %.4f m/s2 (half a step %.4f)\n",
+            (unsigned)report.i8_windows, (unsigned)report.i8_mismatch, (unsigned long long)report.i8_values,
+            (unsigned)report.i8_saturated, n ? sqrt(report.i8_error_sq / n) : 0.0, report.i8_error_max,
+            EI_CLASSIFIER_TFLITE_INPUT_SCALE / 2.0);
+    }
+#endif
+#if EI_IMU_SAMPLE_RATE
+    ei_sample_rate_stats_t rate;
+    if (imu_sample_rate(&rate) == 0) {
+        printf("task sample rate: %.3f Hz, interval %.1f us (drift %d ppm), mean %.1f us, jitter %.1f us, "
+               "min %u, max %u, %u intervals, %u gaps\n", rate.rate_hz, rate.interval_us, (int)rate.drift_ppm,
+            rate.mean_us, rate.jitter_us, (unsigned)rate.min_us, (unsigned)rate.max_us,
+            (unsigned)rate.intervals, (unsigned)rate.gaps);
+    }
+#endif
+#if EI_IMU_ENERGY
+    ei_energy_report_t energy;
+    ei_imu_energy(&energy);
+    printf("energy: duty %.1f%%, %u uJ per inference, %u uW average (%.1f mJ/h)\n",
+        energy.duty_permille / 10.0, (unsigned)energy.uj_per_inference, (unsigned)energy.avg_uw,
+        energy.avg_uw * 3.6);
+    for (int state = 0; state < EI_ENERGY_N_STATES; state++) {
+        printf("  %-8s %.3f s\n", ei_energy_state_name((ei_energy_state_t)state), energy.time_us[state] / 1e6);
+    }
+#endif
+#if EI_IMU_CASCADE
+    ei_cascade_t cascade;
+    ei_imu_cascade(&cascade);
+    printf("cascade: %u of %u windows passed, %u classified, %u detections\n", (unsigned)cascade.passed,
+        (unsigned)cascade.inputs, (unsigned)cascade.stage2.runs, (unsigned)cascade.detections);
+#endif
+#if EI_IMU_LATENCY
+    ei_latency_t latency;
+    ei_imu_latency(&latency);
+    printf("task latency: n=%u min=%.3f avg=%.3f p50<=%.3f p99<=%.3f max=%.3f ms\n", (unsigned)latency.count,
+        latency.count ? latency.min_us / 1000.0 : 0.0, ei_latency_avg_us(&latency) / 1000.0,
+        ei_latency_percentile_us(&latency, 50) / 1000.0, ei_latency_percentile_us(&latency, 99) / 1000.0,
+        latency.max_us / 1000.0);
+#endif
+#if EI_IMU_STARTUP_TRACE
+    uint64_t us;
+    printf("startup:");
+    for (int ev = 0; ev < EI_STARTUP_N_EVENTS; ev++) {
+        if (ei_startup_get_us((ei_startup_event_t)ev, &us) == 0) {
+            printf(" %s %.3f ms", ei_startup_event_name((ei_startup_event_t)ev), us / 1000.0);
+        }
+    }
+    printf("\n");
+#endif
+}
+
+static bool parse_option(const char *arg)
+{
+    unsigned a, b;
+
+    if (sscanf(arg, "load=%u:%u", &a, &b) == 2 && scenario.n_loads < MAX_LOADS) {
+        scenario.load_period_us[scenario.n_loads] = a;
+        scenario.load_cpu_us[scenario.n_loads] = b;
+        scenario.n_loads++;
+        return true;
+    }
+    if (sscanf(arg, "shake=%u:%u", &a, &b) == 2 && a > 0) {
+        ei_sim_config.shake_every_us = a * 1000;
+        ei_sim_config.shake_us = b * 1000;
+        return true;
+    }
+    if (sscanf(arg, "seconds=%u", &a) == 1) { scenario.seconds = a; return true; }
+    if (sscanf(arg, "dsp_us=%u", &a) == 1) { scenario.dsp_us = a; return true; }
+    if (sscanf(arg, "nn_us=%u", &a) == 1) { scenario.nn_us = a; return true; }
+    if (sscanf(arg, "jitter=%u", &a) == 1) { scenario.jitter = a; return true; }
+    if (sscanf(arg, "seed=%u", &a) == 1) { scenario.seed = a; return true; }
+    if (sscanf(arg, "imu_read_us=%u", &a) == 1) { ei_sim_config.imu_read_us = a; return true; }
+    if (sscanf(arg, "imu_jitter=%u", &a) == 1) { ei_sim_config.imu_read_jitter = a; return true; }
+    if (sscanf(arg, "init_us=%u", &a) == 1) { scenario.init_us = a; return true; }
+    if (sscanf(arg, "dsp_blocks=%u", &a) == 1 && a > 0 && a < EI_STEP_MAX_STEPS) {
+        scenario.dsp_blocks = a;
+        return true;
+    }
+    if (sscanf(arg, "tick_us=%u", &a) == 1 && a > 0) { Clock_tickPeriod = a; return true; }
+    if (sscanf(arg, "uart_us=%u", &a) == 1) { ei_sim_config.uart_us_per_char = a; return true; }
+    if (sscanf(arg, "echo=%u", &a) == 1) { ei_sim_config.echo = (a != 0); return true; }
+
+    return false;
+}
+
+/* Public functions: replacements of ei_infer_minimal.cpp ------------------ */
+
+extern "C" void ei_init(void)
+{
+}
+
+extern "C" void ei_infer_prepare(void)
+{
+    if (classifier_ready) {
+        return;
+    }
+    // classifier_init_once in ei_infer_minimal.cpp
+    ei_sim_busy(scenario.init_us);
+    classifier_ready = true;
+#if EI_IMU_STARTUP_TRACE
+    ei_startup_mark(EI_STARTUP_CLASSIFIER_READY);
+#endif
+}
+
+extern "C" ei_impulse_result_t ei_infer(float *data, size_t len, bool debug)
+{
+    check_window(data, len);
+    return simulate_inference(false);
+}
+
+#if EI_IMU_INT8_INPUT
+extern "C" ei_impulse_result_t ei_infer_i8(const int8_t *data, size_t len, const ei_quant_params_t *params, bool debug)
+{
+    check_window_i8(data, len, params);
+    return simulate_inference(false);
+}
+#endif
+
+extern "C" int ei_infer_stepped_init(uint32_t budget_us, void (*yield)(void))
+{
+    // one step per DSP block and one for the classifier, as ei_infer_minimal.cpp
+    if (ei_step_exec_init(&step_exec, budget_us, ei_sim_now_us, yield, NULL) != 0) {
+        return -1;
+    }
+    for (uint32_t ix = 0; ix < scenario.dsp_blocks; ix++) {
+        if (ei_step_exec_add(&step_exec, "dsp", sim_step_dsp, ix) != 0) {
+            return -1;
+        }
+    }
+    stepped_ready = true;
+
+    return ei_step_exec_add(&step_exec, "classify", sim_step_classify, 0);
+}
+
+extern "C" void ei_infer_stepped_set_features(float *features)
+{
+}
+
+extern "C" ei_impulse_result_t ei_infer_stepped(float *data, size_t len, bool debug)
+{
+    check_window(data, len);
+    return simulate_inference(true);
+}
+
+extern "C" void ei_infer_stepped_print_stats(void)
+{
+    ei_printf("Steps (budget %u us, %u yields, %u over budget, longest burst %u us):\r\n",
+        (unsigned)step_exec.budget_us, (unsigned)step_exec.yields,
+        (unsigned)step_exec.overruns, (unsigned)step_exec.worst_burst_us);
+    for (uint8_t ix = 0; ix < step_exec.n_steps; ix++) {
+        const ei_step_t *step = &step_exec.steps[ix];
+        ei_printf("    %s %u: \tlast %u us, worst %u us, avg %u us\r\n",
+            step->name, (unsigned)step->arg, (unsigned)step->last_us, (unsigned)step->worst_us,
+            (unsigned)(step->runs ? step->total_us / step->runs : 0));
+    }
+}
+
+extern "C" void ei_set_output(ei_output_format_t format, float threshold)
+{
+}
+
+extern "C" int Serial_In(char *buf, int length)
+{
+    return 0;
+}
+
+extern "C" void Serial_Out(char *string, int length)
+{
+    ei_sim_uart_write((size_t)length);
+}
+
+extern "C" void Serial_Printf(const char *format, ...)
+{
+    char buf[256];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    ei_printf("%s", buf);
+}
+
+extern "C" uint64_t Timer_getMs(void)
+{
+    return ei_sim_now_us() / 1000;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+    clock_t start = clock();
+
+    for (int ix = 1; ix < argc; ix++) {
+        if (!parse_option(argv[ix])) {
+            printf("unknown option %s, see the top of ei_sim_ble.cpp\n", argv[ix]);
+            return 1;
+        }
+    }
+    ei_sim_reset((uint64_t)scenario.seconds * 1000000ULL, scenario.seed);
+    ei_sim_shims_reset();
+    for (int ix = 0; ix < scenario.n_loads; ix++) {
+        ei_sim_add_load(scenario.load_period_us[ix], scenario.load_cpu_us[ix]);
+    }
+
+    ei_sim_imu_hook(imu_sampled);
+    ei_create_task();
+    print_report(ei_sim_run(ble_task, NULL));
+
+    printf("host time %.3f s\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+
+    return 0;
+}
@@ -0,0 +1,312 @@
+/* Discrete-event kernel of the host simulator. See ei_sim_kernel.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stdio.h>
+#include <setjmp.h>
+#include <queue>
+#include <vector>
+
+#include "ei_sim_kernel.h"
+
+#define MAX_LOADS           8
+
+typedef struct {
+    uint64_t at_us;
+    uint64_t order;
+    ei_sim_event_fn_t fn;
+    void *ctx;
+} sim_event_t;
+
+struct sim_event_later {
+    bool operator()(const sim_event_t &a, const sim_event_t &b) const
+    {
+        return (a.at_us != b.at_us) ? (a.at_us > b.at_us) : (a.order > b.order);
+    }
+};
+
+typedef struct {
+    uint32_t period_us;
+    uint32_t cpu_us;
+} sim_load_t;
+
+/* Private variables ------------------------------------------------------- */
+static jmp_buf ei_sim_end;      // the task leaves through here at the end of the simulation
+
+static std::priority_queue<sim_event_t, std::vector<sim_event_t>, sim_event_later> events;
+static uint64_t now_us;
+static uint64_t end_us;
+static uint64_t order;
+static uint64_t cpu_free_us;        // end of the preemption by events
+static uint32_t rng;
+static sim_load_t loads[MAX_LOADS];
+static int n_loads;
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief Advance to and run the next event, leaves the simulation at its end
+ */
+static void run_next_event(void)
+{
+    sim_event_t ev = events.top();
+
+    if (ev.at_us > end_us) {
+        now_us = end_us;
+        longjmp(ei_sim_end, 1);
+    }
+    events.pop();
+    now_us = ev.at_us;
+    ev.fn(ev.ctx);
+}
+
+/**
+ * @brief The task is ready: wait until the CPU is no longer used by events
+ */
+static void resume_task(void)
+{
+    while (cpu_free_us > now_us) {
+        if (!events.empty() && events.top().at_us <= cpu_free_us) {
+            run_next_event();
+        } else {
+            now_us = cpu_free_us;
+        }
+    }
+}
+
+static void load_event(void *ctx)
+{
+    sim_load_t *load = (sim_load_t *)ctx;
+
+    ei_sim_preempt(load->cpu_us);
+    ei_sim_schedule(now_us + load->period_us, load_event, load);
+}
+
+static void wake_event(void *ctx)
+{
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Clear all events and loads, restart the clock at 0
+ *
+ * @param end virtual time in us at which the task is stopped, see ei_sim_run
+ *
+ * @param seed of ei_sim_random
+ */
+extern "C" void ei_sim_reset(uint64_t end, uint32_t seed)
+{
+    events = std::priority_queue<sim_event_t, std::vector<sim_event_t>, sim_event_later>();
+    now_us = 0;
+    end_us = end;
+    order = 0;
+    cpu_free_us = 0;
+    rng = seed ? seed : 1;
+    n_loads = 0;
+}
+
+/**
+ * @brief Run the simulated task until the end time set with ei_sim_reset.
+ * The task never returns by itself: it is left with a longjmp from the
+ * blocking call that crosses the end time, so keep objects with destructors
+ * out of the task.
+ *
+ * @return uint64_t, virtual time reached
+ */
+extern "C" uint64_t ei_sim_run(void (*task)(void *arg), void *arg)
+{
+    if (setjmp(ei_sim_end) == 0) {
+        task(arg);
+    }
+    return now_us;
+}
+
+extern "C" uint64_t ei_sim_now_us(void)
+{
+    return now_us;
+}
+
+/**
+ * @brief Run fn(ctx) at at_us, events at the same time run in scheduling order
+ */
+extern "C" void ei_sim_schedule(uint64_t at_us, ei_sim_event_fn_t fn, void *ctx)
+{
+    sim_event_t ev = { at_us < now_us ? now_us : at_us, order++, fn, ctx };
+    events.push(ev);
+}
+
+/**
+ * @brief Called from an event: it used cpu_us of CPU time, during which the
+ * task does not run. Preemptions queue up behind each other.
+ */
+extern "C" void ei_sim_preempt(uint32_t cpu_us)
+{
+    cpu_free_us = ((cpu_free_us > now_us) ? cpu_free_us : now_us) + cpu_us;
+}
+
+/**
+ * @brief Add a periodic source of higher priority CPU load, e.g. a timer
+ * interrupt or the BLE stack handling connection events
+ *
+ * @return int, 0 => OK
+ */
+extern "C" int ei_sim_add_load(uint32_t period_us, uint32_t cpu_us)
+{
+    if (n_loads == MAX_LOADS || period_us == 0) {
+        return -1;
+    }
+    loads[n_loads].period_us = period_us;
+    loads[n_loads].cpu_us = cpu_us;
+    ei_sim_schedule(now_us + period_us, load_event, &loads[n_loads]);
+    n_loads++;
+
+    return 0;
+}
+
+/**
+ * @brief The task computes for cpu_us, events that happen meanwhile preempt it
+ */
+extern "C" void ei_sim_busy(uint32_t cpu_us)
+{
+    uint64_t work = cpu_us;
+
+    resume_task();
+    while (work > 0) {
+        if (events.empty() || now_us + work <= events.top().at_us) {
+            now_us += work;
+            if (now_us > end_us) {
+                now_us = end_us;
+                longjmp(ei_sim_end, 1);
+            }
+            return;
+        }
+        work -= events.top().at_us - now_us;
+        run_next_event();
+        resume_task();
+    }
+}
+
+/**
+ * @brief Block the task until ready(ctx) returns true
+ *
+ * @return int, 0 => OK, -1 if nothing is left that could make it ready
+ */
+extern "C" int ei_sim_block(bool (*ready)(void *ctx), void *ctx)
+{
+    while (!ready(ctx)) {
+        if (events.empty()) {
+            return -1;
+        }
+        run_next_event();
+    }
+    resume_task();
+
+    return 0;
+}
+
+/**
+ * @brief Block the task until at_us
+ */
+extern "C" void ei_sim_sleep_until(uint64_t at_us)
+{
+    if (at_us > now_us) {
+        ei_sim_schedule(at_us, wake_event, NULL);
+        while (now_us < at_us) {
+            run_next_event();
+        }
+    }
+    resume_task();
+}
+
+/**
+ * @brief Deterministic pseudo random numbers (xorshift32)
+ */
+extern "C" uint32_t ei_sim_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/**
+ * @brief us with a uniform variation of +/- percent
+ */
+extern "C" uint32_t ei_sim_jitter(uint32_t us, uint32_t percent)
+{
+    if (percent == 0 || us == 0) {
+        return us;
+    }
+    int64_t span = (int64_t)us * percent / 100;
+    int64_t offset = (int64_t)(ei_sim_random() % (uint32_t)(2 * span + 1)) - span;
+
+    return (uint32_t)((int64_t)us + offset);
+}
+
+extern "C" void ei_sim_stats_add(ei_sim_stats_t *stats, uint64_t value_us)
+{
+    uint32_t bucket = 0;
+
+    while (bucket < 31 && (value_us >> (bucket + 1)) != 0) {
+        bucket++;
+    }
+    if (stats->count == 0 || value_us < stats->best) {
+        stats->best = value_us;
+    }
+    if (value_us > stats->worst) {
+        stats->worst = value_us;
+    }
+    stats->count++;
+    stats->total += value_us;
+    stats->hist[bucket]++;
+}
+
+/**
+ * @brief Upper bound of the bucket holding the given percentile
+ */
+extern "C" uint64_t ei_sim_stats_percentile(const ei_sim_stats_t *stats, uint32_t percent)
+{
+    uint64_t needed = ((uint64_t)stats->count * percent + 99) / 100;
+    uint64_t seen = 0;
+
+    for (uint32_t bucket = 0; bucket < 32; bucket++) {
+        seen += stats->hist[bucket];
+        if (seen >= needed && seen > 0) {
+            uint64_t upper = (2ULL << bucket) - 1;
+            return (upper < stats->worst) ? upper : stats->worst;
+        }
+    }
+    return stats->worst;
+}
+
+extern "C" void ei_sim_stats_print(const char *name, const ei_sim_stats_t *stats)
+{
+    if (stats->count == 0) {
+        printf("%-20s no samples\n", name);
+        return;
+    }
+    printf("%-20s n=%u min=%.3f avg=%.3f p99<=%.3f max=%.3f ms\n", name, stats->count,
+        stats->best / 1000.0, (double)stats->total / stats->count / 1000.0,
+        ei_sim_stats_percentile(stats, 99) / 1000.0, stats->worst / 1000.0);
+}
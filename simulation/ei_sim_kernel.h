@@ -0,0 +1,76 @@
+/* Discrete-event kernel of the host simulator. A single simulated task (the
+ * inference thread of an example) runs against virtual time: blocking calls
+ * of the shimmed TI-RTOS / POSIX APIs advance the clock to the next event
+ * instead of waiting, and interrupt handlers and higher priority tasks are
+ * events that preempt the task for a given CPU time. Events at the same time
+ * run in the order they were scheduled, so every run is reproducible.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_SIM_KERNEL_H
+#define EI_SIM_KERNEL_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*ei_sim_event_fn_t)(void *ctx);
+
+/** Latency statistics, all values in us */
+typedef struct {
+    uint32_t count;
+    uint64_t total;
+    uint64_t worst;
+    uint64_t best;
+    uint32_t hist[32];          // bucket n counts values in [2^n, 2^(n+1)) us
+} ei_sim_stats_t;
+
+/* Function prototypes ----------------------------------------------------- */
+void ei_sim_reset(uint64_t end_us, uint32_t seed);
+uint64_t ei_sim_run(void (*task)(void *arg), void *arg);
+uint64_t ei_sim_now_us(void);
+
+void ei_sim_schedule(uint64_t at_us, ei_sim_event_fn_t fn, void *ctx);
+void ei_sim_preempt(uint32_t cpu_us);
+int ei_sim_add_load(uint32_t period_us, uint32_t cpu_us);
+
+void ei_sim_busy(uint32_t cpu_us);
+int ei_sim_block(bool (*ready)(void *ctx), void *ctx);
+void ei_sim_sleep_until(uint64_t at_us);
+
+uint32_t ei_sim_random(void);
+uint32_t ei_sim_jitter(uint32_t us, uint32_t percent);
+
+void ei_sim_stats_add(ei_sim_stats_t *stats, uint64_t value_us);
+void ei_sim_stats_print(const char *name, const ei_sim_stats_t *stats);
+uint64_t ei_sim_stats_percentile(const ei_sim_stats_t *stats, uint32_t percent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
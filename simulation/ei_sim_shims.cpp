@@ -0,0 +1,631 @@
+/* Simulated peripherals and RTOS services. See ei_sim_shims.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ei_sim_kernel.h"
+#include "ei_sim_shims.h"
+
+#include <mqueue.h>
+#include <ti/drivers/I2S.h>
+#include <ti/drivers/I2C.h>
+#include <ti/drivers/dpl/HwiP.h>
+#include <ti/sysbios/knl/Clock.h>
+#include "AudioCodec.h"
+#include "bmi160.h"
+#include "bmi160_config.h"
+#include "arm_math.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+
+#define MAX_QUEUES          4
+#define MAX_DESCRIPTORS     8
+#define MAX_QUEUE_BYTES     256
+#define MAX_I2S_BUFFERS     8
+
+typedef struct {
+    char name[16];
+    long maxmsg;
+    long msgsize;
+    long head;
+    long count;
+    uint8_t data[MAX_QUEUE_BYTES];
+} sim_queue_t;
+
+typedef struct {
+    sim_queue_t *queue;
+    int flags;
+} sim_descriptor_t;
+
+typedef struct {
+    const void *buf;
+    ei_sim_i2s_buffer_t info;
+} sim_i2s_slot_t;
+
+/* Private variables ------------------------------------------------------- */
+ei_sim_config_t ei_sim_config = { 20, 400, 0, 87, 0, 0, false };
+uint32_t Clock_tickPeriod = 10;
+
+static sim_queue_t queues[MAX_QUEUES];
+static int n_queues;
+static sim_descriptor_t descriptors[MAX_DESCRIPTORS];
+static int n_descriptors;
+
+static struct I2S_Config {
+    I2S_Params params;
+    I2S_Transaction *current;
+    uint8_t channels;
+    uint32_t generation;        // stale completion events of a stopped stream are ignored
+    uint64_t start_us;
+    uint64_t samples;
+    sim_i2s_slot_t slots[MAX_I2S_BUFFERS];
+    int n_slots;
+} i2s;
+
+static Task_Struct *constructed;
+static void (*imu_hook)(int channel, uint64_t at_us);
+static uint32_t print_lines;
+
+/* Private functions ------------------------------------------------------- */
+
+static bool queue_not_empty(void *ctx)
+{
+    return ((sim_queue_t *)ctx)->count > 0;
+}
+
+static bool queue_not_full(void *ctx)
+{
+    sim_queue_t *q = (sim_queue_t *)ctx;
+    return q->count < q->maxmsg;
+}
+
+static int ring_length(void)
+{
+    int n = 0;
+    List_Elem *elem = &i2s.current->queueElement;
+
+    do {
+        n++;
+        elem = elem->next;
+    } while (elem != NULL && elem != &i2s.current->queueElement && n < MAX_I2S_BUFFERS);
+
+    return n;
+}
+
+static uint64_t sample_time_us(uint64_t sample)
+{
+    return i2s.start_us + (sample * 1000000ULL) / i2s.params.samplingFrequency;
+}
+
+static sim_i2s_slot_t *i2s_slot(const void *buf)
+{
+    for (int ix = 0; ix < i2s.n_slots; ix++) {
+        if (i2s.slots[ix].buf == buf) {
+            return &i2s.slots[ix];
+        }
+    }
+    if (i2s.n_slots == MAX_I2S_BUFFERS) {
+        return NULL;
+    }
+    i2s.slots[i2s.n_slots].buf = buf;
+    return &i2s.slots[i2s.n_slots++];
+}
+
+/**
+ * @brief The DMA completed i2s.current: fill it, start the next transaction
+ * and call the read callback, as the TI driver does
+ */
+static void i2s_complete(void *ctx)
+{
+    if ((uintptr_t)ctx != i2s.generation) {
+        return;
+    }
+
+    I2S_Transaction *done = i2s.current;
+    uint32_t frames = (uint32_t)(done->bufSize / (sizeof(int16_t) * i2s.channels));
+    int16_t *samples = (int16_t *)done->bufPtr;
+    sim_i2s_slot_t *slot = i2s_slot(done->bufPtr);
+
+    // a sample counter, so the consumer can tell which samples it got
+    for (uint32_t ix = 0; ix < frames; ix++) {
+        for (uint8_t ch = 0; ch < i2s.channels; ch++) {
+            samples[ix * i2s.channels + ch] = (int16_t)((i2s.samples + ix) & 0x7FFF);
+        }
+    }
+    if (slot != NULL) {
+        slot->info.first_sample = i2s.samples;
+        slot->info.n_samples = frames;
+        slot->info.done_us = ei_sim_now_us();
+        // the DMA comes back to this buffer after the other buffers of the ring
+        slot->info.reuse_us = sample_time_us(i2s.samples + (uint64_t)frames * ring_length());
+    }
+    done->bytesTransferred = done->bufSize;
+    done->numberOfCompletions++;
+    i2s.samples += frames;
+
+    i2s.current = (I2S_Transaction *)done->queueElement.next;
+    ei_sim_preempt(ei_sim_config.i2s_isr_us);
+    if (i2s.params.readCallback != NULL) {
+        i2s.params.readCallback(&i2s, 0, i2s.current);
+    }
+
+    frames = (uint32_t)(i2s.current->bufSize / (sizeof(int16_t) * i2s.channels));
+    ei_sim_schedule(sample_time_us(i2s.samples + frames), i2s_complete, (void *)(uintptr_t)i2s.generation);
+}
+
+/* Public functions: simulator --------------------------------------------- */
+
+/**
+ * @brief Forget all queues, I2S buffers and the constructed task
+ */
+extern "C" void ei_sim_shims_reset(void)
+{
+    memset(queues, 0, sizeof(queues));
+    n_queues = 0;
+    n_descriptors = 0;
+    i2s.generation++;
+    i2s.current = NULL;
+    i2s.n_slots = 0;
+    constructed = NULL;
+    print_lines = 0;
+}
+
+/**
+ * @brief Look up the origin of the samples in a completed I2S buffer
+ *
+ * @return int, 0 => OK, -1 if buf never completed
+ */
+extern "C" int ei_sim_i2s_buffer_info(const void *buf, ei_sim_i2s_buffer_t *info)
+{
+    for (int ix = 0; ix < i2s.n_slots; ix++) {
+        if (i2s.slots[ix].buf == buf && i2s.slots[ix].info.n_samples > 0) {
+            *info = i2s.slots[ix].info;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Called with the virtual time of every IMU sample, channel 0 is the
+ * accelerometer and 1 the gyroscope
+ */
+extern "C" void ei_sim_imu_hook(void (*hook)(int channel, uint64_t at_us))
+{
+    imu_hook = hook;
+}
+
+extern "C" Task_Struct *ei_sim_constructed_task(void)
+{
+    return constructed;
+}
+
+/**
+ * @brief Blocking UART output: the task waits, the CPU is free
+ */
+extern "C" void ei_sim_uart_write(size_t n_chars)
+{
+    ei_sim_sleep_until(ei_sim_now_us() + (uint64_t)n_chars * ei_sim_config.uart_us_per_char);
+}
+
+extern "C" uint32_t ei_sim_print_lines(void)
+{
+    return print_lines;
+}
+
+/* Public functions: POSIX message queues ---------------------------------- */
+
+extern "C" mqd_t mq_open(const char *name, int oflag, ...)
+{
+    sim_queue_t *q = NULL;
+
+    for (int ix = 0; ix < n_queues; ix++) {
+        if (strncmp(queues[ix].name, name, sizeof(queues[ix].name)) == 0) {
+            q = &queues[ix];
+        }
+    }
+    if (q == NULL) {
+        va_list args;
+        struct mq_attr *attr;
+
+        if (!(oflag & O_CREAT) || n_queues == MAX_QUEUES) {
+            errno = ENOENT;
+            return (mqd_t)-1;
+        }
+        va_start(args, oflag);
+        (void)va_arg(args, int);                // mode
+        attr = va_arg(args, struct mq_attr *);
+        va_end(args);
+        if (attr == NULL || attr->mq_maxmsg * attr->mq_msgsize > MAX_QUEUE_BYTES) {
+            errno = EINVAL;
+            return (mqd_t)-1;
+        }
+        q = &queues[n_queues++];
+        strncpy(q->name, name, sizeof(q->name) - 1);
+        q->maxmsg = attr->mq_maxmsg;
+        q->msgsize = attr->mq_msgsize;
+    }
+    if (n_descriptors == MAX_DESCRIPTORS) {
+        errno = EMFILE;
+        return (mqd_t)-1;
+    }
+    descriptors[n_descriptors].queue = q;
+    descriptors[n_descriptors].flags = oflag;
+
+    return n_descriptors++;
+}
+
+extern "C" int mq_send(mqd_t mqdes, const char *msg_ptr, size_t msg_len, unsigned int msg_prio)
+{
+    sim_queue_t *q = descriptors[mqdes].queue;
+
+    if ((long)msg_len > q->msgsize) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    if (q->count == q->maxmsg) {
+        if (descriptors[mqdes].flags & O_NONBLOCK) {
+            errno = EAGAIN;
+            return -1;
+        }
+        if (ei_sim_block(queue_not_full, q) != 0) {
+            errno = EDEADLK;
+            return -1;
+        }
+    }
+    long slot = (q->head + q->count) % q->maxmsg;
+    memcpy(&q->data[slot * q->msgsize], msg_ptr, msg_len);
+    q->count++;
+
+    return 0;
+}
+
+extern "C" ssize_t mq_receive(mqd_t mqdes, char *msg_ptr, size_t msg_len, unsigned int *msg_prio)
+{
+    sim_queue_t *q = descriptors[mqdes].queue;
+
+    if (q->count == 0) {
+        if (descriptors[mqdes].flags & O_NONBLOCK) {
+            errno = EAGAIN;
+            return -1;
+        }
+        if (ei_sim_block(queue_not_empty, q) != 0) {
+            errno = EDEADLK;
+            return -1;
+        }
+    }
+    size_t n = ((long)msg_len < q->msgsize) ? msg_len : (size_t)q->msgsize;
+    memcpy(msg_ptr, &q->data[q->head * q->msgsize], n);
+    q->head = (q->head + 1) % q->maxmsg;
+    q->count--;
+
+    return (ssize_t)n;
+}
+
+extern "C" int mq_getattr(mqd_t mqdes, struct mq_attr *mqstat)
+{
+    sim_queue_t *q = descriptors[mqdes].queue;
+
+    mqstat->mq_flags = descriptors[mqdes].flags & O_NONBLOCK;
+    mqstat->mq_maxmsg = q->maxmsg;
+    mqstat->mq_msgsize = q->msgsize;
+    mqstat->mq_curmsgs = q->count;
+
+    return 0;
+}
+
+/* Public functions: TI drivers -------------------------------------------- */
+
+extern "C" void List_clearList(List_List *list)
+{
+    list->head = NULL;
+    list->tail = NULL;
+}
+
+extern "C" void List_put(List_List *list, List_Elem *elem)
+{
+    elem->next = NULL;
+    elem->prev = list->tail;
+    if (list->tail != NULL) {
+        list->tail->next = elem;
+    } else {
+        list->head = elem;
+    }
+    list->tail = elem;
+}
+
+extern "C" List_Elem *List_head(List_List *list)
+{
+    return list->head;
+}
+
+extern "C" List_Elem *List_tail(List_List *list)
+{
+    return list->tail;
+}
+
+extern "C" List_Elem *List_next(List_Elem *elem)
+{
+    return elem->next;
+}
+
+extern "C" List_Elem *List_prev(List_Elem *elem)
+{
+    return elem->prev;
+}
+
+extern "C" void I2S_init(void)
+{
+}
+
+extern "C" void I2S_Params_init(I2S_Params *params)
+{
+    memset(params, 0, sizeof(I2S_Params));
+    params->samplingFrequency = 8000;
+    params->SD1Channels = I2S_CHANNELS_MONO;
+}
+
+extern "C" I2S_Handle I2S_open(uint_least8_t index, I2S_Params *params)
+{
+    i2s.params = *params;
+    i2s.channels = (params->SD1Channels == I2S_CHANNELS_STEREO) ? 2 : 1;
+
+    return &i2s;
+}
+
+extern "C" void I2S_Transaction_init(I2S_Transaction *transaction)
+{
+    memset(transaction, 0, sizeof(I2S_Transaction));
+}
+
+extern "C" void I2S_setReadQueueHead(I2S_Handle handle, I2S_Transaction *transaction)
+{
+    handle->current = transaction;
+}
+
+extern "C" void I2S_startClocks(I2S_Handle handle)
+{
+}
+
+extern "C" void I2S_stopClocks(I2S_Handle handle)
+{
+}
+
+extern "C" void I2S_startRead(I2S_Handle handle)
+{
+    uint32_t frames = (uint32_t)(handle->current->bufSize / (sizeof(int16_t) * handle->channels));
+
+    handle->generation++;
+    handle->n_slots = 0;
+    handle->start_us = ei_sim_now_us();
+    handle->samples = 0;
+    ei_sim_schedule(sample_time_us(frames), i2s_complete, (void *)(uintptr_t)handle->generation);
+}
+
+extern "C" void I2S_stopRead(I2S_Handle handle)
+{
+    handle->generation++;
+}
+
+extern "C" int_fast8_t AudioCodec_open(void)
+{
+    return AudioCodec_STATUS_SUCCESS;
+}
+
+extern "C" int_fast8_t AudioCodec_config(uint8_t devId, uint8_t bitPrecision, uint16_t sampleRate,
+    uint8_t numChannels, uint8_t speaker, uint8_t mic)
+{
+    return AudioCodec_STATUS_SUCCESS;
+}
+
+extern "C" int_fast8_t AudioCodec_micVolCtrl(uint8_t devId, uint8_t mic, uint8_t volume)
+{
+    return AudioCodec_STATUS_SUCCESS;
+}
+
+extern "C" void I2C_Params_init(I2C_Params *params)
+{
+    memset(params, 0, sizeof(I2C_Params));
+}
+
+extern "C" I2C_Handle I2C_open(uint_least8_t index, I2C_Params *params)
+{
+    static int i2c_dummy;
+    return (I2C_Handle)&i2c_dummy;
+}
+
+extern "C" void init_bmi160(I2C_Handle handle)
+{
+}
+
+/**
+ * @brief The acceleration the simulated BMI160 sees at a time, in g: a slow
+ * 1.5Hz swing around 1g on z, and bursts of shaking (0.5g at 8Hz) every
+ * shake_every_us, if set
+ */
+extern "C" void ei_sim_imu_signal(uint64_t at_us, float *acc_data)
+{
+    double t = at_us / 1e6;
+    acc_data[0] = (float)(0.2 * sin(2 * M_PI * 1.5 * t));
+    acc_data[1] = (float)(0.1 * cos(2 * M_PI * 1.5 * t));
+    acc_data[2] = 1.0f;
+    if (ei_sim_config.shake_every_us > 0 && at_us % ei_sim_config.shake_every_us < ei_sim_config.shake_us) {
+        acc_data[2] += (float)(0.5 * sin(2 * M_PI * 8.0 * t));
+    }
+}
+
+/**
+ * @brief ei_sim_imu_signal at the end of a blocking I2C transfer
+ */
+extern "C" int bmi160_getData(float *acc_data)
+{
+    ei_sim_sleep_until(ei_sim_now_us() + ei_sim_jitter(ei_sim_config.imu_read_us, ei_sim_config.imu_read_jitter));
+
+    ei_sim_imu_signal(ei_sim_now_us(), acc_data);
+    if (imu_hook != NULL) {
+        imu_hook(0, ei_sim_now_us());
+    }
+
+    return 0;
+}
+
+extern "C" int bmi160_getGyroData(float *gyro_data)
+{
+    ei_sim_sleep_until(ei_sim_now_us() + ei_sim_jitter(ei_sim_config.imu_read_us, ei_sim_config.imu_read_jitter));
+
+    gyro_data[0] = 0.0f;
+    gyro_data[1] = 0.0f;
+    gyro_data[2] = 0.0f;
+    if (imu_hook != NULL) {
+        imu_hook(1, ei_sim_now_us());
+    }
+
+    return 0;
+}
+
+/* Public functions: TI-RTOS ----------------------------------------------- */
+
+extern "C" uintptr_t HwiP_disable(void)
+{
+    return 0;
+}
+
+extern "C" void HwiP_restore(uintptr_t key)
+{
+}
+
+extern "C" uint32_t Clock_getTicks(void)
+{
+    return (uint32_t)(ei_sim_now_us() / Clock_tickPeriod);
+}
+
+extern "C" void Task_Params_init(Task_Params *params)
+{
+    memset(params, 0, sizeof(Task_Params));
+    params->priority = 1;
+}
+
+/**
+ * @brief Only recorded, the scenario runs the task with ei_sim_run
+ */
+extern "C" void Task_construct(Task_Struct *task, Task_FuncPtr fxn, const Task_Params *params, void *eb)
+{
+    task->fxn = fxn;
+    task->arg0 = params->arg0;
+    task->arg1 = params->arg1;
+    task->priority = params->priority;
+    constructed = task;
+}
+
+/**
+ * @brief Wake up on the ticks-th tick interrupt from now
+ */
+extern "C" void Task_sleep(uint32_t ticks)
+{
+    if (ticks == 0) {
+        ei_sim_busy(0);
+        return;
+    }
+    uint64_t tick = ei_sim_now_us() / Clock_tickPeriod;
+    ei_sim_sleep_until((tick + ticks) * Clock_tickPeriod);
+}
+
+extern "C" void Task_yield(void)
+{
+    ei_sim_busy(0);
+}
+
+/* Public functions: Edge Impulse porting and CMSIS-DSP -------------------- */
+
+void ei_printf(const char *format, ...)
+{
+    char buf[256];
+    va_list args;
+
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    if (n < 0) {
+        return;
+    }
+    if (ei_sim_config.echo) {
+        printf("[%10.3f ms] %s", ei_sim_now_us() / 1000.0, buf);
+    }
+    print_lines += (strchr(buf, '\n') != NULL);
+    ei_sim_uart_write((size_t)n);
+}
+
+void *ei_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *ei_calloc(size_t nitems, size_t size)
+{
+    return calloc(nitems, size);
+}
+
+void ei_free(void *ptr)
+{
+    free(ptr);
+}
+
+uint64_t ei_read_timer_ms(void)
+{
+    return ei_sim_now_us() / 1000;
+}
+
+uint64_t ei_read_timer_us(void)
+{
+    return ei_sim_now_us();
+}
+
+extern "C" void arm_q15_to_float(const q15_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    for (uint32_t ix = 0; ix < blockSize; ix++) {
+        pDst[ix] = (float32_t)pSrc[ix] / 32768.0f;
+    }
+}
+
+extern "C" void arm_rms_q15(const q15_t *pSrc, uint32_t blockSize, q15_t *pResult)
+{
+    uint64_t sum = 0;
+
+    for (uint32_t ix = 0; ix < blockSize; ix++) {
+        sum += (int32_t)pSrc[ix] * pSrc[ix];
+    }
+    *pResult = (q15_t)sqrt((double)sum / blockSize);
+}
+
+extern "C" void arm_scale_q15(const q15_t *pSrc, q15_t scaleFract, int8_t shift, q15_t *pDst, uint32_t blockSize)
+{
+    for (uint32_t ix = 0; ix < blockSize; ix++) {
+        int32_t v = ((int32_t)pSrc[ix] * scaleFract) >> (15 - shift);
+        pDst[ix] = (q15_t)((v > INT16_MAX) ? INT16_MAX : ((v < INT16_MIN) ? INT16_MIN : v));
+    }
+}
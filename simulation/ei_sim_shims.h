@@ -0,0 +1,75 @@
+/* Simulated peripherals and RTOS services used by the example sources: POSIX
+ * message queues, the I2S driver (buffers complete on virtual time and are
+ * filled with a sample counter), the BMI160 accelerometer, Task_sleep and the
+ * Edge Impulse porting layer. The include directory holds the matching
+ * headers, so the example files are built unmodified.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_SIM_SHIMS_H
+#define EI_SIM_SHIMS_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <ti/sysbios/knl/Task.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Where the samples of a completed I2S buffer came from */
+typedef struct {
+    uint64_t first_sample;      // index of the first sample (frame) since I2S_startRead
+    uint32_t n_samples;
+    uint64_t done_us;           // completion of the DMA transfer
+    uint64_t reuse_us;          // the DMA starts overwriting the buffer
+} ei_sim_i2s_buffer_t;
+
+/** Timing of the simulated peripherals, all in us */
+typedef struct {
+    uint32_t i2s_isr_us;        // I2S interrupt and readCallbackFxn
+    uint32_t imu_read_us;       // blocking I2C transfer of one bmi160_getData
+    uint32_t imu_read_jitter;   // +/- percent of variation of the transfer, e.g. bus load
+    uint32_t uart_us_per_char;  // blocking UART output of ei_printf and Serial_Out
+    uint32_t shake_every_us;    // the accelerometer sees a burst of shaking every ..., 0 => never
+    uint32_t shake_us;          // ... for this long
+    bool echo;                  // print ei_printf output, prefixed with the virtual time
+} ei_sim_config_t;
+
+extern ei_sim_config_t ei_sim_config;
+
+/* Function prototypes ----------------------------------------------------- */
+void ei_sim_shims_reset(void);
+int ei_sim_i2s_buffer_info(const void *buf, ei_sim_i2s_buffer_t *info);
+void ei_sim_imu_hook(void (*hook)(int channel, uint64_t at_us));
+void ei_sim_imu_signal(uint64_t at_us, float *acc_data);
+Task_Struct *ei_sim_constructed_task(void);
+void ei_sim_uart_write(size_t n_chars);
+uint32_t ei_sim_print_lines(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
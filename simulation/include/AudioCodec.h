@@ -0,0 +1,31 @@
+/* Simulator shim: TLV320AIC3254 configuration, accepted and ignored */
+#ifndef EI_SIM_AUDIOCODEC_H
+#define EI_SIM_AUDIOCODEC_H
+
+#include <stdint.h>
+
+#define AudioCodec_STATUS_SUCCESS   0
+#define AudioCodec_TI_3254          0
+#define AudioCodec_16_BIT           16
+#define AudioCodec_MONO             1
+#define AudioCodec_STEREO           2
+#define AudioCodec_SPEAKER_NONE     0
+#define AudioCodec_MIC_NONE         0
+#define AudioCodec_MIC_ONBOARD      1
+#define AudioCodec_MIC_EXTERNAL     2
+#define AudioCodec_MIC_LINE_IN      4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int_fast8_t AudioCodec_open(void);
+int_fast8_t AudioCodec_config(uint8_t devId, uint8_t bitPrecision, uint16_t sampleRate,
+    uint8_t numChannels, uint8_t speaker, uint8_t mic);
+int_fast8_t AudioCodec_micVolCtrl(uint8_t devId, uint8_t mic, uint8_t volume);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
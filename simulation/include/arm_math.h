@@ -0,0 +1,24 @@
+/* Simulator shim: the CMSIS-DSP functions used by the examples, reference C */
+#ifndef EI_SIM_ARM_MATH_H
+#define EI_SIM_ARM_MATH_H
+
+#include <stdint.h>
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+typedef float float32_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void arm_q15_to_float(const q15_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_rms_q15(const q15_t *pSrc, uint32_t blockSize, q15_t *pResult);
+void arm_scale_q15(const q15_t *pSrc, q15_t scaleFract, int8_t shift, q15_t *pDst, uint32_t blockSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
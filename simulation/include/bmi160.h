@@ -0,0 +1,18 @@
+/* Simulator shim: accelerometer of the BOOSTXL-SENSORS, see ei_sim_shims.cpp */
+#ifndef EI_SIM_BMI160_H
+#define EI_SIM_BMI160_H
+
+#include <ti/drivers/I2C.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int bmi160_getData(float *acc_data);
+int bmi160_getGyroData(float *gyro_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
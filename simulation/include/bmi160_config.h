@@ -0,0 +1,17 @@
+/* Simulator shim */
+#ifndef EI_SIM_BMI160_CONFIG_H
+#define EI_SIM_BMI160_CONFIG_H
+
+#include <ti/drivers/I2C.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void init_bmi160(I2C_Handle handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
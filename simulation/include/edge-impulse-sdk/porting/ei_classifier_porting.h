@@ -0,0 +1,24 @@
+/* Simulator shim: Edge Impulse SDK porting layer on virtual time. As in the SDK
+ * these have C++ linkage unless EI_C_LINKAGE=1, so C sources cannot call them */
+#ifndef EI_SIM_CLASSIFIER_PORTING_H
+#define EI_SIM_CLASSIFIER_PORTING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__cplusplus) && EI_C_LINKAGE == 1
+extern "C" {
+#endif
+
+void ei_printf(const char *format, ...);
+void *ei_malloc(size_t size);
+void *ei_calloc(size_t nitems, size_t size);
+void ei_free(void *ptr);
+uint64_t ei_read_timer_ms(void);
+uint64_t ei_read_timer_us(void);
+
+#if defined(__cplusplus) && EI_C_LINKAGE == 1
+}
+#endif
+
+#endif
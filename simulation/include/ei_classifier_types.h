@@ -0,0 +1,31 @@
+/* Simulator shim: the fields of the SDK result used by the examples */
+#ifndef EI_SIM_CLASSIFIER_TYPES_H
+#define EI_SIM_CLASSIFIER_TYPES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "model-parameters/model_metadata.h"
+
+typedef struct {
+    const char *label;
+    float value;
+} ei_impulse_result_classification_t;
+
+typedef struct {
+    int sampling;
+    int dsp;
+    int classification;
+    int anomaly;
+    int64_t dsp_us;
+    int64_t classification_us;
+    int64_t anomaly_us;
+} ei_impulse_result_timing_t;
+
+typedef struct {
+    ei_impulse_result_classification_t classification[EI_CLASSIFIER_LABEL_COUNT];
+    float anomaly;
+    ei_impulse_result_timing_t timing;
+    bool label_detected;
+} ei_impulse_result_t;
+
+#endif
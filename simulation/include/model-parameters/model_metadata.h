@@ -0,0 +1,40 @@
+/* Simulator shim: impulse parameters that shape the timing, override with -D */
+#ifndef EI_SIM_MODEL_METADATA_H
+#define EI_SIM_MODEL_METADATA_H
+
+#ifndef EI_CLASSIFIER_FREQUENCY
+#define EI_CLASSIFIER_FREQUENCY                 16000
+#endif
+#ifndef EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW
+#define EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW   4
+#endif
+#ifndef EI_CLASSIFIER_RAW_SAMPLE_COUNT
+#define EI_CLASSIFIER_RAW_SAMPLE_COUNT          16000
+#endif
+#ifndef EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME
+#define EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME     1
+#endif
+#ifndef EI_CLASSIFIER_INTERVAL_MS
+#define EI_CLASSIFIER_INTERVAL_MS               0.0625
+#endif
+#ifndef EI_CLASSIFIER_LABEL_COUNT
+#define EI_CLASSIFIER_LABEL_COUNT               3
+#endif
+
+#define EI_CLASSIFIER_SLICE_SIZE                (EI_CLASSIFIER_RAW_SAMPLE_COUNT / EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW)
+#define EI_CLASSIFIER_NN_INPUT_FRAME_SIZE       (EI_CLASSIFIER_RAW_SAMPLE_COUNT * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME)
+#define EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE      EI_CLASSIFIER_NN_INPUT_FRAME_SIZE
+#ifndef EI_CLASSIFIER_HAS_ANOMALY
+#define EI_CLASSIFIER_HAS_ANOMALY               0
+#endif
+#ifndef EI_CLASSIFIER_TFLITE_INPUT_QUANTIZED
+#define EI_CLASSIFIER_TFLITE_INPUT_QUANTIZED    0
+#endif
+#ifndef EI_CLASSIFIER_TFLITE_INPUT_SCALE
+#define EI_CLASSIFIER_TFLITE_INPUT_SCALE        0.1f
+#endif
+#ifndef EI_CLASSIFIER_TFLITE_INPUT_ZEROPOINT
+#define EI_CLASSIFIER_TFLITE_INPUT_ZEROPOINT    0
+#endif
+
+#endif
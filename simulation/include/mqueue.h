@@ -0,0 +1,31 @@
+/* Simulator shim: POSIX message queues on virtual time, see ei_sim_shims.cpp */
+#ifndef EI_SIM_MQUEUE_H
+#define EI_SIM_MQUEUE_H
+
+#include <stddef.h>
+#include <fcntl.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int mqd_t;
+
+struct mq_attr {
+    long mq_flags;
+    long mq_maxmsg;
+    long mq_msgsize;
+    long mq_curmsgs;
+};
+
+mqd_t mq_open(const char *name, int oflag, ...);
+int mq_send(mqd_t mqdes, const char *msg_ptr, size_t msg_len, unsigned int msg_prio);
+ssize_t mq_receive(mqd_t mqdes, char *msg_ptr, size_t msg_len, unsigned int *msg_prio);
+int mq_getattr(mqd_t mqdes, struct mq_attr *mqstat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,30 @@
+/* Simulator shim: I2C is only opened, the sensor is simulated in bmi160_getData */
+#ifndef EI_SIM_I2C_H
+#define EI_SIM_I2C_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct I2C_Config *I2C_Handle;
+
+typedef enum { I2C_100kHz = 0, I2C_400kHz = 1 } I2C_BitRate;
+typedef enum { I2C_MODE_BLOCKING = 0, I2C_MODE_CALLBACK = 1 } I2C_TransferMode;
+
+typedef struct {
+    I2C_TransferMode transferMode;
+    void *transferCallbackFxn;
+    I2C_BitRate bitRate;
+} I2C_Params;
+
+void I2C_Params_init(I2C_Params *params);
+I2C_Handle I2C_open(uint_least8_t index, I2C_Params *params);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
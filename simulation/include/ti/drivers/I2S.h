@@ -0,0 +1,64 @@
+/* Simulator shim: I2S driver, buffers complete on virtual time, see ei_sim_shims.cpp */
+#ifndef EI_SIM_I2S_H
+#define EI_SIM_I2S_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <ti/drivers/utils/List.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct I2S_Config *I2S_Handle;
+
+typedef struct {
+    List_Elem queueElement;
+    void *bufPtr;
+    size_t bufSize;
+    size_t bytesTransferred;
+    size_t untransferredBytes;
+    size_t numberOfCompletions;
+} I2S_Transaction;
+
+typedef void (*I2S_Callback)(I2S_Handle handle, int_fast16_t status, I2S_Transaction *transactionPtr);
+
+typedef enum {
+    I2S_CHANNELS_NONE = 0,
+    I2S_CHANNELS_MONO = 1,
+    I2S_CHANNELS_MONO_INV = 2,
+    I2S_CHANNELS_STEREO = 3,
+} I2S_ChannelConfig;
+
+typedef enum {
+    I2S_SD0_DISABLED = 0,
+    I2S_SD0_INPUT,
+    I2S_SD0_OUTPUT,
+} I2S_DataInterfaceUse;
+
+typedef struct {
+    uint32_t samplingFrequency;
+    uint16_t fixedBufferLength;
+    I2S_Callback writeCallback;
+    I2S_Callback readCallback;
+    I2S_Callback errorCallback;
+    I2S_DataInterfaceUse SD0Use;
+    I2S_ChannelConfig SD0Channels;
+    I2S_ChannelConfig SD1Channels;
+} I2S_Params;
+
+void I2S_init(void);
+void I2S_Params_init(I2S_Params *params);
+I2S_Handle I2S_open(uint_least8_t index, I2S_Params *params);
+void I2S_Transaction_init(I2S_Transaction *transaction);
+void I2S_setReadQueueHead(I2S_Handle handle, I2S_Transaction *transaction);
+void I2S_startClocks(I2S_Handle handle);
+void I2S_stopClocks(I2S_Handle handle);
+void I2S_startRead(I2S_Handle handle);
+void I2S_stopRead(I2S_Handle handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,19 @@
+/* Simulator shim: interrupts of the simulator only run between the blocking
+ * calls of a task, so a critical section has nothing to hold off */
+#ifndef EI_SIM_HWIP_H
+#define EI_SIM_HWIP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uintptr_t HwiP_disable(void);
+void HwiP_restore(uintptr_t key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
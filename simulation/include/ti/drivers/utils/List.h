@@ -0,0 +1,32 @@
+/* Simulator shim: doubly linked list of the TI drivers */
+#ifndef EI_SIM_LIST_H
+#define EI_SIM_LIST_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct List_Elem {
+    struct List_Elem *next;
+    struct List_Elem *prev;
+} List_Elem;
+
+typedef struct {
+    List_Elem *head;
+    List_Elem *tail;
+} List_List;
+
+void List_clearList(List_List *list);
+void List_put(List_List *list, List_Elem *elem);
+List_Elem *List_head(List_List *list);
+List_Elem *List_tail(List_List *list);
+List_Elem *List_next(List_Elem *elem);
+List_Elem *List_prev(List_Elem *elem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
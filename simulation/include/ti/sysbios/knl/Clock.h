@@ -0,0 +1,20 @@
+/* Simulator shim: system tick on virtual time */
+#ifndef EI_SIM_CLOCK_H
+#define EI_SIM_CLOCK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* tick period in us, 10 in the BLE stack configuration */
+extern uint32_t Clock_tickPeriod;
+
+uint32_t Clock_getTicks(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
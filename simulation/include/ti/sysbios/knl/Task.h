@@ -0,0 +1,39 @@
+/* Simulator shim: the single simulated task, see ei_sim_shims.cpp */
+#ifndef EI_SIM_TASK_H
+#define EI_SIM_TASK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uintptr_t UArg;
+typedef void (*Task_FuncPtr)(UArg arg0, UArg arg1);
+
+typedef struct {
+    Task_FuncPtr fxn;
+    UArg arg0;
+    UArg arg1;
+    int priority;
+} Task_Struct;
+
+typedef struct {
+    UArg arg0;
+    UArg arg1;
+    int priority;
+    void *stack;
+    size_t stackSize;
+} Task_Params;
+
+void Task_Params_init(Task_Params *params);
+void Task_construct(Task_Struct *task, Task_FuncPtr fxn, const Task_Params *params, void *eb);
+void Task_sleep(uint32_t ticks);
+void Task_yield(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
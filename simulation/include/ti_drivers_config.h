@@ -0,0 +1,9 @@
+/* Simulator shim: syscfg generated indices */
+#ifndef EI_SIM_TI_DRIVERS_CONFIG_H
+#define EI_SIM_TI_DRIVERS_CONFIG_H
+
+#define CONFIG_I2S_0        0
+#define CONFIG_I2C_0        0
+#define CONFIG_NVS_EI_LOG   1
+
+#endif
@@ -0,0 +1,105 @@
+/* Multi-channel audio helpers. See ei_audio_channels.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "ei_audio_channels.h"
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Describe each channel of an interleaved buffer, no data is moved
+ *
+ * @param n_frames samples per channel
+ *
+ * @param views n_channels views to fill
+ */
+extern "C" void ei_audio_channel_views(int16_t *buf, uint32_t n_frames, uint8_t n_channels, ei_audio_view_t *views)
+{
+    for (uint8_t ch = 0; ch < n_channels; ch++) {
+        views[ch].base = &buf[ch];
+        views[ch].n_samples = n_frames;
+        views[ch].stride = n_channels;
+    }
+}
+
+/**
+ * @brief Reset the delay line and set the steering delay
+ *
+ * @param delay in samples, positive delays channel b, negative channel a
+ *
+ * @return int, 0 => OK, -1 if |delay| exceeds EI_AUDIO_MAX_DELAY
+ */
+extern "C" int ei_audio_das_init(ei_audio_das_t *das, int delay)
+{
+    if (delay > EI_AUDIO_MAX_DELAY || delay < -EI_AUDIO_MAX_DELAY) {
+        return -1;
+    }
+
+    memset(das, 0, sizeof(ei_audio_das_t));
+    das->delay = (int8_t)delay;
+
+    return 0;
+}
+
+/**
+ * @brief out[i] = (a[i] + b[i - delay]) / 2, or with a delayed for negative delays
+ *
+ * out may point to the interleaved buffer the views were made from: sample i
+ * is written after frame i was read, and never past it.
+ */
+extern "C" void ei_audio_das_process(ei_audio_das_t *das, const ei_audio_view_t *a, const ei_audio_view_t *b, int16_t *out)
+{
+    const ei_audio_view_t *direct = (das->delay >= 0) ? a : b;
+    const ei_audio_view_t *delayed = (das->delay >= 0) ? b : a;
+    uint32_t d = (das->delay >= 0) ? das->delay : -das->delay;
+    uint32_t n = a->n_samples;
+
+    if (d == 0) {
+        for (uint32_t ix = 0; ix < n; ix++) {
+            int32_t sum = (int32_t)ei_audio_view_get(a, ix) + ei_audio_view_get(b, ix);
+            out[ix] = (int16_t)(sum >> 1);
+        }
+        return;
+    }
+
+    uint32_t pos = das->pos;
+    for (uint32_t ix = 0; ix < n; ix++) {
+        int32_t x = ei_audio_view_get(direct, ix);
+        int16_t y = das->line[pos];
+        das->line[pos] = ei_audio_view_get(delayed, ix);
+        pos = (pos + 1 == d) ? 0 : pos + 1;
+        out[ix] = (int16_t)((x + y) >> 1);
+    }
+    das->pos = (uint8_t)pos;
+}
+
+/**
+ * @brief Route a single channel to a mono buffer, in place like ei_audio_das_process
+ */
+extern "C" void ei_audio_select(const ei_audio_view_t *view, int16_t *out)
+{
+    for (uint32_t ix = 0; ix < view->n_samples; ix++) {
+        out[ix] = ei_audio_view_get(view, ix);
+    }
+}
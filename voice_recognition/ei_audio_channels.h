@@ -0,0 +1,73 @@
+/* Multi-channel audio helpers for stereo (dual microphone) I2S capture.
+ * Channels are accessed as strided views straight into the interleaved DMA
+ * buffer, nothing is copied out. A delay-and-sum combiner steers the pair of
+ * microphones by delaying one channel by a whole number of samples (through a
+ * small delay line that carries over between buffers) and averaging; it may
+ * write its mono output over the interleaved input, in place.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_AUDIO_CHANNELS_H
+#define EI_AUDIO_CHANNELS_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifndef EI_AUDIO_MAX_DELAY
+#define EI_AUDIO_MAX_DELAY          16      // samples, 1 ms at 16kHz, ~34 cm of path difference
+#endif
+
+/** How a pair of channels is reduced to mono */
+typedef enum {
+    EI_AUDIO_ROUTE_SUM = 0,     // delay-and-sum
+    EI_AUDIO_ROUTE_LEFT,
+    EI_AUDIO_ROUTE_RIGHT,
+} ei_audio_route_t;
+
+/** One channel of an interleaved buffer */
+typedef struct {
+    int16_t *base;              // first sample of the channel
+    uint32_t n_samples;
+    uint8_t stride;             // number of channels in the buffer
+} ei_audio_view_t;
+
+/** Delay-and-sum state of a microphone pair */
+typedef struct {
+    int8_t delay;               // > 0 delays channel b, < 0 delays channel a
+    uint8_t pos;
+    int16_t line[EI_AUDIO_MAX_DELAY];
+} ei_audio_das_t;
+
+static inline int16_t ei_audio_view_get(const ei_audio_view_t *view, uint32_t ix)
+{
+    return view->base[ix * view->stride];
+}
+
+/* Function prototypes ----------------------------------------------------- */
+extern "C" void ei_audio_channel_views(int16_t *buf, uint32_t n_frames, uint8_t n_channels, ei_audio_view_t *views);
+extern "C" int ei_audio_das_init(ei_audio_das_t *das, int delay);
+extern "C" void ei_audio_das_process(ei_audio_das_t *das, const ei_audio_view_t *a, const ei_audio_view_t *b, int16_t *out);
+extern "C" void ei_audio_select(const ei_audio_view_t *view, int16_t *out);
+
+#endif
@@ -0,0 +1,193 @@
+/* Fixed-point audio conditioning. See ei_audio_preprocess.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+
+#include "ei_audio_preprocess.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+#include "arm_math.h"
+
+#define GAIN_ONE_Q8     256
+
+/* Private variables ------------------------------------------------------- */
+static ei_audio_pp_config_t pp_config;
+static ei_audio_pp_stats_t pp_stats;
+
+/* DC blocker state, see dc_block */
+static int16_t dc_x1;
+static int16_t dc_y1;
+static int32_t dc_err;
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief DC blocker y[n] = x[n] - x[n-1] + p * y[n-1]
+ *
+ * Not done with arm_biquad_cascade_df1_q15: CMSIS truncates the accumulator,
+ * and with a pole this close to 1 the truncation error builds up into a DC
+ * offset of ~100 LSB, which the AGC then amplifies. The remainder of every
+ * output is fed back instead (first order noise shaping), for no bias.
+ */
+static void dc_block(int16_t *buf, uint32_t n_samples)
+{
+    int16_t x1 = dc_x1;
+    int16_t y1 = dc_y1;
+    int32_t err = dc_err;
+
+    for (uint32_t ix = 0; ix < n_samples; ix++) {
+        int16_t x = buf[ix];
+        int64_t acc = ((int64_t)(x - x1) << 15) + (int32_t)pp_config.dc_pole * y1 + err;
+        int32_t y = (int32_t)(acc >> 15);
+        err = (int32_t)(acc - ((int64_t)y << 15));
+        y = (y > INT16_MAX) ? INT16_MAX : ((y < INT16_MIN) ? INT16_MIN : y);
+        x1 = x;
+        y1 = (int16_t)y;
+        buf[ix] = (int16_t)y;
+    }
+
+    dc_x1 = x1;
+    dc_y1 = y1;
+    dc_err = err;
+}
+
+/**
+ * @brief Feed forward AGC: move the gain towards target / rms of this buffer
+ */
+static void update_gain(q15_t rms)
+{
+    int32_t gain = pp_stats.gain_q8;
+    int32_t desired;
+
+    if (rms < pp_config.noise_floor) {
+        // don't pump up silence, hold the current gain
+        return;
+    }
+    desired = ((int32_t)pp_config.target_rms * GAIN_ONE_Q8) / rms;
+    if (desired > pp_config.max_gain_q8) {
+        desired = pp_config.max_gain_q8;
+    } else if (desired < pp_config.min_gain_q8) {
+        desired = pp_config.min_gain_q8;
+    }
+
+    int32_t coef = (desired < gain) ? pp_config.attack_q8 : pp_config.release_q8;
+    gain += ((desired - gain) * coef) / 256;
+    pp_stats.gain_q8 = (uint16_t)gain;
+}
+
+/**
+ * @brief Split a Q8.8 gain into the q15 fraction and shift used by arm_scale_q15
+ */
+static void gain_to_scale(uint16_t gain_q8, q15_t *fract, int8_t *shift)
+{
+    int8_t s = 0;
+    while ((uint32_t)gain_q8 >= ((uint32_t)GAIN_ONE_Q8 << s)) {
+        s++;
+    }
+    *shift = s;
+    *fract = (q15_t)(((uint32_t)gain_q8 << 7) >> s);
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Defaults tuned for keyword spotting with the onboard microphone
+ */
+extern "C" void ei_audio_pp_default_config(ei_audio_pp_config_t *config)
+{
+    config->dc_pole = 32604;            // 0.995, ~13Hz corner at 16kHz
+    config->target_rms = 3277;          // -20 dBFS
+    config->noise_floor = 33;           // -60 dBFS
+    config->min_gain_q8 = GAIN_ONE_Q8 / 4;
+    config->max_gain_q8 = GAIN_ONE_Q8 * 16;
+    config->attack_q8 = 128;
+    config->release_q8 = 16;
+}
+
+/**
+ * @brief Reset the filter state, gain and statistics
+ *
+ * @param config parameters, NULL for ei_audio_pp_default_config
+ *
+ * @return int, 0 => OK
+ */
+extern "C" int ei_audio_pp_init(const ei_audio_pp_config_t *config)
+{
+    if (config == NULL) {
+        ei_audio_pp_default_config(&pp_config);
+    } else {
+        pp_config = *config;
+    }
+    if (pp_config.min_gain_q8 == 0 || pp_config.min_gain_q8 > pp_config.max_gain_q8) {
+        return -1;
+    }
+
+    dc_x1 = 0;
+    dc_y1 = 0;
+    dc_err = 0;
+
+    memset(&pp_stats, 0, sizeof(pp_stats));
+    pp_stats.gain_q8 = GAIN_ONE_Q8;
+
+    return 0;
+}
+
+/**
+ * @brief Condition one completed I2S buffer in place
+ */
+extern "C" void ei_audio_pp_process(int16_t *buf, uint32_t n_samples)
+{
+    uint64_t start_us = ei_read_timer_us();
+    q15_t rms;
+    q15_t fract;
+    int8_t shift;
+
+    dc_block(buf, n_samples);
+
+    arm_rms_q15(buf, n_samples, &rms);
+    update_gain(rms);
+
+    gain_to_scale(pp_stats.gain_q8, &fract, &shift);
+    arm_scale_q15(buf, fract, shift, buf, n_samples);
+
+    uint32_t clipped = 0;
+    for (uint32_t ix = 0; ix < n_samples; ix++) {
+        clipped += (buf[ix] == INT16_MAX) | (buf[ix] == INT16_MIN);
+    }
+
+    uint32_t elapsed = (uint32_t)(ei_read_timer_us() - start_us);
+    pp_stats.buffers++;
+    pp_stats.samples += n_samples;
+    pp_stats.clipped += clipped;
+    pp_stats.last_rms = rms;
+    pp_stats.last_us = elapsed;
+    pp_stats.total_us += elapsed;
+    if (elapsed > pp_stats.worst_us) {
+        pp_stats.worst_us = elapsed;
+    }
+}
+
+extern "C" void ei_audio_pp_get_stats(ei_audio_pp_stats_t *stats)
+{
+    *stats = pp_stats;
+}
@@ -0,0 +1,66 @@
+/* Fixed-point audio conditioning applied in place to each completed I2S buffer,
+ * before it is handed to the classifier: a DC blocking high-pass filter, an
+ * automatic gain control with attack / release, and clip counting. Level and
+ * gain stages use CMSIS-DSP q15 kernels; every stage is a single pass over the
+ * buffer, so the cost per sample is bounded and the same code runs on target
+ * and on host.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_AUDIO_PREPROCESS_H
+#define EI_AUDIO_PREPROCESS_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** Conditioning parameters, gains are Q8.8 (256 => 1.0) */
+typedef struct {
+    int16_t dc_pole;            // q15 pole of the DC blocker, e.g. 0.995
+    int16_t target_rms;         // q15 RMS level the AGC steers towards
+    int16_t noise_floor;        // q15 RMS below which the gain is not raised
+    uint16_t min_gain_q8;
+    uint16_t max_gain_q8;
+    uint8_t attack_q8;          // share of the gain error applied per buffer when too loud
+    uint8_t release_q8;         // same, when too quiet
+} ei_audio_pp_config_t;
+
+/** Conditioning accounting, times in us */
+typedef struct {
+    uint32_t buffers;
+    uint32_t samples;
+    uint32_t clipped;           // samples saturated by the gain stage
+    uint16_t gain_q8;
+    int16_t last_rms;
+    uint32_t last_us;
+    uint32_t worst_us;
+    uint64_t total_us;
+} ei_audio_pp_stats_t;
+
+/* Function prototypes ----------------------------------------------------- */
+extern "C" void ei_audio_pp_default_config(ei_audio_pp_config_t *config);
+extern "C" int ei_audio_pp_init(const ei_audio_pp_config_t *config);
+extern "C" void ei_audio_pp_process(int16_t *buf, uint32_t n_samples);
+extern "C" void ei_audio_pp_get_stats(ei_audio_pp_stats_t *stats);
+
+#endif
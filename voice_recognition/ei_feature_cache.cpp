@@ -0,0 +1,170 @@
+/* Feature frame cache for continuous audio inferencing. See ei_feature_cache.h
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+
+#include "ei_feature_cache.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+
+#define SLICE_IDX_INVALID   UINT32_MAX
+
+/* Private variables ------------------------------------------------------- */
+static float *frames = NULL;            // n_slots * slice_features floats
+static uint32_t *tags = NULL;           // slice index held by each slot
+static size_t n_slots = 0;
+static size_t features_per_slice = 0;
+static ei_feature_cache_stats_t stats;
+
+/* Private functions ------------------------------------------------------- */
+static inline size_t slot_of(uint32_t slice_idx)
+{
+    return slice_idx % n_slots;
+}
+
+static float *lookup(uint32_t slice_idx)
+{
+    size_t slot = slot_of(slice_idx);
+    if (tags[slot] == slice_idx) {
+        return &frames[slot * features_per_slice];
+    }
+
+    return NULL;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Allocate the cache ring
+ *
+ * @param slice_features number of features produced by the DSP block for one slice
+ *
+ * @param n_slices slices to keep, at least EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW
+ *
+ * @return int, 0 => OK
+ */
+extern "C" int ei_feature_cache_init(size_t slice_features, size_t n_slices)
+{
+    ei_feature_cache_free();
+
+    frames = (float *)ei_malloc(slice_features * n_slices * sizeof(float));
+    tags = (uint32_t *)ei_malloc(n_slices * sizeof(uint32_t));
+    if (frames == NULL || tags == NULL) {
+        ei_printf("failed to allocate feature cache\r\n");
+        ei_feature_cache_free();
+        return -1;
+    }
+
+    n_slots = n_slices;
+    features_per_slice = slice_features;
+    ei_feature_cache_reset();
+
+    return 0;
+}
+
+extern "C" void ei_feature_cache_free(void)
+{
+    ei_free(frames);
+    ei_free(tags);
+    frames = NULL;
+    tags = NULL;
+    n_slots = 0;
+}
+
+/**
+ * @brief Invalidate every slot and clear the statistics, e.g. after the audio stream restarts
+ */
+extern "C" void ei_feature_cache_reset(void)
+{
+    for (size_t ix = 0; ix < n_slots; ix++) {
+        tags[ix] = SLICE_IDX_INVALID;
+    }
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief Get the cached features of a slice
+ *
+ * @return pointer to slice_features floats, or NULL on a miss
+ */
+extern "C" float *ei_feature_cache_get(uint32_t slice_idx)
+{
+    if (n_slots == 0) {
+        return NULL;
+    }
+
+    return lookup(slice_idx);
+}
+
+/**
+ * @brief Claim the slot for a slice, evicting the oldest entry if needed. The
+ * caller writes the features of the slice into the returned buffer.
+ */
+extern "C" float *ei_feature_cache_put(uint32_t slice_idx)
+{
+    if (n_slots == 0) {
+        return NULL;
+    }
+
+    size_t slot = slot_of(slice_idx);
+    if (tags[slot] != SLICE_IDX_INVALID && tags[slot] != slice_idx) {
+        stats.evictions++;
+    }
+    tags[slot] = slice_idx;
+    stats.computed++;
+
+    return &frames[slot * features_per_slice];
+}
+
+/**
+ * @brief Copy the features of n_slices consecutive slices, ending with
+ * newest_slice_idx, oldest first into out.
+ *
+ * @return int, 0 => OK, -1 if any slice of the window is not cached
+ */
+extern "C" int ei_feature_cache_assemble(uint32_t newest_slice_idx, size_t n_slices, float *out)
+{
+    if (n_slices > n_slots || newest_slice_idx + 1 < n_slices) {
+        stats.misses++;
+        return -1;
+    }
+
+    uint32_t first = newest_slice_idx + 1 - n_slices;
+    for (size_t ix = 0; ix < n_slices; ix++) {
+        float *src = lookup(first + ix);
+        if (src == NULL) {
+            stats.misses++;
+            return -1;
+        }
+        memcpy(&out[ix * features_per_slice], src, features_per_slice * sizeof(float));
+    }
+    // only the newest slice went through the DSP block for this window
+    stats.reused += n_slices - 1;
+
+    return 0;
+}
+
+extern "C" void ei_feature_cache_get_stats(ei_feature_cache_stats_t *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,56 @@
+/* Feature frame cache for continuous audio inferencing. Features are computed
+ * once per audio slice, stored in a ring keyed by slice index, and the model
+ * window is assembled from the cached slices, so every audio frame is
+ * transformed exactly once regardless of EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_FEATURE_CACHE_H
+#define EI_FEATURE_CACHE_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** Cache accounting. computed counts slices that went through the DSP block,
+ * reused the older slices copied into an assembled window instead, and misses
+ * the windows that could not be assembled */
+typedef struct {
+    uint32_t computed;
+    uint32_t reused;
+    uint32_t misses;
+    uint32_t evictions;
+} ei_feature_cache_stats_t;
+
+/* Function prototypes ----------------------------------------------------- */
+extern "C" int ei_feature_cache_init(size_t slice_features, size_t n_slices);
+extern "C" void ei_feature_cache_free(void);
+extern "C" void ei_feature_cache_reset(void);
+
+extern "C" float *ei_feature_cache_get(uint32_t slice_idx);
+extern "C" float *ei_feature_cache_put(uint32_t slice_idx);
+extern "C" int ei_feature_cache_assemble(uint32_t newest_slice_idx, size_t n_slices, float *out);
+
+extern "C" void ei_feature_cache_get_stats(ei_feature_cache_stats_t *stats);
+
+#endif
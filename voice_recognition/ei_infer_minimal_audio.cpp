@@ -34,6 +34,9 @@
 /* Include ----------------------------------------------------------------- */
 #include "edge-impulse-sdk/classifier/ei_run_classifier.h"
 #include "ei_microphone_minimal_audio.h"
+#if EI_AUDIO_PREPROCESS
+#include "ei_audio_preprocess.h"
+#endif
 
 /// TI Drivers used for inferencing: timing and serial output
 #include <ti/drivers/UART2.h>
@@ -50,15 +53,862 @@ static uint64_t timer_count = 0;
 
 /// private function prototypes
 void timer_Callback(Timer_Handle _myHandle, int_fast16_t _status);
+extern "C" void Serial_Out(char *string, int length);
+extern "C" uint64_t Timer_getMs(void);
+
+/*
+ * Set EI_AUDIO_FEATURE_CACHE=1 in Predefined Symbols to compute features per
+ * slice in this wrapper, keep them in ei_feature_cache, and assemble the model
+ * window from the cache instead of letting run_classifier_continuous do it
+ * internally. Only MFCC and MFE impulses are supported in this mode.
+ */
+#ifndef EI_AUDIO_FEATURE_CACHE
+#define EI_AUDIO_FEATURE_CACHE      0
+#endif
+
+#if EI_AUDIO_FEATURE_CACHE
+#include "ei_feature_cache.h"
+
+static uint32_t slice_idx = 0;
+static size_t slice_feature_count = 0;  // DSP output of one slice, see feature_cache_init
+static uint64_t slice_dsp_us = 0;       // DSP time of all slices put in the cache
+static float window_features[EI_CLASSIFIER_NN_INPUT_FRAME_SIZE];
+#endif
+
+/*
+ * Set EI_AUDIO_SLICE_CONTROLLER=1 to adapt the inference rate to the measured
+ * processing time: under load only one out of every `stride` slices is classified.
+ * With EI_AUDIO_FEATURE_CACHE the other slices still go through the DSP block,
+ * otherwise the last model window is stored (EI_AUDIO_STORED_WINDOW) and
+ * classified whole, so the model window stays continuous either way.
+ */
+#ifndef EI_AUDIO_SLICE_CONTROLLER
+#define EI_AUDIO_SLICE_CONTROLLER   0
+#endif
+
+#if EI_AUDIO_SLICE_CONTROLLER
+#include "ei_slice_controller.h"
+
+#ifndef EI_AUDIO_MAX_STRIDE
+#define EI_AUDIO_MAX_STRIDE         EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW
+#endif
+
+static ei_slice_ctrl_t slice_ctrl;
+#endif
+
+/*
+ * Set EI_AUDIO_PREROLL=1 to keep the last EI_AUDIO_PREROLL_PRE_MS of raw audio.
+ * When a label scores at least EI_PREROLL_THRESHOLD, a snapshot including
+ * EI_AUDIO_PREROLL_POST_MS after the detection is frozen and streamed out over
+ * UART2 in binary chunks (see ei_preroll.h), EI_PREROLL_CHUNK_SAMPLES per slice.
+ * The ring takes 2 bytes per sample of pre, post and one slice: 32 KB at 16kHz
+ * with the defaults, size them to the RAM left next to the impulse.
+ */
+#ifndef EI_AUDIO_PREROLL
+#define EI_AUDIO_PREROLL            0
+#endif
+
+#if EI_AUDIO_PREROLL
+#include "ei_preroll.h"
+
+#ifndef EI_AUDIO_PREROLL_PRE_MS
+#define EI_AUDIO_PREROLL_PRE_MS     500
+#endif
+
+#ifndef EI_AUDIO_PREROLL_POST_MS
+#define EI_AUDIO_PREROLL_POST_MS    250
+#endif
+
+#ifndef EI_PREROLL_THRESHOLD
+#define EI_PREROLL_THRESHOLD        0.8f
+#endif
+
+#ifndef EI_PREROLL_CHUNK_SAMPLES
+#define EI_PREROLL_CHUNK_SAMPLES    512
+#endif
+
+#define PREROLL_PRE_SAMPLES         (EI_AUDIO_PREROLL_PRE_MS * (EI_CLASSIFIER_FREQUENCY / 1000))
+#define PREROLL_POST_SAMPLES        (EI_AUDIO_PREROLL_POST_MS * (EI_CLASSIFIER_FREQUENCY / 1000))
+// one extra slice so recording can continue while the snapshot is being streamed
+#define PREROLL_CAPACITY            (PREROLL_PRE_SAMPLES + PREROLL_POST_SAMPLES + EI_CLASSIFIER_SLICE_SIZE)
+
+static int16_t preroll_buf[PREROLL_CAPACITY];
+static ei_preroll_t preroll;
+
+static void preroll_write_uart(const void *data, size_t len)
+{
+    Serial_Out((char *)data, (int)len);
+}
+#endif
+
+/*
+ * Set EI_AUDIO_ADPCM=1 and copy ei_adpcm.* from the common directory to stream
+ * the recorded audio over UART2 as IMA-ADPCM, 4 bits per sample, in packets of
+ * EI_AUDIO_ADPCM_PACKET_SAMPLES that each decode on their own (see ei_adpcm.h).
+ * Every slice is encoded before it is classified. The writes block the
+ * inference thread, at 16kHz the stream needs ~70 kbit/s, 76% of UART2 at
+ * 115200 baud, which leaves too little of a slice period for the DSP and the
+ * inference. The stream is only started (from boot, or by AT+ADPCM=1) when
+ * EI_AUDIO_UART_BAUDRATE is at least EI_AUDIO_ADPCM_MIN_BAUDRATE, where writing
+ * a slice takes at most EI_AUDIO_ADPCM_LINK_PCT of the slice period. AT+ADPCM=<0|1>
+ * stops and starts the stream, every start with a new stream id.
+ */
+#ifndef EI_AUDIO_ADPCM
+#define EI_AUDIO_ADPCM              0
+#endif
+
+#ifndef EI_AUDIO_UART_BAUDRATE
+#define EI_AUDIO_UART_BAUDRATE      115200
+#endif
+
+#if EI_AUDIO_ADPCM
+#include "ei_adpcm.h"
+
+#ifndef EI_AUDIO_ADPCM_PACKET_SAMPLES
+#define EI_AUDIO_ADPCM_PACKET_SAMPLES   256
+#endif
+#ifndef EI_AUDIO_ADPCM_LINK_PCT
+#define EI_AUDIO_ADPCM_LINK_PCT     25
+#endif
+// 10 bits per byte on the wire
+#define EI_AUDIO_ADPCM_MIN_BAUDRATE \
+    ((EI_ADPCM_PACKET_SIZE(EI_AUDIO_ADPCM_PACKET_SAMPLES) * EI_CLASSIFIER_FREQUENCY / EI_AUDIO_ADPCM_PACKET_SAMPLES) \
+        * 10 * 100 / EI_AUDIO_ADPCM_LINK_PCT)
+// stream from boot, 0 waits for AT+ADPCM=1
+#ifndef EI_AUDIO_ADPCM_START
+#define EI_AUDIO_ADPCM_START        (EI_AUDIO_UART_BAUDRATE >= EI_AUDIO_ADPCM_MIN_BAUDRATE)
+#endif
+
+static ei_adpcm_encoder_t adpcm;
+static uint8_t adpcm_packet[EI_ADPCM_PACKET_SIZE(EI_AUDIO_ADPCM_PACKET_SAMPLES)];
+static bool adpcm_streaming = false;
+static uint8_t adpcm_next_id = 0;
+static uint32_t adpcm_last_us = 0;      // encoding and writing of the last slice
+static uint32_t adpcm_worst_us = 0;
+
+static void adpcm_write_uart(const void *data, size_t len)
+{
+    Serial_Out((char *)data, (int)len);
+}
+
+static int adpcm_start(void)
+{
+    if (EI_AUDIO_UART_BAUDRATE < EI_AUDIO_ADPCM_MIN_BAUDRATE) {
+        ei_printf("ERR: ADPCM needs %u baud, UART2 runs at %u\r\n",
+            (unsigned)EI_AUDIO_ADPCM_MIN_BAUDRATE, (unsigned)EI_AUDIO_UART_BAUDRATE);
+        return -1;
+    }
+    if (ei_adpcm_encoder_init(&adpcm, adpcm_packet, sizeof(adpcm_packet), EI_AUDIO_ADPCM_PACKET_SAMPLES,
+                              adpcm_next_id++, adpcm_write_uart) != 0) {
+        return -1;
+    }
+    adpcm_streaming = true;
+    return 0;
+}
+
+static void adpcm_stop(void)
+{
+    ei_adpcm_flush(&adpcm);
+    adpcm_streaming = false;
+}
+
+static void adpcm_slice(const int16_t *slice)
+{
+    if (!adpcm_streaming) {
+        return;
+    }
+    uint64_t start_us = ei_read_timer_us();
+    ei_adpcm_encode(&adpcm, slice, EI_CLASSIFIER_SLICE_SIZE);
+    adpcm_last_us = (uint32_t)(ei_read_timer_us() - start_us);
+    if (adpcm_last_us > adpcm_worst_us) {
+        adpcm_worst_us = adpcm_last_us;
+    }
+}
+#endif
+
+/*
+ * Set EI_AUDIO_COMMANDS=1 to accept AT commands on UART2 between inferences
+ * (see ei_cmd.h): the stride, the detection threshold, the output format and
+ * SDK debug output can then be changed, and statistics dumped, without a rebuild.
+ */
+#ifndef EI_AUDIO_COMMANDS
+#define EI_AUDIO_COMMANDS           0
+#endif
+
+#if EI_AUDIO_COMMANDS
+#include "ei_cmd.h"
+
+static ei_cmd_parser_t cmd_parser;
+#endif
+
+/*
+ * Set EI_AUDIO_ENERGY=1 to account the time spent waiting for audio, in the DSP
+ * block, in inference and on output (see ei_energy.h). The duty cycle and the
+ * estimated energy per inference are printed with the predictions and by
+ * AT+STATS. Adjust the power model in ei_init to your board.
+ */
+#ifndef EI_AUDIO_ENERGY
+#define EI_AUDIO_ENERGY             0
+#endif
+
+#if EI_AUDIO_ENERGY
+#include "ei_energy.h"
+
+static ei_energy_t energy;
+#endif
+
+/*
+ * Set EI_AUDIO_CASCADE=1 and copy ei_cascade.* from the common directory to run
+ * a cheap first stage on every slice, and the impulse only on slices that score
+ * at least EI_AUDIO_CASCADE_THRESHOLD, plus EI_AUDIO_CASCADE_HOLD slices after
+ * them. The last model window of audio is kept as int16, so a woken up impulse
+ * classifies a complete window (EI_AUDIO_STORED_WINDOW) and no audio is missing. The
+ * first stage is EI_AUDIO_CASCADE_STAGE1, by default the slice level against
+ * the noise floor. Map it to a function scoring the slice with a second, small
+ * impulse to gate on a model instead.
+ */
+#ifndef EI_AUDIO_CASCADE
+#define EI_AUDIO_CASCADE            0
+#endif
+
+#if EI_AUDIO_CASCADE
+#if EI_AUDIO_FEATURE_CACHE
+#error "EI_AUDIO_CASCADE is not supported with EI_AUDIO_FEATURE_CACHE"
+#endif
+#include "ei_cascade.h"
+#include "arm_math.h"
+
+// with the level detector, 0.5 is 6 dB above the noise floor
+#ifndef EI_AUDIO_CASCADE_THRESHOLD
+#define EI_AUDIO_CASCADE_THRESHOLD  0.5f
+#endif
+
+#ifndef EI_AUDIO_CASCADE_HOLD
+#define EI_AUDIO_CASCADE_HOLD       (EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW - 1)
+#endif
+
+#ifndef EI_AUDIO_CASCADE_STAGE1
+#define EI_AUDIO_CASCADE_STAGE1     cascade_level_stage1
+#endif
+
+static ei_cascade_t cascade;
+static ei_cascade_level_t cascade_level;
+
+/*
+ * @brief Default first stage: RMS of the slice against the noise floor
+ */
+static float cascade_level_stage1(const int16_t *slice, size_t n)
+{
+    q15_t rms;
+
+    arm_rms_q15((const q15_t *)slice, (uint32_t)n, &rms);
+    return ei_cascade_level_score(&cascade_level, (float)rms / 32768.0f);
+}
+#endif
+
+/*
+ * When slices are skipped (EI_AUDIO_CASCADE, EI_AUDIO_SLICE_CONTROLLER) and the
+ * feature cache does not keep the model window, the last window of audio is
+ * kept as int16 and classified whole with run_classifier: run_classifier_continuous
+ * only sees the slices it is given, so its window would splice audio from either
+ * side of the skipped slices. Costs 2 bytes per sample of the window. Set it
+ * to 1 to allow AT+STRIDE above 1 without the controller or the feature cache.
+ */
+#ifndef EI_AUDIO_STORED_WINDOW
+#define EI_AUDIO_STORED_WINDOW      ((EI_AUDIO_CASCADE || EI_AUDIO_SLICE_CONTROLLER) && !EI_AUDIO_FEATURE_CACHE)
+#endif
+
+#if EI_AUDIO_STORED_WINDOW
+#if EI_AUDIO_FEATURE_CACHE
+#error "EI_AUDIO_STORED_WINDOW is not needed with EI_AUDIO_FEATURE_CACHE"
+#endif
+#if (EI_CLASSIFIER_SLICE_SIZE * EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW) != EI_CLASSIFIER_RAW_SAMPLE_COUNT
+#error "EI_AUDIO_STORED_WINDOW requires a window of whole slices"
+#endif
+#include "arm_math.h"
+
+static int16_t stored_window[EI_CLASSIFIER_RAW_SAMPLE_COUNT];
+static size_t window_next = 0;      // slot of the next slice, the oldest one once the window is full
+static size_t window_slices = 0;
+
+static void window_store_slice(const int16_t *slice)
+{
+    memcpy(&stored_window[window_next * EI_CLASSIFIER_SLICE_SIZE], slice,
+           EI_CLASSIFIER_SLICE_SIZE * sizeof(int16_t));
+    window_next = (window_next + 1) % EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW;
+    if (window_slices < EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW) {
+        window_slices++;
+    }
+}
+
+/*
+ * @brief signal_t callback over the stored window, oldest slice first
+ */
+static int window_get_data(size_t offset, size_t length, float *out_ptr)
+{
+    size_t pos = (window_next * EI_CLASSIFIER_SLICE_SIZE + offset) % EI_CLASSIFIER_RAW_SAMPLE_COUNT;
+
+    while (length > 0) {
+        size_t n = EI_CLASSIFIER_RAW_SAMPLE_COUNT - pos;
+        if (n > length) {
+            n = length;
+        }
+        arm_q15_to_float(&stored_window[pos], out_ptr, n);
+        out_ptr += n;
+        length -= n;
+        pos = 0;
+    }
+    return 0;
+}
+#endif
+
+/*
+ * Set EI_AUDIO_STARTUP_TRACE=1 and copy ei_startup.* from the common directory
+ * to timestamp the startup (see ei_startup.h). The times since boot of the
+ * first sample, of the classifier being ready and of the first result are
+ * printed with the first result, and by AT+STATS.
+ */
+#ifndef EI_AUDIO_STARTUP_TRACE
+#define EI_AUDIO_STARTUP_TRACE      0
+#endif
+
+#if EI_AUDIO_STARTUP_TRACE
+#include "ei_startup.h"
+
+static uint64_t startup_now_us(void)
+{
+    return (uint64_t)Clock_getTicks() * Clock_tickPeriod;
+}
+
+static void print_startup(void)
+{
+    uint64_t us;
+    const char *sep = " ";
+
+    ei_printf("Startup (ms since boot):");
+    for (int ev = 0; ev < EI_STARTUP_N_EVENTS; ev++) {
+        if (ei_startup_get_us((ei_startup_event_t)ev, &us) == 0) {
+            ei_printf("%s%s %u", sep, ei_startup_event_name((ei_startup_event_t)ev), (unsigned)(us / 1000));
+            sep = ", ";
+        }
+    }
+    ei_printf("\r\n");
+}
+#endif
+
+/*
+ * Set EI_AUDIO_LATENCY=1 and copy ei_latency.* from the common directory to
+ * measure the age of every result: the time from the I2S interrupt that
+ * completed the newest slice to the result of the impulse, including the wait
+ * in the microphone queue (see ei_latency.h). The distribution is printed with
+ * the predictions and by AT+STATS. The oldest sample of the slice is one slice
+ * duration older.
+ */
+#ifndef EI_AUDIO_LATENCY
+#define EI_AUDIO_LATENCY            0
+#endif
+
+#if EI_AUDIO_LATENCY
+#include "ei_latency.h"
+
+// width of the first histogram buckets, 40 buckets then reach ~2 s
+#ifndef EI_AUDIO_LATENCY_UNIT_US
+#define EI_AUDIO_LATENCY_UNIT_US    1000
+#endif
+
+static ei_latency_t latency;
+
+static void print_latency(void)
+{
+    ei_printf("Latency (capture to result, ms): last %u, avg %u, p50 %u, p90 %u, p99 %u, max %u over %u results\r\n",
+        (unsigned)(latency.last_us / 1000), (unsigned)(ei_latency_avg_us(&latency) / 1000),
+        (unsigned)(ei_latency_percentile_us(&latency, 50) / 1000),
+        (unsigned)(ei_latency_percentile_us(&latency, 90) / 1000),
+        (unsigned)(ei_latency_percentile_us(&latency, 99) / 1000),
+        (unsigned)(latency.max_us / 1000), (unsigned)latency.count);
+}
+#endif
+
+// top score from which a result counts as a detection (pre-roll trigger, DETECT output)
+#ifndef EI_DETECT_THRESHOLD
+#if EI_AUDIO_PREROLL
+#define EI_DETECT_THRESHOLD         EI_PREROLL_THRESHOLD
+#else
+#define EI_DETECT_THRESHOLD         0.8f
+#endif
+#endif
+
+/// settings that can be changed at runtime, see EI_AUDIO_COMMANDS
+typedef enum {
+    OUTPUT_TEXT,        // timing and all scores
+    OUTPUT_CSV,         // one line per result: time, timing, scores
+    OUTPUT_DETECT,      // only the top label, and only for detections
+    OUTPUT_NONE
+} output_format_t;
+
+static bool classifier_ready = false;   // run_classifier_init is run by the first ei_infer_audio
+static uint32_t result_capture_us = 0;  // capture time of the newest slice of the last result
+static output_format_t output_format = OUTPUT_TEXT;
+static float detect_threshold = EI_DETECT_THRESHOLD;
+static bool sdk_debug = false;
+#if !EI_AUDIO_SLICE_CONTROLLER
+static uint8_t fixed_stride = 1;        // classify one out of every fixed_stride slices
+static uint8_t stride_phase = 0;
+
+#if EI_AUDIO_FEATURE_CACHE || EI_AUDIO_STORED_WINDOW
+#define EI_AUDIO_FIXED_STRIDE_MAX   EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW
+#else
+// run_classifier_continuous would splice its window from the classified slices only
+#define EI_AUDIO_FIXED_STRIDE_MAX   1
+#endif
+#endif
+
+static size_t top_label(const ei_impulse_result_t *result, float *score)
+{
+    size_t top = 0;
+    float max_val = 0.0f;
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        if (max_val < result->classification[ix].value) {
+            max_val = result->classification[ix].value;
+            top = ix;
+        }
+    }
+    *score = max_val;
+    return top;
+}
+
+#if EI_AUDIO_CASCADE
+static void print_cascade(void)
+{
+    uint32_t inputs = cascade.inputs ? cascade.inputs : 1;
+    uint32_t runs = cascade.stage2.runs ? cascade.stage2.runs : 1;
+
+    ei_printf("Cascade: %u of %u slices passed (%u%%), %u classified, %u detections; "
+              "stage 1 avg %u us (max %u), stage 2 avg %u ms (max %u), %u us per slice\r\n",
+        (unsigned)cascade.passed, (unsigned)cascade.inputs, (unsigned)(cascade.passed * 100 / inputs),
+        (unsigned)cascade.stage2.runs, (unsigned)cascade.detections,
+        (unsigned)(cascade.stage1.total_us / inputs), (unsigned)cascade.stage1.max_us,
+        (unsigned)(cascade.stage2.total_us / runs / 1000), (unsigned)(cascade.stage2.max_us / 1000),
+        (unsigned)((cascade.stage1.total_us + cascade.stage2.total_us) / inputs));
+}
+#endif
+
+#if EI_AUDIO_ENERGY
+static void print_energy(void)
+{
+    ei_energy_report_t report;
+    ei_energy_get_report(&energy, &report);
+    ei_printf("Energy: duty %u.%u%%, %u uW, %u uJ per inference (acquire %u, dsp %u, nn %u, log %u, app %u ms)\r\n",
+        (unsigned)(report.duty_permille / 10), (unsigned)(report.duty_permille % 10), (unsigned)report.avg_uw,
+        (unsigned)report.uj_per_inference, (unsigned)(report.time_us[EI_ENERGY_ACQUIRE] / 1000),
+        (unsigned)(report.time_us[EI_ENERGY_DSP] / 1000), (unsigned)(report.time_us[EI_ENERGY_NN] / 1000),
+        (unsigned)(report.time_us[EI_ENERGY_LOG] / 1000), (unsigned)(report.time_us[EI_ENERGY_APP] / 1000));
+}
+#endif
+
+#if EI_AUDIO_FEATURE_CACHE
+/*
+ * @brief Run the DSP block of the impulse on one slice
+ *
+ * @param out_size set to the features actually written to out
+ *
+ * @return int, EIDSP_OK => OK
+ */
+static int extract_slice_features(signal_t *signal, float *out, size_t out_len, ei::matrix_size_t *out_size)
+{
+    ei::matrix_t slice_matrix(1, out_len, out);
+
+    if (ei_dsp_blocks[0].extract_fn == &extract_mfcc_features) {
+        return extract_mfcc_per_slice_features(signal, &slice_matrix, ei_dsp_blocks[0].config,
+                                               EI_CLASSIFIER_FREQUENCY, out_size);
+    } else if (ei_dsp_blocks[0].extract_fn == &extract_mfe_features) {
+        return extract_mfe_per_slice_features(signal, &slice_matrix, ei_dsp_blocks[0].config,
+                                              EI_CLASSIFIER_FREQUENCY, out_size);
+    }
+
+    ei_printf("ERR: feature cache requires an MFCC or MFE impulse\r\n");
+    return EIDSP_NOT_SUPPORTED;
+}
+
+/*
+ * @brief signal_t callback returning silence
+ */
+static int silence_get_data(size_t offset, size_t length, float *out_ptr)
+{
+    (void)offset;
+    memset(out_ptr, 0, length * sizeof(float));
+    return 0;
+}
+
+/*
+ * @brief Size the feature cache from the DSP output of one silent slice. The
+ * slices must split the model window evenly, otherwise the window cannot be
+ * assembled from fixed size slots. The DSP state left by this slice is cleared
+ * by run_classifier_init.
+ *
+ * @return int, 0 => OK
+ */
+static int feature_cache_init(void)
+{
+    signal_t signal;
+    signal.total_length = EI_CLASSIFIER_SLICE_SIZE;
+    signal.get_data = &silence_get_data;
+
+    ei::matrix_size_t out_size;
+    if (extract_slice_features(&signal, window_features, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE, &out_size) != EIDSP_OK) {
+        return -1;
+    }
+
+    slice_feature_count = out_size.rows * out_size.cols;
+    if (slice_feature_count * EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW != EI_CLASSIFIER_NN_INPUT_FRAME_SIZE) {
+        ei_printf("ERR: %u features per slice do not split the %u of the model window in %u slices\r\n",
+            (unsigned)slice_feature_count, (unsigned)EI_CLASSIFIER_NN_INPUT_FRAME_SIZE,
+            (unsigned)EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW);
+        return -1;
+    }
+
+    return ei_feature_cache_init(slice_feature_count, EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW);
+}
+
+static void print_feature_cache(void)
+{
+    ei_feature_cache_stats_t stats;
+    ei_feature_cache_get_stats(&stats);
+
+    // each reused slice would have cost about as much DSP time as a computed one
+    uint32_t saved_ms = 0;
+    if (stats.computed > 0) {
+        saved_ms = (uint32_t)((slice_dsp_us / stats.computed) * stats.reused / 1000);
+    }
+    ei_printf("Feature cache: %u slices computed, %u reused, about %u ms of DSP saved\r\n",
+        (unsigned)stats.computed, (unsigned)stats.reused, (unsigned)saved_ms);
+}
+#endif
+
+/*
+ * @brief Print a result in the current output_format
+ */
+static void print_result(const ei_impulse_result_t *result)
+{
+    float score;
+    size_t top = top_label(result, &score);
+
+    switch (output_format) {
+    case OUTPUT_TEXT:
+        ei_printf("\r\nPredictions (DSP: %d ms., Classification: %d ms., Anomaly: %d ms.): \r\n",
+            result->timing.dsp, result->timing.classification, result->timing.anomaly);
+#if EI_AUDIO_FEATURE_CACHE
+        print_feature_cache();
+#endif
+#if EI_AUDIO_PREPROCESS
+        ei_audio_pp_stats_t pp_stats;
+        ei_audio_pp_get_stats(&pp_stats);
+        ei_printf("Preprocess: gain %u/256, clipped %u, %u us per slice (worst %u us)\r\n",
+            (unsigned)pp_stats.gain_q8, (unsigned)pp_stats.clipped,
+            (unsigned)pp_stats.last_us, (unsigned)pp_stats.worst_us);
+#endif
+#if EI_AUDIO_SLICE_CONTROLLER
+        ei_printf("Slice stride: %u (skipped %u of %u slices)\r\n", (unsigned)slice_ctrl.stride,
+            (unsigned)slice_ctrl.slices_skipped, (unsigned)slice_ctrl.slices_seen);
+#endif
+#if EI_AUDIO_CASCADE
+        print_cascade();
+#endif
+#if EI_AUDIO_ENERGY
+        print_energy();
+#endif
+#if EI_AUDIO_LATENCY
+        print_latency();
+#endif
+        for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+            ei_printf("    %s: \t", result->classification[ix].label);
+            // printing floating point
+            ei_printf("%d%%", (int32_t) (result->classification[ix].value * 100.0));
+            ei_printf("\r\n");
+        }
+        break;
+    case OUTPUT_CSV:
+        ei_printf("%u,%d,%d", (unsigned)Timer_getMs(), result->timing.dsp, result->timing.classification);
+        for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+            ei_printf(",%d", (int32_t) (result->classification[ix].value * 100.0));
+        }
+        ei_printf("\r\n");
+        break;
+    case OUTPUT_DETECT:
+        if (score >= detect_threshold) {
+            ei_printf("%s %d%%\r\n", result->classification[top].label, (int32_t) (score * 100.0));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * @brief Dump the counters of the microphone driver and of the enabled stages
+ */
+static void print_stats(void)
+{
+    ei_microphone_stats_t mic;
+    ei_microphone_get_stats(&mic);
+    ei_printf("Microphone: %u frames, %u classified, dropped %u idle / %u skip / %u queue full / %u overrun, "
+              "%u lost in %u gaps, max queue %u\r\n",
+        (unsigned)mic.frames_produced, (unsigned)mic.frames_delivered, (unsigned)mic.dropped_not_recording,
+        (unsigned)mic.dropped_skip, (unsigned)mic.dropped_queue_full, (unsigned)mic.dropped_overrun,
+        (unsigned)mic.seq_lost, (unsigned)mic.seq_gaps, (unsigned)mic.max_queue_depth);
+#if EI_AUDIO_PREPROCESS
+    ei_audio_pp_stats_t pp_stats;
+    ei_audio_pp_get_stats(&pp_stats);
+    ei_printf("Preprocess: gain %u/256, clipped %u of %u samples, worst %u us\r\n",
+        (unsigned)pp_stats.gain_q8, (unsigned)pp_stats.clipped, (unsigned)pp_stats.samples,
+        (unsigned)pp_stats.worst_us);
+#endif
+#if EI_AUDIO_FEATURE_CACHE
+    print_feature_cache();
+#endif
+#if EI_AUDIO_SLICE_CONTROLLER
+    ei_printf("Slice stride: %u of max %u, skipped %u of %u slices, %u overloads\r\n",
+        (unsigned)slice_ctrl.stride, (unsigned)slice_ctrl.config.max_stride, (unsigned)slice_ctrl.slices_skipped,
+        (unsigned)slice_ctrl.slices_seen, (unsigned)slice_ctrl.overloads);
+#endif
+#if EI_AUDIO_CASCADE
+    print_cascade();
+#endif
+#if EI_AUDIO_ENERGY
+    print_energy();
+#endif
+#if EI_AUDIO_STARTUP_TRACE
+    print_startup();
+#endif
+#if EI_AUDIO_LATENCY
+    print_latency();
+#endif
+#if EI_AUDIO_ADPCM
+    ei_printf("ADPCM: %s, stream %u, %u packets, %u s of audio, %u ms per slice (worst %u)\r\n",
+        adpcm_streaming ? "on" : "off", (unsigned)adpcm.stream_id, (unsigned)adpcm.packets,
+        (unsigned)(adpcm.samples / EI_CLASSIFIER_FREQUENCY), (unsigned)(adpcm_last_us / 1000),
+        (unsigned)(adpcm_worst_us / 1000));
+#endif
+#if EI_AUDIO_COMMANDS
+    ei_printf("Commands: %u lines, %u errors\r\n", (unsigned)cmd_parser.lines, (unsigned)cmd_parser.errors);
+#endif
+}
+
+#if EI_AUDIO_COMMANDS
+static void cmd_print(const char *str)
+{
+    ei_printf("%s", str);
+}
+
+static int cmd_stride(int argc, char **argv)
+{
+    int32_t stride;
+#if EI_AUDIO_SLICE_CONTROLLER
+    if (argc == 0) {
+        ei_printf("STRIDE=%u (adaptive, now %u)\r\n", (unsigned)slice_ctrl.config.max_stride,
+            (unsigned)slice_ctrl.stride);
+        return 0;
+    }
+    if (argc != 1 || ei_cmd_parse_int(argv[0], 1, EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW, &stride) != 0) {
+        return -1;
+    }
+    // the controller adapts the stride up to this limit
+    slice_ctrl.config.max_stride = (uint8_t)stride;
+    if (slice_ctrl.stride > stride) {
+        slice_ctrl.stride = (uint8_t)stride;
+        slice_ctrl.phase = 0;
+    }
+#else
+    if (argc == 0) {
+        ei_printf("STRIDE=%u\r\n", (unsigned)fixed_stride);
+        return 0;
+    }
+    if (argc != 1 || ei_cmd_parse_int(argv[0], 1, EI_AUDIO_FIXED_STRIDE_MAX, &stride) != 0) {
+        return -1;
+    }
+    fixed_stride = (uint8_t)stride;
+    stride_phase = 0;
+#endif
+    return 0;
+}
+
+static int cmd_threshold(int argc, char **argv)
+{
+    if (argc == 0) {
+        ei_printf("THRESHOLD=%d%%\r\n", (int32_t) (detect_threshold * 100.0));
+        return 0;
+    }
+    return (argc == 1) ? ei_cmd_parse_float(argv[0], 0.0f, 1.0f, &detect_threshold) : -1;
+}
+
+static int cmd_format(int argc, char **argv)
+{
+    static const char *names[] = { "TEXT", "CSV", "DETECT", "NONE" };
+
+    if (argc == 0) {
+        ei_printf("FORMAT=%s\r\n", names[output_format]);
+        return 0;
+    }
+    for (size_t ix = 0; argc == 1 && ix < sizeof(names) / sizeof(names[0]); ix++) {
+        if (ei_cmd_equals(argv[0], names[ix])) {
+            output_format = (output_format_t)ix;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int cmd_debug(int argc, char **argv)
+{
+    int32_t on;
+
+    if (argc == 0) {
+        ei_printf("DEBUG=%d\r\n", sdk_debug ? 1 : 0);
+        return 0;
+    }
+    if (argc != 1 || ei_cmd_parse_int(argv[0], 0, 1, &on) != 0) {
+        return -1;
+    }
+    sdk_debug = (on != 0);
+    return 0;
+}
+
+static int cmd_stats(int argc, char **argv)
+{
+    if (argc == 1 && ei_cmd_equals(argv[0], "RESET")) {
+        ei_microphone_reset_stats();
+#if EI_AUDIO_ENERGY
+        ei_energy_reset(&energy);
+#endif
+#if EI_AUDIO_CASCADE
+        ei_cascade_reset_stats(&cascade);
+#endif
+#if EI_AUDIO_LATENCY
+        ei_latency_reset(&latency);
+#endif
+        return 0;
+    }
+    if (argc != 0) {
+        return -1;
+    }
+    print_stats();
+    return 0;
+}
+
+#if EI_AUDIO_CASCADE
+static int cmd_cascade(int argc, char **argv)
+{
+    int32_t hold = cascade.hold;
+
+    if (argc == 0) {
+        ei_printf("CASCADE=%d%%,%u\r\n", (int32_t) (cascade.threshold * 100.0), (unsigned)cascade.hold);
+        return 0;
+    }
+    if (argc > 2 || (argc == 2 && ei_cmd_parse_int(argv[1], 0, UINT16_MAX, &hold) != 0)) {
+        return -1;
+    }
+    if (ei_cmd_parse_float(argv[0], 0.0f, 1.0f, &cascade.threshold) != 0) {
+        return -1;
+    }
+    cascade.hold = (uint16_t)hold;
+    return 0;
+}
+#endif
+
+#if EI_AUDIO_ADPCM
+static int cmd_adpcm(int argc, char **argv)
+{
+    int32_t on;
+
+    if (argc == 0) {
+        ei_printf("ADPCM=%d\r\n", adpcm_streaming ? 1 : 0);
+        return 0;
+    }
+    if (argc != 1 || ei_cmd_parse_int(argv[0], 0, 1, &on) != 0) {
+        return -1;
+    }
+    if (on && !adpcm_streaming) {
+        return adpcm_start();
+    } else if (!on && adpcm_streaming) {
+        adpcm_stop();
+    }
+    return 0;
+}
+#endif
+
+#if EI_AUDIO_STEREO
+static int cmd_route(int argc, char **argv)
+{
+    static const char *names[] = { "SUM", "LEFT", "RIGHT" };
+    int32_t delay = 0;
+    int current;
+
+    if (argc == 0) {
+        ei_audio_route_t route = ei_microphone_get_route(&current);
+        ei_printf("ROUTE=%s,%d\r\n", names[route], current);
+        return 0;
+    }
+    if (argc > 2 || (argc == 2 && ei_cmd_parse_int(argv[1], -EI_AUDIO_MAX_DELAY, EI_AUDIO_MAX_DELAY, &delay) != 0)) {
+        return -1;
+    }
+    for (size_t ix = 0; ix < sizeof(names) / sizeof(names[0]); ix++) {
+        if (ei_cmd_equals(argv[0], names[ix])) {
+            return ei_microphone_set_route((ei_audio_route_t)ix, delay);
+        }
+    }
+    return -1;
+}
+#endif
+
+static const ei_cmd_t commands[] = {
+    { "STRIDE", "classify one out of every n slices (1..slices per window)", cmd_stride },
+    { "THRESHOLD", "score of a detection (0..1)", cmd_threshold },
+    { "FORMAT", "output format: TEXT, CSV, DETECT or NONE", cmd_format },
+    { "DEBUG", "Edge Impulse SDK debug output (0 or 1)", cmd_debug },
+    { "STATS", "print statistics, AT+STATS=RESET clears the counters", cmd_stats },
+#if EI_AUDIO_CASCADE
+    { "CASCADE", "first stage score that wakes the impulse (0..1, 0 => always)[,hold slices]", cmd_cascade },
+#endif
+#if EI_AUDIO_ADPCM
+    { "ADPCM", "stream the audio over UART2 as IMA-ADPCM (0 or 1)", cmd_adpcm },
+#endif
+#if EI_AUDIO_STEREO
+    { "ROUTE", "microphone routing: SUM[,delay], LEFT or RIGHT", cmd_route },
+#endif
+};
+
+/*
+ * @brief Execute the commands received since the last call, never blocks
+ */
+static void commands_poll(void)
+{
+    char buf[32];
+    size_t n;
+
+    do {
+        n = 0;
+        UART2_read(uart, buf, sizeof(buf), &n);
+        ei_cmd_feed(&cmd_parser, buf, n);
+    } while (n == sizeof(buf));
+}
+#endif
 
 /*
  * @brief Initialize the edge impulse classifier engine. Run this exactly once
+ *
+ * Audio capture is started as soon as output and timer are up, so the I2S DMA
+ * fills its buffers while the rest is initialized. The classifier itself is
+ * initialized by the first ei_infer_audio, while the first slice is recorded.
  */
 void ei_init(void) {
+#if EI_AUDIO_STARTUP_TRACE
+    ei_startup_begin(startup_now_us);
+#endif
+
     // Setup up UART2 as target for ei_print functions
     UART2_Params uartParams;
     UART2_Params_init(&uartParams);
-    uartParams.baudRate = 115200;
+    uartParams.baudRate = EI_AUDIO_UART_BAUDRATE;
     uartParams.readMode = UART2_Mode_NONBLOCKING;
     uart = UART2_open(CONFIG_UART2_0, &uartParams);
 
@@ -78,13 +928,124 @@ void ei_init(void) {
         ei_printf("ERR: Frequency is %d but can only sample at 16000Hz\n", (int)EI_CLASSIFIER_FREQUENCY);
         while(1);
     }
-    // edge-impulse-sdk initialization
-    run_classifier_init();
 
     ei_microphone_init();
     ei_microphone_inference_start(EI_CLASSIFIER_SLICE_SIZE);
+
+#if EI_AUDIO_FEATURE_CACHE
+    if (feature_cache_init()) {
+        ei_printf("ERR: Failed to initialize the feature cache\r\n");
+        while(1);
+    }
+#endif
+
+#if EI_AUDIO_PREROLL
+    ei_preroll_init(&preroll, preroll_buf, PREROLL_CAPACITY);
+#endif
+
+#if EI_AUDIO_COMMANDS
+    ei_cmd_init(&cmd_parser, commands, sizeof(commands) / sizeof(commands[0]), cmd_print);
+#endif
+
+#if EI_AUDIO_SLICE_CONTROLLER
+    ei_slice_ctrl_config_t ctrl_config;
+    ctrl_config.slice_period_us = (EI_CLASSIFIER_SLICE_SIZE * 1000) / (EI_CLASSIFIER_FREQUENCY / 1000);
+    ctrl_config.max_stride = EI_AUDIO_MAX_STRIDE;
+    ctrl_config.queue_limit = 1;   // a second pending buffer means the next one overruns
+    ctrl_config.budget_pct = 90;
+    ctrl_config.recover_cycles = 8;
+    ei_slice_ctrl_init(&slice_ctrl, &ctrl_config);
+#endif
+
+#if EI_AUDIO_CASCADE
+    ei_cascade_init(&cascade, EI_AUDIO_CASCADE_THRESHOLD, EI_AUDIO_CASCADE_HOLD);
+    // follows a louder background within ~64 slices, no lower than -80 dBFS
+    ei_cascade_level_init(&cascade_level, 1.0f / 64.0f, 0.0001f);
+#endif
+
+#if EI_AUDIO_ENERGY
+    // Timer_getMs resolution, short sections are attributed to whichever state the tick falls in
+    ei_energy_init(&energy, NULL, ei_read_timer_us);
+#endif
+
+#if EI_AUDIO_LATENCY
+    ei_latency_init(&latency, EI_AUDIO_LATENCY_UNIT_US);
+#endif
+
+#if EI_AUDIO_ADPCM && EI_AUDIO_ADPCM_START
+    adpcm_start();
+#endif
 }
 
+#if EI_AUDIO_FEATURE_CACHE
+/*
+ * @brief Continuous classification using the feature cache. The DSP block only
+ * runs on the newest slice, the other slices of the window are cache hits.
+ * Until a full window of slices has been cached no inference is run. The
+ * scores go through the moving average filter of run_classifier_continuous,
+ * so results match the SDK's continuous mode.
+ *
+ * @param run_nn false to only compute and cache the features of the slice
+ */
+static EI_IMPULSE_ERROR run_classifier_cached(signal_t *signal, ei_impulse_result_t *result, bool run_nn, bool debug)
+{
+    uint64_t dsp_start_us = ei_read_timer_us();
+    int ret;
+
+    // slice_idx only grows, the newest slice is never cached yet
+    float *slice_features = ei_feature_cache_put(slice_idx);
+
+    ei::matrix_size_t out_size;
+    ret = extract_slice_features(signal, slice_features, slice_feature_count, &out_size);
+    if (ret != EIDSP_OK) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    if (out_size.rows * out_size.cols != slice_feature_count) {
+        ei_printf("ERR: slice produced %u features, the cache expects %u\r\n",
+            (unsigned)(out_size.rows * out_size.cols), (unsigned)slice_feature_count);
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    slice_dsp_us += ei_read_timer_us() - dsp_start_us;
+
+    if (!run_nn) {
+        result->timing.dsp = (int)((ei_read_timer_us() - dsp_start_us) / 1000);
+        slice_idx++;
+        return EI_IMPULSE_OK;
+    }
+
+    ret = ei_feature_cache_assemble(slice_idx, EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW, window_features);
+    slice_idx++;
+    if (ret != 0) {
+        // still filling the first window
+        return EI_IMPULSE_OK;
+    }
+
+    // normalization runs over the whole window, on the copy, never on the cache
+    ei::matrix_t classify_matrix(1, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE, window_features);
+    if (ei_dsp_blocks[0].extract_fn == &extract_mfcc_features) {
+        calc_cepstral_mean_and_var_normalization_mfcc(&classify_matrix, ei_dsp_blocks[0].config);
+    } else {
+        calc_cepstral_mean_and_var_normalization_mfe(&classify_matrix, ei_dsp_blocks[0].config);
+    }
+    result->timing.dsp = (int)((ei_read_timer_us() - dsp_start_us) / 1000);
+
+    EI_IMPULSE_ERROR r = run_inference(&classify_matrix, result, debug);
+    if (r != EI_IMPULSE_OK) {
+        return r;
+    }
+
+    // same post-processing as run_classifier_continuous with enable_maf
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        result->classification[ix].label = ei_classifier_inferencing_categories[ix];
+        result->classification[ix].value =
+            run_moving_average_filter(&classifier_maf[ix], result->classification[ix].value);
+    }
+    result->label_detected = true;
+
+    return EI_IMPULSE_OK;
+}
+#endif
+
 /*
  * @brief Minimal example function for running audio inference
  *
@@ -101,32 +1062,161 @@ ei_impulse_result_t ei_infer_audio(bool debug)
     signal.get_data = &ei_microphone_audio_signal_get_data;
     ei_impulse_result_t result = {0};
 
+    if (!classifier_ready) {
+        // edge-impulse-sdk initialization, the DMA keeps capturing meanwhile
+        run_classifier_init();
+        classifier_ready = true;
+#if EI_AUDIO_STARTUP_TRACE
+        ei_startup_mark(EI_STARTUP_CLASSIFIER_READY);
+#endif
+    }
+
+#if EI_AUDIO_ENERGY
+    ei_energy_enter(&energy, EI_ENERGY_ACQUIRE);
+#endif
     bool m = ei_microphone_inference_record();
     if (!m) {
         ei_printf("ERR: Failed to record audio...\r\n");
         while(1);
     }
+    uint32_t slice_capture_us = ei_microphone_slice_capture_us();
 
-    EI_IMPULSE_ERROR r = run_classifier_continuous(&signal, &result, debug);
+#if EI_AUDIO_PREROLL
+    ei_preroll_write(&preroll, ei_microphone_slice_buffer(), EI_CLASSIFIER_SLICE_SIZE);
+#endif
+#if EI_AUDIO_STORED_WINDOW
+    window_store_slice(ei_microphone_slice_buffer());
+#endif
+#if EI_AUDIO_ADPCM
+    adpcm_slice(ei_microphone_slice_buffer());
+#endif
+
+    bool run_nn = true;
+#if EI_AUDIO_SLICE_CONTROLLER
+    uint64_t start_us = ei_read_timer_us();
+    run_nn = ei_slice_ctrl_should_process(&slice_ctrl);
+#else
+    if (++stride_phase >= fixed_stride) {
+        stride_phase = 0;
+    } else {
+        run_nn = false;
+    }
+#endif
+    debug = debug || sdk_debug;
+
+#if EI_AUDIO_CASCADE
+    if (run_nn) {
+#if EI_AUDIO_ENERGY
+        ei_energy_enter(&energy, EI_ENERGY_APP);
+#endif
+        uint64_t stage1_start_us = ei_read_timer_us();
+        float stage1_score = EI_AUDIO_CASCADE_STAGE1(ei_microphone_slice_buffer(), EI_CLASSIFIER_SLICE_SIZE);
+        run_nn = ei_cascade_gate(&cascade, stage1_score, (uint32_t)(ei_read_timer_us() - stage1_start_us));
+    }
+#endif
+#if EI_AUDIO_STORED_WINDOW
+    // nothing to classify until a whole window is stored
+    run_nn = run_nn && (window_slices == EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW);
+#endif
+
+    EI_IMPULSE_ERROR r = EI_IMPULSE_OK;
+#if EI_AUDIO_ENERGY
+    // the SDK times the DSP part, which is moved out of the NN state below
+    ei_energy_enter(&energy, EI_ENERGY_NN);
+#endif
+#if EI_AUDIO_FEATURE_CACHE
+    r = run_classifier_cached(&signal, &result, run_nn, debug);
+#elif EI_AUDIO_STORED_WINDOW
+    if (run_nn) {
+        signal_t window_signal;
+        window_signal.total_length = EI_CLASSIFIER_RAW_SAMPLE_COUNT;
+        window_signal.get_data = &window_get_data;
+        r = run_classifier(&window_signal, &result, debug);
+    }
+#else
+    if (run_nn) {
+        r = run_classifier_continuous(&signal, &result, debug);
+    }
+#endif
     if (r != EI_IMPULSE_OK) {
         ei_printf("ERR: Failed to run classifier (%d)\r\n", r);
         while(1);
     }
+#if EI_AUDIO_CASCADE
+    if (run_nn) {
+        float stage2_score;
+        top_label(&result, &stage2_score);
+        ei_cascade_stage2_done(&cascade,
+            (uint32_t)(result.timing.dsp + result.timing.classification + result.timing.anomaly) * 1000,
+            stage2_score >= detect_threshold);
+    }
+#endif
+    if (run_nn && result.label_detected) {
+        // slices that are only cached or skipped do not produce a result
+        result_capture_us = slice_capture_us;
+    }
+#if EI_AUDIO_LATENCY
+    if (run_nn && result.label_detected) {
+        uint32_t now_us = (uint32_t)((uint64_t)Clock_getTicks() * Clock_tickPeriod);
+        ei_latency_add(&latency, ei_latency_since(result_capture_us, now_us));
+    }
+#endif
+#if EI_AUDIO_ENERGY
+    ei_energy_charge(&energy, EI_ENERGY_DSP, (uint64_t)result.timing.dsp * 1000);
+    if (result.label_detected) {
+        ei_energy_inference_done(&energy);
+    }
+    ei_energy_enter(&energy, EI_ENERGY_APP);
+#endif
+
+#if EI_AUDIO_SLICE_CONTROLLER
+    ei_slice_ctrl_update(&slice_ctrl, (uint32_t)(ei_read_timer_us() - start_us), ei_microphone_queue_depth());
+#endif
+
+#if EI_AUDIO_PREROLL
+    float score = 0.0f;
+    if (run_nn && result.label_detected) {
+        top_label(&result, &score);
+    }
+    if (score >= detect_threshold) {
+        // ignored while the previous snapshot is still being streamed
+        ei_preroll_trigger(&preroll, PREROLL_PRE_SAMPLES, PREROLL_POST_SAMPLES);
+    }
+#if EI_AUDIO_ENERGY
+    ei_energy_enter(&energy, EI_ENERGY_LOG);
+#endif
+    ei_preroll_stream_chunk(&preroll, EI_PREROLL_CHUNK_SAMPLES, preroll_write_uart);
+#endif
 
     // print the predictions, but only if valid labels are present
     if (result.label_detected) {
-        ei_printf("\r\nPredictions (DSP: %d ms., Classification: %d ms., Anomaly: %d ms.): \r\n",
-            result.timing.dsp, result.timing.classification, result.timing.anomaly);
-        for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
-            ei_printf("    %s: \t", result.classification[ix].label);
-            // printing floating point
-            ei_printf("%d%%", (int32_t) (result.classification[ix].value * 100.0));
-            ei_printf("\r\n");
+#if EI_AUDIO_ENERGY
+        ei_energy_enter(&energy, EI_ENERGY_LOG);
+#endif
+        print_result(&result);
+#if EI_AUDIO_STARTUP_TRACE
+        if (!ei_startup_complete()) {
+            ei_startup_mark(EI_STARTUP_FIRST_RESULT);
+            print_startup();
         }
+#endif
     }
+#if EI_AUDIO_ENERGY
+    ei_energy_enter(&energy, EI_ENERGY_APP);
+#endif
     return result;
 }
 
+/*
+ * @brief Time since boot, in us truncated to 32 bits, at which the newest
+ * audio the last ei_infer_audio result is based on was captured. Compare with
+ * the time a result is acted upon to get its age.
+ */
+uint32_t ei_infer_audio_capture_us(void)
+{
+    return result_capture_us;
+}
+
 /*
  *  ======== mainThread example: continuous inferencing ========
  */
@@ -136,6 +1226,9 @@ extern "C" void *mainThread(void *arg0)
     ei_impulse_result_t result;
     while(1) {
         result = ei_infer_audio(false);
+#if EI_AUDIO_COMMANDS
+        commands_poll();
+#endif
         if (result.label_detected) {
             /*
              * add custom post-processing logic here.
@@ -34,6 +34,7 @@
 /* Include ----------------------------------------------------------------- */
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "ei_microphone_minimal_audio.h"
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
@@ -45,6 +46,8 @@
 #include "ti_drivers_config.h"
 #include "AudioCodec.h"
 #include <ti/drivers/I2S.h>
+#include <ti/drivers/dpl/HwiP.h>
+#include <ti/sysbios/knl/Clock.h>
 #include "model-parameters/model_metadata.h"
 
 /* Audio sampling config */
@@ -59,22 +62,83 @@
 #define INPUT_OPTION                    AudioCodec_MIC_ONBOARD
 #define OUTPUT_OPTION                   AudioCodec_SPEAKER_NONE
 
+/*
+ * Set EI_AUDIO_STEREO=1 to capture two microphones (the onboard microphone and
+ * one on LINE IN by default, see EI_AUDIO_STEREO_INPUT) as interleaved stereo.
+ * Every completed buffer is reduced to the mono slice the impulse expects, in
+ * place, as selected by EI_AUDIO_STEREO_ROUTE:
+ *  EI_AUDIO_ROUTE_SUM   delay-and-sum of both channels, EI_AUDIO_STEREO_DELAY
+ *                       samples of delay steer the pair (ei_microphone_set_route)
+ *  EI_AUDIO_ROUTE_LEFT  left channel only
+ *  EI_AUDIO_ROUTE_RIGHT right channel only
+ */
+#ifndef EI_AUDIO_STEREO
+#define EI_AUDIO_STEREO 0
+#endif
+
+#if EI_AUDIO_STEREO
+#include "ei_audio_channels.h"
+
+#ifndef EI_AUDIO_STEREO_INPUT
+#define EI_AUDIO_STEREO_INPUT           (AudioCodec_MIC_ONBOARD | AudioCodec_MIC_LINE_IN)
+#endif
+#ifndef EI_AUDIO_STEREO_ROUTE
+#define EI_AUDIO_STEREO_ROUTE           EI_AUDIO_ROUTE_SUM
+#endif
+#ifndef EI_AUDIO_STEREO_DELAY
+#define EI_AUDIO_STEREO_DELAY           0
+#endif
+
+#undef INPUT_OPTION
+#define INPUT_OPTION                    EI_AUDIO_STEREO_INPUT
+#define AUDIO_CHANNELS                  2
+#else
+#define AUDIO_CHANNELS                  1
+#endif
+
 /* The more storage space we have, the more delay we have, but the more time we have to process the data. */
 #define NUMBUFS         2      /* Total number of buffers to loop through */
-#define BUFSIZE         AUDIO_DSP_SAMPLE_BUFFER_SIZE     /* I2S buffer size */
+#define BUFSIZE         (AUDIO_DSP_SAMPLE_BUFFER_SIZE * AUDIO_CHANNELS)    /* I2S buffer size */
+
+/*
+ * Set EI_AUDIO_PREPROCESS=1 to run DC removal and automatic gain control
+ * (ei_audio_preprocess.cpp) on every completed buffer before it is classified.
+ * Consider lowering the fixed codec gain set in audio_codec_open when enabled.
+ */
+#ifndef EI_AUDIO_PREPROCESS
+#define EI_AUDIO_PREPROCESS 0
+#endif
+
+#if EI_AUDIO_PREPROCESS
+#include "ei_audio_preprocess.h"
+#endif
+
+/*
+ * With EI_AUDIO_STARTUP_TRACE=1 the start of the capture is marked as the
+ * first sample, see ei_startup.h
+ */
+#ifndef EI_AUDIO_STARTUP_TRACE
+#define EI_AUDIO_STARTUP_TRACE 0
+#endif
+
+#if EI_AUDIO_STARTUP_TRACE
+#include "ei_startup.h"
+#endif
 
 #define MSG_SIZE sizeof(struct frameEvarg)
 #define MSG_NUM NUMBUFS
 
 struct frameEvarg {
     int32_t flen;
-    //int32_t num;
+    uint32_t seq;
+    uint32_t capture_us;    // end of the DMA transfer, see capture_time_us
     int16_t *fbuf;
 };
 
 /** Status and control struct for inferencing struct */
 typedef struct {
     int16_t *buffers[2];
+    uint32_t capture_us[2];
     uint8_t buf_select;
     uint8_t buf_ready;
     uint32_t buf_count;
@@ -84,6 +148,7 @@ typedef struct {
 /* Private variables ------------------------------------------------------- */
 I2S_Handle i2sHandle;
 static mqd_t mic_queue;
+static mqd_t mic_queue_tx; // non-blocking descriptor, used from the I2S callback
 /* Lists containing transactions. Each transaction is in turn in these three lists */
 List_List i2sReadList;
 /* Buffers containing the data: written by read-interface, modified by treatment, and read by write-interface */
@@ -92,30 +157,81 @@ static uint8_t* i2sBufList[NUMBUFS] = {};
 static I2S_Transaction *i2sTransactionList[NUMBUFS] = {};
 
 static int max_msg_ready = 0;
+static int last_max_msg_ready = 0;
 static volatile bool record_ready = false;
 static volatile bool skip = true; // used to skip the first (invalid) sample slice
 
 /* Data structure managing safe buffer reads during inferencing */
 static inference_t inference;
 
+/*
+ * Frame accounting. frames_produced and the dropped_* counters of FrameCb are
+ * written from the I2S interrupt, the others from the inference thread; copy
+ * or clear the whole struct with interrupts disabled
+ */
+static volatile ei_microphone_stats_t mic_stats;
+static uint32_t tx_seq = 0;
+static uint32_t rx_last_seq = 0;
+static bool rx_have_seq = false;
+
+#if EI_AUDIO_STEREO
+/* Channel routing, only changed between slices from the inference thread */
+static ei_audio_route_t stereo_route = EI_AUDIO_STEREO_ROUTE;
+static ei_audio_das_t stereo_das;
+#endif
+
 /* Private functions ------------------------------------------------------- */
 
+/**
+ * @brief Time since boot in us, truncated to 32 bits. Read from the I2S
+ * interrupt, when the last sample of a buffer has just been transferred.
+ */
+static uint32_t capture_time_us(void)
+{
+    return (uint32_t)((uint64_t)Clock_getTicks() * Clock_tickPeriod);
+}
+
 /**
  * @brief      Inference audio callback, store samples in ram buffer
  *             Signal when buffer is full, and swap buffers
  * @param      buffer   Pointer to source buffer
  * @param[in]  n_bytes  Number of bytes to write
+ * @param[in]  capture_us  When the buffer was completed
  */
-static void audio_buffer_inference_callback(void *buffer, uint32_t n_bytes)
+static void audio_buffer_inference_callback(void *buffer, uint32_t n_bytes, uint32_t capture_us)
 {
+#if EI_AUDIO_STEREO
+    // reduce the interleaved frames to mono in place, the first half of the
+    // buffer then holds the slice. Done for every buffer, so the delay line of
+    // the combiner stays continuous.
+    ei_audio_view_t views[AUDIO_CHANNELS];
+    ei_audio_channel_views((int16_t*) buffer, n_bytes / (AUDIO_CHANNELS * sizeof(int16_t)), AUDIO_CHANNELS, views);
+    if (stereo_route == EI_AUDIO_ROUTE_SUM) {
+        ei_audio_das_process(&stereo_das, &views[0], &views[1], (int16_t*) buffer);
+    } else {
+        ei_audio_select(&views[stereo_route == EI_AUDIO_ROUTE_LEFT ? 0 : 1], (int16_t*) buffer);
+    }
+    n_bytes /= AUDIO_CHANNELS;
+#endif
     inference.buf_count += n_bytes >> 1; // bytes to samples
 
     if(inference.buf_count >= inference.n_samples) {
+        if (inference.buf_ready == 1) {
+            // the previous slice was never consumed and is replaced by this one
+            mic_stats.dropped_overrun++;
+        }
+        mic_stats.frames_delivered++;
+#if EI_AUDIO_PREPROCESS
+        // the DMA is filling the other buffer, this one can be modified in place
+        ei_audio_pp_process((int16_t*) buffer, n_bytes >> 1);
+#endif
         inference.buffers[inference.buf_select] = (int16_t*) buffer;
+        inference.capture_us[inference.buf_select] = capture_us;
         inference.buf_select ^= 1;
         inference.buf_count = 0;
         inference.buf_ready = 1;
     } else {
+        mic_stats.partial_frames++;
         ei_printf("audio sampling buffer overflow: (%d:%d)\r\n", inference.buf_count,n_bytes) ;
     }
 }
@@ -125,7 +241,7 @@ static void audio_buffer_inference_callback(void *buffer, uint32_t n_bytes)
  *
  * @param[in]  callback  Callback needs to handle the audio samples
  */
-static void get_dsp_data(void (*callback)(void *buffer, uint32_t n_bytes))
+static void get_dsp_data(void (*callback)(void *buffer, uint32_t n_bytes, uint32_t capture_us))
 {
     struct frameEvarg evArg;
     int n_msg_ready;
@@ -133,7 +249,14 @@ static void get_dsp_data(void (*callback)(void *buffer, uint32_t n_bytes))
     do {
         mq_receive(mic_queue, (char *)&evArg, sizeof(evArg), NULL);
 
-        callback((void *)evArg.fbuf, evArg.flen);
+        if (rx_have_seq && evArg.seq != rx_last_seq + 1) {
+            mic_stats.seq_gaps++;
+            mic_stats.seq_lost += evArg.seq - rx_last_seq - 1;
+        }
+        rx_last_seq = evArg.seq;
+        rx_have_seq = true;
+
+        callback((void *)evArg.fbuf, evArg.flen, evArg.capture_us);
 
         mq_getattr(mic_queue, &mqAttrs);
         n_msg_ready = mqAttrs.mq_curmsgs;
@@ -141,21 +264,36 @@ static void get_dsp_data(void (*callback)(void *buffer, uint32_t n_bytes))
         if(n_msg_ready > max_msg_ready) {
             max_msg_ready = n_msg_ready;
         }
+        if((uint32_t)n_msg_ready > mic_stats.max_queue_depth) {
+            mic_stats.max_queue_depth = n_msg_ready;
+        }
 
     } while(n_msg_ready);
 }
 
-static void FrameCb(void *buf, uint16_t blen)
+static void FrameCb(void *buf, uint16_t blen, uint32_t capture_us)
 {
+    mic_stats.frames_produced++;
+
     if ((record_ready == true) && (skip == false)) {
         struct frameEvarg evArg;
 
         evArg.flen = blen;
+        evArg.seq = tx_seq;
+        evArg.capture_us = capture_us;
         evArg.fbuf = (int16_t*) buf;
 
-        mq_send(mic_queue , (char *)&evArg, sizeof(struct frameEvarg), 0);
+        // a frame that is not queued keeps its sequence number, so it is not also counted in seq_lost
+        if (mq_send(mic_queue_tx, (char *)&evArg, sizeof(struct frameEvarg), 0) != 0) {
+            mic_stats.dropped_queue_full++;
+        } else {
+            tx_seq++;
+        }
     } else if ((record_ready == true) && (skip == true)) {
+        mic_stats.dropped_skip++;
         skip = false;
+    } else {
+        mic_stats.dropped_not_recording++;
     }
 }
 
@@ -198,8 +336,9 @@ static void readCallbackFxn(I2S_Handle handle, int_fast16_t status, I2S_Transact
     if(transactionFinished != NULL) {
         /* The finished transaction contains data that must be treated */
 
-        // no need for processing, already using right channel with ONBOARD_MIC and MONO_INV
-        FrameCb(transactionFinished->bufPtr, transactionFinished->bufSize);
+        // no need for processing, already using right channel with ONBOARD_MIC and MONO_INV.
+        // Stereo buffers are combined by the consumer, outside of the interrupt.
+        FrameCb(transactionFinished->bufPtr, transactionFinished->bufSize, capture_time_us());
     }
 }
 
@@ -215,7 +354,11 @@ static int audio_codec_open()
 
     /* Configure Codec */
     status =  AudioCodec_config(AudioCodec_TI_3254, AudioCodec_16_BIT,
+#if EI_AUDIO_STEREO
+                                SAMPLE_RATE, AudioCodec_STEREO, OUTPUT_OPTION,
+#else
                                 SAMPLE_RATE, AudioCodec_MONO, OUTPUT_OPTION,
+#endif
                                 INPUT_OPTION);
     if( AudioCodec_STATUS_SUCCESS != status)
     {
@@ -224,7 +367,7 @@ static int audio_codec_open()
     }
 
     /* Volume control */
-    AudioCodec_micVolCtrl(AudioCodec_TI_3254, AudioCodec_MIC_ONBOARD, 75);
+    AudioCodec_micVolCtrl(AudioCodec_TI_3254, INPUT_OPTION, 75);
 
     /*
      *  Initialize and Open the I2S driver
@@ -237,7 +380,11 @@ static int audio_codec_open()
     i2sParams.writeCallback     =  writeCallbackFxn ;
     i2sParams.readCallback      =  readCallbackFxn ;
     i2sParams.errorCallback     =  errCallbackFxn;
+#if EI_AUDIO_STEREO
+    i2sParams.SD1Channels       =  I2S_CHANNELS_STEREO;
+#else
     i2sParams.SD1Channels       =  I2S_CHANNELS_MONO_INV;
+#endif
     i2sParams.SD0Use            =  I2S_SD0_DISABLED;
     i2sParams.SD0Channels       =  I2S_CHANNELS_NONE;
     i2sHandle = I2S_open(CONFIG_I2S_0, &i2sParams);
@@ -284,6 +431,9 @@ static void startStream()
 
     I2S_startClocks(i2sHandle);
     I2S_startRead(i2sHandle);
+#if EI_AUDIO_STARTUP_TRACE
+    ei_startup_mark(EI_STARTUP_FIRST_SAMPLE);
+#endif
 }
 
 static void stopStream()
@@ -315,6 +465,22 @@ extern "C" int ei_microphone_init(void)
         /* mq_open() failed */
         return -1;
     }
+    // the I2S callback must never block on a full queue, it counts the drop instead
+    mic_queue_tx = mq_open ("audio", O_WRONLY | O_NONBLOCK);
+    if (mic_queue_tx == (mqd_t)-1) {
+        return -1;
+    }
+
+#if EI_AUDIO_PREPROCESS
+    if (ei_audio_pp_init(NULL)) {
+        return -1;
+    }
+#endif
+#if EI_AUDIO_STEREO
+    if (ei_microphone_set_route(EI_AUDIO_STEREO_ROUTE, EI_AUDIO_STEREO_DELAY)) {
+        return -1;
+    }
+#endif
 
     return audio_codec_open();
 }
@@ -325,6 +491,7 @@ extern "C" bool ei_microphone_inference_start(uint32_t n_samples)
     inference.buf_count = 0;
     inference.n_samples = n_samples;
     inference.buf_ready = 0;
+    rx_have_seq = false;
 
     startStream();
     record_ready = true;
@@ -353,12 +520,81 @@ extern "C" bool ei_microphone_inference_record(void)
             "(EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW): %d\n", max_msg_ready);
     }
 
+    last_max_msg_ready = max_msg_ready;
     max_msg_ready = 0;
     inference.buf_ready = 0;
 
     return ret;
 }
 
+/*
+ * Deepest microphone queue observed during the last ei_microphone_inference_record
+ */
+extern "C" int ei_microphone_queue_depth(void)
+{
+    return last_max_msg_ready;
+}
+
+/*
+ * Copy the frame accounting of the microphone driver
+ */
+extern "C" void ei_microphone_get_stats(ei_microphone_stats_t *stats)
+{
+    uintptr_t key = HwiP_disable();
+    memcpy(stats, (const void *)&mic_stats, sizeof(ei_microphone_stats_t));
+    HwiP_restore(key);
+}
+
+extern "C" void ei_microphone_reset_stats(void)
+{
+    uintptr_t key = HwiP_disable();
+    memset((void *)&mic_stats, 0, sizeof(ei_microphone_stats_t));
+    HwiP_restore(key);
+}
+
+#if EI_AUDIO_STEREO
+/**
+ * @brief Select how the two microphones are reduced to the mono slice
+ *
+ * @param delay steering delay of EI_AUDIO_ROUTE_SUM in samples, positive
+ *              delays the right channel, negative the left one
+ *
+ * @return int, 0 => OK, -1 if the delay is out of range
+ */
+extern "C" int ei_microphone_set_route(ei_audio_route_t route, int delay)
+{
+    if (ei_audio_das_init(&stereo_das, delay)) {
+        return -1;
+    }
+    stereo_route = route;
+    return 0;
+}
+
+extern "C" ei_audio_route_t ei_microphone_get_route(int *delay)
+{
+    *delay = stereo_das.delay;
+    return stereo_route;
+}
+#endif
+
+/*
+ * Raw int16 samples of the slice returned by the last ei_microphone_inference_record
+ */
+extern "C" const int16_t *ei_microphone_slice_buffer(void)
+{
+    return inference.buffers[inference.buf_select ^ 1];
+}
+
+/*
+ * Time since boot, in us truncated to 32 bits, at which the last sample of the
+ * slice returned by the last ei_microphone_inference_record was captured. The
+ * first sample is a slice duration older.
+ */
+extern "C" uint32_t ei_microphone_slice_capture_us(void)
+{
+    return inference.capture_us[inference.buf_select ^ 1];
+}
+
 /*
  * Get raw audio signal data
  */
@@ -39,12 +39,39 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+#if EI_AUDIO_STEREO
+#include "ei_audio_channels.h"
+#endif
+
+/** Frame accounting of the microphone driver, a frame is one completed I2S buffer */
+typedef struct {
+    uint32_t frames_produced;       // completed by the I2S DMA
+    uint32_t frames_delivered;      // handed to the classifier as a slice
+    uint32_t dropped_not_recording; // completed while no inference was running
+    uint32_t dropped_skip;          // first (invalid) frame after a start
+    uint32_t dropped_queue_full;    // mq_send failed in the I2S callback
+    uint32_t dropped_overrun;       // replaced before the classifier consumed it
+    uint32_t partial_frames;        // shorter than a slice
+    uint32_t seq_gaps;              // discontinuities in the frame sequence numbers
+    uint32_t seq_lost;              // frames queued but never received, not in dropped_queue_full
+    uint32_t max_queue_depth;
+} ei_microphone_stats_t;
+
 /* Function prototypes ----------------------------------------------------- */
 extern "C" int ei_microphone_init(void);
 extern "C" bool ei_microphone_inference_start(uint32_t n_samples);
 
 extern "C" int ei_microphone_audio_signal_get_data(size_t offset, size_t length, float *out_ptr);
 extern "C" bool ei_microphone_inference_record(void);
+extern "C" int ei_microphone_queue_depth(void);
+extern "C" const int16_t *ei_microphone_slice_buffer(void);
+extern "C" uint32_t ei_microphone_slice_capture_us(void);
+extern "C" void ei_microphone_get_stats(ei_microphone_stats_t *stats);
+extern "C" void ei_microphone_reset_stats(void);
+#if EI_AUDIO_STEREO
+extern "C" int ei_microphone_set_route(ei_audio_route_t route, int delay);
+extern "C" ei_audio_route_t ei_microphone_get_route(int *delay);
+#endif
 extern "C" bool ei_microphone_inference_end(void);
 
 #endif
@@ -0,0 +1,117 @@
+/* Adaptive slice rate controller. See ei_slice_controller.h for an overview.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "ei_slice_controller.h"
+
+/* Private functions ------------------------------------------------------- */
+static inline uint64_t budget_us(const ei_slice_ctrl_t *ctrl, uint8_t stride)
+{
+    return ((uint64_t)stride * ctrl->config.slice_period_us * ctrl->config.budget_pct) / 100;
+}
+
+/**
+ * @brief Called at the end of every stride cycle, i.e. after the processed slice
+ */
+static void evaluate_cycle(ei_slice_ctrl_t *ctrl)
+{
+    if (ctrl->overload || ctrl->cycle_busy_us > budget_us(ctrl, ctrl->stride)) {
+        ctrl->overloads++;
+        ctrl->light_cycles = 0;
+        if (ctrl->stride < ctrl->config.max_stride) {
+            ctrl->stride++;
+            ctrl->stride_increases++;
+        }
+    } else if (ctrl->stride > 1 && ctrl->cycle_busy_us <= budget_us(ctrl, ctrl->stride - 1)) {
+        // the same work would have fit in a shorter cycle
+        if (++ctrl->light_cycles >= ctrl->config.recover_cycles) {
+            ctrl->stride--;
+            ctrl->stride_decreases++;
+            ctrl->light_cycles = 0;
+        }
+    } else {
+        ctrl->light_cycles = 0;
+    }
+
+    ctrl->overload = false;
+    ctrl->cycle_busy_us = 0;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief Reset the controller to a stride of 1, i.e. every slice is classified
+ */
+extern "C" void ei_slice_ctrl_init(ei_slice_ctrl_t *ctrl, const ei_slice_ctrl_config_t *config)
+{
+    memset(ctrl, 0, sizeof(ei_slice_ctrl_t));
+    ctrl->config = *config;
+    if (ctrl->config.max_stride == 0) {
+        ctrl->config.max_stride = 1;
+    }
+    if (ctrl->config.recover_cycles == 0) {
+        ctrl->config.recover_cycles = 1;
+    }
+    ctrl->stride = 1;
+}
+
+/**
+ * @brief Call once for every slice that becomes available, before processing it
+ *
+ * @return true if this slice should be classified, false if it should be skipped
+ * (or only pre-processed, to keep the model window continuous)
+ */
+extern "C" bool ei_slice_ctrl_should_process(ei_slice_ctrl_t *ctrl)
+{
+    ctrl->slices_seen++;
+
+    // the last slice of a cycle is classified, so the decision uses the freshest audio
+    if (ctrl->phase + 1 >= ctrl->stride) {
+        ctrl->slices_processed++;
+        return true;
+    }
+    ctrl->slices_skipped++;
+
+    return false;
+}
+
+/**
+ * @brief Call once for every slice, after it was processed or skipped
+ *
+ * @param busy_us time spent on this slice (DSP + NN, or only DSP for merged slices)
+ *
+ * @param queue_depth pending microphone buffers observed while waiting for the slice
+ */
+extern "C" void ei_slice_ctrl_update(ei_slice_ctrl_t *ctrl, uint32_t busy_us, int queue_depth)
+{
+    ctrl->cycle_busy_us += busy_us;
+    if (queue_depth >= ctrl->config.queue_limit) {
+        ctrl->overload = true;
+    }
+
+    if (++ctrl->phase >= ctrl->stride) {
+        ctrl->phase = 0;
+        evaluate_cycle(ctrl);
+    }
+}
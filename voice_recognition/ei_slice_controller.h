@@ -0,0 +1,67 @@
+/* Adaptive slice rate controller for continuous audio inferencing. The
+ * controller compares the measured processing time against the slice period
+ * and the depth of the microphone queue, and raises or lowers a stride: only
+ * one out of every `stride` slices is classified. It is pure logic, all times
+ * are passed in by the caller, so it behaves identically on target and on host.
+ *
+ * Copyright (c) 2022 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_SLICE_CONTROLLER_H
+#define EI_SLICE_CONTROLLER_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** Controller tuning */
+typedef struct {
+    uint32_t slice_period_us;   // audio duration of one slice
+    uint8_t max_stride;         // upper bound for the stride
+    uint8_t queue_limit;        // queue depth that counts as an overload
+    uint8_t budget_pct;         // target share of the stride period spent processing
+    uint8_t recover_cycles;     // consecutive light cycles before the stride is lowered
+} ei_slice_ctrl_config_t;
+
+/** Controller state and counters */
+typedef struct {
+    ei_slice_ctrl_config_t config;
+    uint8_t stride;
+    uint8_t phase;
+    uint8_t light_cycles;
+    bool overload;
+    uint64_t cycle_busy_us;
+
+    uint32_t slices_seen;
+    uint32_t slices_processed;
+    uint32_t slices_skipped;
+    uint32_t overloads;
+    uint32_t stride_increases;
+    uint32_t stride_decreases;
+} ei_slice_ctrl_t;
+
+/* Function prototypes ----------------------------------------------------- */
+extern "C" void ei_slice_ctrl_init(ei_slice_ctrl_t *ctrl, const ei_slice_ctrl_config_t *config);
+extern "C" bool ei_slice_ctrl_should_process(ei_slice_ctrl_t *ctrl);
+extern "C" void ei_slice_ctrl_update(ei_slice_ctrl_t *ctrl, uint32_t busy_us, int queue_depth);
+
+#endif